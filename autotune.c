@@ -0,0 +1,510 @@
+#include "autotune.h"
+#include "backend.h"
+#include "helper.h"
+
+//===Names Used In The Cache File===//
+static const char* operation_names[NUM_LAYER_OPERATIONS] = { "forward", "backward", "update" };
+static const char* backend_names[NUM_COMPUTE_BACKENDS] = { "auto", "cblas", "portable", "simd", "unrolled", "simd_blocked" };
+
+//================================================================================================//
+//======================================Cache Functions===========================================//
+//================================================================================================//
+
+static void read_cpu_model( char* model )
+{
+	FILE* fp;
+	char line[256], *value;
+	size_t i;
+
+	strcpy(model, "unknown");
+	fp = fopen("/proc/cpuinfo", "r");
+	if (fp == NULL){
+		return;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL){
+		if (strncmp(line, "model name", 10) != 0 || (value = strchr(line, ':')) == NULL){
+			continue;
+		}
+		value += 1 + (value[1] == ' ');
+		snprintf(model, MAX_CPU_MODEL_LENGTH, "%s", value);
+		break;
+	}
+	fclose(fp);
+
+	//===Tabs And Newlines Would Break The File Format===//
+	for (i=0; model[i] != '\0'; i++){
+		if (model[i] == '\t' || model[i] == '\n'){
+			model[i] = (model[i] == '\n') ? '\0' : ' ';
+		}
+	}
+
+	return;
+}
+
+static int find_name( const char** names,
+					  unsigned int num_names,
+					  char* name )
+{
+	unsigned int i;
+	for (i=0; i<num_names; i++){
+		if (strcmp(names[i], name) == 0){
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void load_autotune_cache( autotune_cache_t* self,
+								 char* path )
+{
+	FILE* fp;
+	int operation, backend;
+	char line[256], *fields[6], *save;
+	unsigned int i;
+	autotune_entry_t* entry;
+
+	self->num_entries = 0;
+	fp = fopen(path, "r");
+	if (fp == NULL){
+		return;
+	}
+
+	//===Malformed Lines Are Skipped===//
+	while (self->num_entries < MAX_AUTOTUNE_ENTRIES && fgets(line, sizeof(line), fp) != NULL){
+		line[strcspn(line, "\n")] = '\0';
+		fields[0] = strtok_r(line, "\t", &save);
+		for (i=1; i<6 && fields[i-1] != NULL; i++){
+			fields[i] = strtok_r(NULL, "\t", &save);
+		}
+		if (i < 6 || fields[5] == NULL){
+			continue;
+		}
+		operation = find_name(operation_names, NUM_LAYER_OPERATIONS, fields[1]);
+		backend = find_name(backend_names, NUM_COMPUTE_BACKENDS, fields[5]);
+		if (operation < 0 || backend <= COMPUTE_BACKEND_AUTO){
+			continue;
+		}
+		entry = &(self->entry[self->num_entries++]);
+		snprintf(entry->cpu_model, MAX_CPU_MODEL_LENGTH, "%s", fields[0]);
+		entry->operation = operation;
+		entry->rows = strtoul(fields[2], NULL, 10);
+		entry->columns = strtoul(fields[3], NULL, 10);
+		entry->batch_size = strtoul(fields[4], NULL, 10);
+		entry->backend = backend;
+	}
+	fclose(fp);
+
+	return;
+}
+
+static int save_autotune_cache( autotune_cache_t* self,
+								char* path )
+{
+	FILE* fp;
+	int status;
+	unsigned int i;
+	char temp_path[MAX_AUTOTUNE_PATH];
+	autotune_entry_t* entry;
+
+	if (snprintf(temp_path, sizeof(temp_path), "%s.tmp", path) >= (int)sizeof(temp_path)){
+		fprintf(stderr, "Error:: Cache Path Is Too Long! In Function -- save_autotune_cache\n");
+		return -1;
+	}
+
+	fp = NULL;
+	fp = fopen(temp_path, "w");
+	if (fp == NULL){
+		fprintf(stderr, "Error:: Could Not Open '%s'! In Function -- save_autotune_cache\n", temp_path);
+		return -1;
+	}
+	status = 0;
+	for (i=0; i<self->num_entries; i++){
+		entry = &(self->entry[i]);
+		if (fprintf(fp, "%s\t%s\t%u\t%u\t%u\t%s\n", entry->cpu_model, operation_names[entry->operation],
+					entry->rows, entry->columns, entry->batch_size, backend_names[entry->backend]) < 0){
+			status = -1;
+		}
+	}
+	if (fflush(fp) != 0 || fsync(fileno(fp)) != 0){
+		status = -1;
+	}
+	if (fclose(fp) != 0){
+		status = -1;
+	}
+
+	//===Publish Atomically===//
+	if (status != 0 || rename(temp_path, path) != 0){
+		fprintf(stderr, "Error:: Could Not Write '%s'! In Function -- save_autotune_cache\n", path);
+		unlink(temp_path);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void default_cache_path( char* path )
+{
+	char *variable, directory[MAX_AUTOTUNE_PATH];
+
+	//===Never The Working Directory, Which Differs Between Runs===//
+	if ((variable = getenv("XDG_CACHE_HOME")) != NULL && variable[0] == '/'){
+		snprintf(directory, sizeof(directory), "%s", variable);
+	}
+	else if ((variable = getenv("HOME")) != NULL && variable[0] == '/'){
+		snprintf(directory, sizeof(directory), "%s/.cache", variable);
+	}
+	else{
+		strcpy(directory, "/tmp");
+	}
+	if (access(directory, W_OK) != 0 ||
+		snprintf(path, MAX_AUTOTUNE_PATH, "%s/%s", directory, AUTOTUNE_DEFAULT_CACHE) >= MAX_AUTOTUNE_PATH){
+		snprintf(path, MAX_AUTOTUNE_PATH, "/tmp/%s", AUTOTUNE_DEFAULT_CACHE);
+	}
+
+	return;
+}
+
+static autotune_entry_t* find_autotune_entry( autotune_cache_t* self,
+											  layer_operation_t operation,
+											  unsigned int rows,
+											  unsigned int columns,
+											  unsigned int batch_size )
+{
+	unsigned int i;
+	autotune_entry_t* entry;
+
+	for (i=0; i<self->num_entries; i++){
+		entry = &(self->entry[i]);
+		if (entry->operation == operation && entry->rows == rows && entry->columns == columns &&
+			entry->batch_size == batch_size && strcmp(entry->cpu_model, self->cpu_model) == 0){
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+//================================================================================================//
+//====================================Workspace Functions=========================================//
+//================================================================================================//
+
+static int create_autotune_workspace( autotune_workspace_t* self,
+									  neural_network_t* network,
+									  unsigned int batch_size )
+{
+	unsigned int l, i;
+	size_t block, update;
+
+	self->batch_size = batch_size;
+	self->stride = 0;
+	update = 0;
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		self->stride = MAX(self->stride, MAX(network->layer[l].num_nodes+1, network->layer[l].leading_dimension));
+		update = MAX(update, (size_t)(network->layer[l].num_nodes+1) * network->layer[l].leading_dimension);
+	}
+	self->stride = round_up(self->stride, SIMD_WIDTH);
+	block = round_up((size_t)batch_size * self->stride * sizeof(double), WEIGHT_ALIGNMENT);
+
+	self->activations = aligned_alloc(WEIGHT_ALIGNMENT, block);
+	self->deltas = aligned_alloc(WEIGHT_ALIGNMENT, block);
+	self->outputs = aligned_alloc(WEIGHT_ALIGNMENT, block);
+	self->update = aligned_alloc(WEIGHT_ALIGNMENT, round_up(update * sizeof(double), WEIGHT_ALIGNMENT));
+	self->weights = aligned_alloc(WEIGHT_ALIGNMENT, round_up(network->arena_size * sizeof(double), WEIGHT_ALIGNMENT));
+	if (self->activations == NULL || self->deltas == NULL || self->outputs == NULL ||
+		self->update == NULL || self->weights == NULL){
+		return -1;
+	}
+	memcpy(self->weights, network->weight_arena, network->arena_size * sizeof(double));
+
+	//===Benign Inputs Keep Denormals Out Of The Timings===//
+	for (i=0; i<batch_size * self->stride; i++){
+		self->activations[i] = 1;
+		self->deltas[i] = 0.5;
+	}
+
+	return 0;
+}
+
+static void destroy_autotune_workspace( autotune_workspace_t* self )
+{
+	free(self->activations);
+	free(self->deltas);
+	free(self->outputs);
+	free(self->update);
+	free(self->weights);
+	return;
+}
+
+//================================================================================================//
+//=====================================Timing Functions===========================================//
+//================================================================================================//
+
+static void run_layer_operation( neural_layer_t* layer,
+								 layer_operation_t operation,
+								 compute_backend_t* backend,
+								 autotune_workspace_t* workspace,
+								 double* weights )
+{
+	unsigned int b, rows, columns, stride;
+
+	rows = layer->num_nodes+1;
+	columns = layer->leading_dimension;
+	stride = workspace->stride;
+
+	//===Whole Padded Rows, As The Training Paths Run Them===//
+	switch (operation){
+		case LAYER_OPERATION_FORWARD:
+			backend->gemm(workspace->batch_size, columns, rows, 1.0, workspace->activations, stride,
+						  layer->weight_matrix, columns, 0.0, workspace->outputs, stride);
+			break;
+		case LAYER_OPERATION_BACKWARD:
+			for (b=0; b<workspace->batch_size; b++){
+				backend->gemv(layer->num_nodes, columns, 1.0, layer->weight_matrix, columns,
+							  workspace->deltas + (size_t)b*stride, 0.0, workspace->outputs + (size_t)b*stride);
+			}
+			break;
+		default:
+			//===Activations Are All Ones, So The Block Doubles As Its Own Transpose===//
+			backend->gemm(rows, columns, workspace->batch_size, 1.0, workspace->activations, workspace->batch_size,
+						  workspace->deltas, stride, 0.0, workspace->update, columns);
+			backend->axpy(rows * columns, -(*layer->learning_rate), workspace->update, weights);
+			break;
+	}
+
+	return;
+}
+
+static double time_layer_operation( neural_layer_t* layer,
+									layer_operation_t operation,
+									compute_backend_t* backend,
+									autotune_workspace_t* workspace,
+									double* weights )
+{
+	unsigned int t, r, repetitions;
+	double elapsed, best;
+	struct timespec start, stop;
+
+	repetitions = AUTOTUNE_WORK_PER_TRIAL / ((layer->num_nodes+1) * layer->leading_dimension * workspace->batch_size);
+	repetitions = MIN(MAX(repetitions, AUTOTUNE_MIN_REPETITIONS), AUTOTUNE_MAX_REPETITIONS);
+
+	//===Best Of Several Trials After A Warm Up===//
+	run_layer_operation(layer, operation, backend, workspace, weights);
+	best = DBL_MAX;
+	for (t=0; t<AUTOTUNE_TRIALS; t++){
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (r=0; r<repetitions; r++){
+			run_layer_operation(layer, operation, backend, workspace, weights);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		elapsed = (stop.tv_sec - start.tv_sec) + 1e-9*(stop.tv_nsec - start.tv_nsec);
+		best = MIN(best, elapsed/repetitions);
+	}
+
+	return best;
+}
+
+static compute_backend_type_t tune_layer_operation( neural_layer_t* layer,
+													layer_operation_t operation,
+													autotune_workspace_t* workspace,
+													double* weights )
+{
+	unsigned int t;
+	double elapsed, best;
+	compute_backend_t* backend;
+	compute_backend_type_t winner;
+
+	//===Every Backend And Kernel Variant Available Here===//
+	best = DBL_MAX;
+	winner = COMPUTE_BACKEND_PORTABLE;
+	for (t=COMPUTE_BACKEND_CBLAS; t<NUM_COMPUTE_BACKENDS; t++){
+		backend = get_compute_backend(t);
+		if (backend == NULL){
+			continue;
+		}
+		elapsed = time_layer_operation(layer, operation, backend, workspace, weights);
+		if (elapsed < best){
+			best = elapsed;
+			winner = t;
+		}
+	}
+
+	return winner;
+}
+
+//================================================================================================//
+//====================================Autotune Functions==========================================//
+//================================================================================================//
+
+int autotune_network( neural_network_t* self,
+					  unsigned int batch_size,
+					  char* cache_path )
+{
+	int num_tuned, full;
+	unsigned int l, o, rows, columns;
+	char default_path[MAX_AUTOTUNE_PATH];
+	neural_layer_t* layer;
+	autotune_entry_t* entry;
+	autotune_cache_t* cache;
+	autotune_workspace_t workspace;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'self' Is NULL! In Function -- autotune_network\n");
+		return -1;
+	}
+	if (batch_size == 0){
+		fprintf(stderr, "Error:: Input Parameter 'batch_size' Is Zero! In Function -- autotune_network\n");
+		return -1;
+	}
+	if (cache_path == NULL){
+		default_cache_path(default_path);
+		cache_path = default_path;
+	}
+
+	cache = NULL;
+	cache = malloc(sizeof(autotune_cache_t));
+	memset(&workspace, 0, sizeof(autotune_workspace_t));
+	if (cache == NULL || create_autotune_workspace(&workspace, self, batch_size) != 0){
+		fprintf(stderr, "Error:: Autotune Buffers Were Not Allocated! In Function -- autotune_network\n");
+		free(cache);
+		destroy_autotune_workspace(&workspace);
+		return -1;
+	}
+	read_cpu_model(cache->cpu_model);
+	load_autotune_cache(cache, cache_path);
+
+	num_tuned = 0;
+	full = 0;
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		layer = &(self->layer[l]);
+		rows = layer->num_nodes+1;
+		columns = layer->next_layer->num_nodes;
+		for (o=0; o<NUM_LAYER_OPERATIONS; o++){
+
+			//===The Input Layer Has No Backward Product===//
+			if (o == LAYER_OPERATION_BACKWARD && l == 0){
+				continue;
+			}
+
+			entry = find_autotune_entry(cache, o, rows, columns, batch_size);
+			if (entry == NULL || get_compute_backend(entry->backend) == NULL){
+				if (entry == NULL){
+
+					//===Report Once; Cached Shapes Are Still Applied===//
+					if (cache->num_entries == MAX_AUTOTUNE_ENTRIES){
+						if (!full){
+							fprintf(stderr, "Error:: Autotune Cache Is Full! In Function -- autotune_network\n");
+						}
+						full = 1;
+						continue;
+					}
+					entry = &(cache->entry[cache->num_entries++]);
+					memcpy(entry->cpu_model, cache->cpu_model, MAX_CPU_MODEL_LENGTH);
+					entry->operation = o;
+					entry->rows = rows;
+					entry->columns = columns;
+					entry->batch_size = batch_size;
+				}
+				entry->backend = tune_layer_operation(layer, o, &workspace,
+													  workspace.weights + (layer->weight_matrix - self->weight_arena));
+				num_tuned++;
+			}
+			layer->operation_backend[o] = get_compute_backend(entry->backend);
+		}
+	}
+
+	//===Only Rewrite The File If Something New Was Learned===//
+	if (num_tuned > 0){
+		save_autotune_cache(cache, cache_path);
+	}
+
+	destroy_autotune_workspace(&workspace);
+	free(cache);
+
+	return num_tuned;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+void test_autotuner()
+{
+	unsigned int i, num_nodes[4];
+	double input[64], hidden[96], expected, *update;
+	char path[MAX_AUTOTUNE_PATH];
+	FILE* fp;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+
+	//===Tiny And Larger Layers===//
+	num_nodes[0] = 64; num_nodes[1] = 96; num_nodes[2] = 5; num_nodes[3] = 3;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->backend = COMPUTE_BACKEND_PORTABLE;
+	network = create_neural_network(parameters);
+	update = malloc(network->arena_size * sizeof(double));
+	if (update == NULL){
+		fprintf(stderr, "Error: Test Buffers Were Not Allocated!\n");
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	for (i=0; i<64; i++){
+		input[i] = 0.01*i;
+	}
+	feed_forward(network, input);
+	expected = network->output[0];
+
+	//===State The Tuner Must Leave Alone===//
+	memcpy(hidden, network->context->layer[1].activation, 96 * sizeof(double));
+	for (i=0; i<network->arena_size; i++){
+		network->update_arena[i] = 0.001*i;
+	}
+	memcpy(update, network->update_arena, network->arena_size * sizeof(double));
+
+	//===First Run Tunes, Second Run Reads The Cache===//
+	snprintf(path, sizeof(path), "/tmp/test_autotune_%d.cache", (int)getpid());
+	unlink(path);
+	if (autotune_network(network, 1, path) != 8){
+		fprintf(stderr, "Error: Function autotune_network Did Not Tune Every Shape!\n");
+	}
+	if (autotune_network(network, 1, path) != 0){
+		fprintf(stderr, "Error: Function autotune_network Did Not Use Its Cache!\n");
+	}
+
+	//===Batched Shapes Are Separate Entries===//
+	if (autotune_network(network, 16, path) != 8){
+		fprintf(stderr, "Error: Function autotune_network Did Not Tune Batched Shapes!\n");
+	}
+	if (autotune_network(network, 16, path) != 0){
+		fprintf(stderr, "Error: Function autotune_network Did Not Cache Batched Shapes!\n");
+	}
+	if (memcmp(hidden, network->context->layer[1].activation, 96 * sizeof(double)) != 0 ||
+		memcmp(update, network->update_arena, network->arena_size * sizeof(double)) != 0){
+		fprintf(stderr, "Error: Function autotune_network Changed The Network's Context Or Updates!\n");
+	}
+
+	//===Tuned Kernels Give The Same Result===//
+	feed_forward(network, input);
+	if (fabs(network->output[0] - expected) > 1e-12){
+		fprintf(stderr, "Error: Autotuned Network Output Has Changed!\n");
+	}
+
+	//===A Full Cache Is Reported Once And Nothing Is Timed===//
+	fp = fopen(path, "w");
+	if (fp != NULL){
+		for (i=0; i<MAX_AUTOTUNE_ENTRIES; i++){
+			fprintf(fp, "other\tforward\t%u\t1\t1\tportable\n", i+1);
+		}
+		fclose(fp);
+		if (autotune_network(network, 1, path) != 0){
+			fprintf(stderr, "Error: Function autotune_network Tuned Into A Full Cache!\n");
+		}
+	}
+	unlink(path);
+
+	free(update);
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,124 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define AUTOTUNE_DEFAULT_CACHE "neurons_autotune.cache"
+#define MAX_AUTOTUNE_ENTRIES 512
+#define MAX_CPU_MODEL_LENGTH 64
+#define MAX_AUTOTUNE_PATH 256
+#define AUTOTUNE_TRIALS 3
+#define AUTOTUNE_MIN_REPETITIONS 3
+#define AUTOTUNE_MAX_REPETITIONS 64
+#define AUTOTUNE_WORK_PER_TRIAL (1<<22)
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct autotune_entry_t
+*   @brief This structure comprises the fastest backend found for one operation and shape.
+*
+*	Entries are keyed by CPU model, so one cache file can be shared between machines.
+*/
+//================================================================================================//
+typedef struct autotune_entry_s autotune_entry_t;
+typedef struct autotune_entry_s{
+	char cpu_model[MAX_CPU_MODEL_LENGTH];
+	layer_operation_t operation;
+	unsigned int rows;
+	unsigned int columns;
+	unsigned int batch_size;
+	compute_backend_type_t backend;
+} autotune_entry_t;
+
+
+//================================================================================================//
+/** @struct autotune_workspace_t
+*   @brief This structure comprises the private buffers layer products are timed on.
+*
+*	Blocks hold batch_size rows, stride apart. Weights are a copy of the weight arena, so
+*	timing never touches the network's context, update arena or weights.
+*/
+//================================================================================================//
+typedef struct autotune_workspace_s autotune_workspace_t;
+typedef struct autotune_workspace_s{
+	double* activations;
+	double* deltas;
+	double* outputs;
+	double* update;
+	double* weights;
+	unsigned int batch_size;
+	unsigned int stride;
+} autotune_workspace_t;
+
+
+//================================================================================================//
+/** @struct autotune_cache_t
+*   @brief This structure comprises every autotune result read from or written to a cache file.
+*
+*	The file has one tab separated entry per line: cpu model, operation, rows, columns, batch
+*	size and backend name.
+*/
+//================================================================================================//
+typedef struct autotune_cache_s autotune_cache_t;
+typedef struct autotune_cache_s{
+	autotune_entry_t entry[MAX_AUTOTUNE_ENTRIES];
+	unsigned int num_entries;
+	char cpu_model[MAX_CPU_MODEL_LENGTH];
+} autotune_cache_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function picks the fastest available kernels for every layer operation.
+*
+* Each layer's forward, backward and update products are timed at the layer's (rows, columns,
+* batch size) shape on every available backend and kernel variant: forward as one gemm over the
+* batch, backward as one gemv per sample and update as one gemm summing the batch. Timing runs
+* on private buffers; the network's context, update arena and weights are left alone. Shapes
+* already in the cache for this CPU model are not timed again. New results are added to the
+* cache file, which is replaced atomically. If the cache is full, untimed shapes keep their
+* backend. A NULL path uses AUTOTUNE_DEFAULT_CACHE in $XDG_CACHE_HOME, else ~/.cache, else /tmp.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] unsigned int batch_size
+* @param[in] char* cache_path
+*
+* @return int num_tuned (shapes timed in this call, -1 on error)
+*/
+//================================================================================================//
+int autotune_network( neural_network_t* self,
+					  unsigned int batch_size,
+					  char* cache_path );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the autotuner and its cache.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_autotuner();
+
+
+
+#endif //AUTOTUNE_H//
@@ -0,0 +1,1141 @@
+#include <dlfcn.h>
+#include <stdint.h>
+#include "backend.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_BACKEND_SUPPORTED 1
+#else
+#define SIMD_BACKEND_SUPPORTED 0
+#endif
+
+//===CBLAS Enumeration Values===//
+#define CBLAS_ROW_MAJOR 101
+#define CBLAS_NO_TRANSPOSE 111
+
+//===Blocked gemm Tiles: A 64x64 Panel Of B Is 32 KB===//
+#define GEMM_BLOCK_COLUMNS 64
+#define GEMM_BLOCK_INNER 64
+
+//================================================================================================//
+//===================================Activation Functions=========================================//
+//================================================================================================//
+
+static void identity_kernel( double* input,
+							 double* activation,
+							 double* derivative,
+							 unsigned int num_nodes )
+{
+	unsigned int i;
+	for (i=0; i<num_nodes; i++){
+		activation[i] = input[i];
+		derivative[i] = 1;
+	}
+	return;
+}
+
+static void sigmoid_kernel( double* input,
+							double* activation,
+							double* derivative,
+							unsigned int num_nodes )
+{
+	unsigned int i;
+	double temp;
+	for (i=0; i<num_nodes; i++){
+		temp = 1/(1+exp(-input[i]));
+		activation[i] = temp;
+		derivative[i] = temp*(1-temp);
+	}
+	return;
+}
+
+static void tanh_kernel( double* input,
+						 double* activation,
+						 double* derivative,
+						 unsigned int num_nodes )
+{
+	unsigned int i;
+	double temp;
+	for (i=0; i<num_nodes; i++){
+		temp = tanh(input[i]);
+		activation[i] = temp;
+		derivative[i] = 1 - temp*temp;
+	}
+	return;
+}
+
+static void relu_kernel( double* input,
+						 double* activation,
+						 double* derivative,
+						 unsigned int num_nodes )
+{
+	unsigned int i;
+	for (i=0; i<num_nodes; i++){
+		activation[i] = (input[i] > 0) ? input[i] : 0;
+		derivative[i] = (input[i] > 0) ? 1 : 0;
+	}
+	return;
+}
+
+static void leaky_relu_kernel( double* input,
+							   double* activation,
+							   double* derivative,
+							   unsigned int num_nodes )
+{
+	unsigned int i;
+	for (i=0; i<num_nodes; i++){
+		activation[i] = (input[i] > 0) ? input[i] : LEAKY_RELU_SLOPE*input[i];
+		derivative[i] = (input[i] > 0) ? 1 : LEAKY_RELU_SLOPE;
+	}
+	return;
+}
+
+static void softmax_kernel( double* input,
+							double* activation,
+							double* derivative,
+							unsigned int num_nodes )
+{
+	unsigned int i;
+
+	softmax_rows(input, activation, 1, num_nodes);
+
+	//===Cross-Entropy Gradient Is Already p - y===//
+	for (i=0; i<num_nodes; i++){
+		derivative[i] = 1;
+	}
+	return;
+}
+
+//================================================================================================//
+//=====================================Portable Kernels===========================================//
+//================================================================================================//
+
+static void portable_gemm( int rows,
+						   int columns,
+						   int inner,
+						   double alpha,
+						   double* a,
+						   int lda,
+						   double* b,
+						   int ldb,
+						   double beta,
+						   double* c,
+						   int ldc )
+{
+	int i, j, k;
+	double scale, *row, *b_row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+
+		//===Accumulate Scaled Rows Of B===//
+		for (k=0; k<inner; k++){
+			scale = alpha * a[k + (size_t)i*lda];
+			b_row = b + (size_t)k*ldb;
+			for (j=0; j<columns; j++){
+				row[j] += scale * b_row[j];
+			}
+		}
+	}
+
+	return;
+}
+
+static void portable_gemv( int rows,
+						   int columns,
+						   double alpha,
+						   double* a,
+						   int lda,
+						   double* x,
+						   double beta,
+						   double* y )
+{
+	int i, j;
+	double sum, *row;
+
+	for (i=0; i<rows; i++){
+		row = a + (size_t)i*lda;
+		sum = 0;
+		for (j=0; j<columns; j++){
+			sum += row[j] * x[j];
+		}
+		y[i] = alpha*sum + ((beta == 0) ? 0 : beta*y[i]);
+	}
+
+	return;
+}
+
+static void portable_ger( int rows,
+						  int columns,
+						  double alpha,
+						  double* x,
+						  double* y,
+						  double* a,
+						  int lda )
+{
+	int i, j;
+	double scale, *row;
+
+	for (i=0; i<rows; i++){
+		scale = alpha * x[i];
+		row = a + (size_t)i*lda;
+		for (j=0; j<columns; j++){
+			row[j] += scale * y[j];
+		}
+	}
+
+	return;
+}
+
+static void portable_axpy( int size,
+						   double alpha,
+						   double* x,
+						   double* y )
+{
+	int i;
+	for (i=0; i<size; i++){
+		y[i] += alpha * x[i];
+	}
+	return;
+}
+
+static void portable_sgemm( int rows,
+							int columns,
+							int inner,
+							float alpha,
+							float* a,
+							int lda,
+							float* b,
+							int ldb,
+							float beta,
+							float* c,
+							int ldc )
+{
+	int i, j, k;
+	float scale, *row, *b_row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+		for (k=0; k<inner; k++){
+			scale = alpha * a[k + (size_t)i*lda];
+			b_row = b + (size_t)k*ldb;
+			for (j=0; j<columns; j++){
+				row[j] += scale * b_row[j];
+			}
+		}
+	}
+
+	return;
+}
+
+static void portable_sgemv( int rows,
+							int columns,
+							float alpha,
+							float* a,
+							int lda,
+							float* x,
+							float beta,
+							float* y )
+{
+	int i, j;
+	float sum, *row;
+
+	for (i=0; i<rows; i++){
+		row = a + (size_t)i*lda;
+		sum = 0;
+		for (j=0; j<columns; j++){
+			sum += row[j] * x[j];
+		}
+		y[i] = alpha*sum + ((beta == 0) ? 0 : beta*y[i]);
+	}
+
+	return;
+}
+
+//================================================================================================//
+//=====================================Unrolled Kernels===========================================//
+//================================================================================================//
+
+//===Four Independent Chains Per Iteration; Meant For Small Shapes===//
+static void unrolled_row_update( double scale,
+								 double* x,
+								 double* y,
+								 int size )
+{
+	int j;
+
+	for (j=0; j+4<=size; j+=4){
+		y[j] += scale * x[j];
+		y[j+1] += scale * x[j+1];
+		y[j+2] += scale * x[j+2];
+		y[j+3] += scale * x[j+3];
+	}
+	for (; j<size; j++){
+		y[j] += scale * x[j];
+	}
+
+	return;
+}
+
+static double unrolled_dot( double* x,
+							double* y,
+							int size )
+{
+	int j;
+	double sum[4];
+
+	sum[0] = 0; sum[1] = 0; sum[2] = 0; sum[3] = 0;
+	for (j=0; j+4<=size; j+=4){
+		sum[0] += x[j] * y[j];
+		sum[1] += x[j+1] * y[j+1];
+		sum[2] += x[j+2] * y[j+2];
+		sum[3] += x[j+3] * y[j+3];
+	}
+	for (; j<size; j++){
+		sum[0] += x[j] * y[j];
+	}
+
+	return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+static void unrolled_gemm( int rows,
+						   int columns,
+						   int inner,
+						   double alpha,
+						   double* a,
+						   int lda,
+						   double* b,
+						   int ldb,
+						   double beta,
+						   double* c,
+						   int ldc )
+{
+	int i, j, k;
+	double* row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+		for (k=0; k<inner; k++){
+			unrolled_row_update(alpha * a[k + (size_t)i*lda], b + (size_t)k*ldb, row, columns);
+		}
+	}
+
+	return;
+}
+
+static void unrolled_gemv( int rows,
+						   int columns,
+						   double alpha,
+						   double* a,
+						   int lda,
+						   double* x,
+						   double beta,
+						   double* y )
+{
+	int i;
+	for (i=0; i<rows; i++){
+		y[i] = alpha*unrolled_dot(a + (size_t)i*lda, x, columns) + ((beta == 0) ? 0 : beta*y[i]);
+	}
+	return;
+}
+
+static void unrolled_ger( int rows,
+						  int columns,
+						  double alpha,
+						  double* x,
+						  double* y,
+						  double* a,
+						  int lda )
+{
+	int i;
+	for (i=0; i<rows; i++){
+		unrolled_row_update(alpha * x[i], y, a + (size_t)i*lda, columns);
+	}
+	return;
+}
+
+static void unrolled_axpy( int size,
+						   double alpha,
+						   double* x,
+						   double* y )
+{
+	unrolled_row_update(alpha, x, y, size);
+	return;
+}
+
+//================================================================================================//
+//=======================================SIMD Kernels=============================================//
+//================================================================================================//
+
+#if SIMD_BACKEND_SUPPORTED
+
+//===Kernels Are Compiled For AVX2 But Only Called When The CPU Has It===//
+#define SIMD_TARGET __attribute__((target("avx2,fma")))
+
+//===Rows Of Padded Storage And Context Buffers: Aligned And Whole Multiples Of SIMD_WIDTH===//
+static inline int simd_rows_are_padded( double* x,
+										double* y,
+										int size )
+{
+	return ((((uintptr_t)x | (uintptr_t)y) % WEIGHT_ALIGNMENT) == 0) && (size % SIMD_WIDTH) == 0;
+}
+
+SIMD_TARGET static void simd_row_update( double scale,
+										 double* x,
+										 double* y,
+										 int size )
+{
+	int j;
+	__m256d s;
+
+	s = _mm256_set1_pd(scale);
+	if (simd_rows_are_padded(x, y, size)){
+		for (j=0; j<size; j+=4){
+			_mm256_store_pd(y+j, _mm256_fmadd_pd(s, _mm256_load_pd(x+j), _mm256_load_pd(y+j)));
+		}
+		return;
+	}
+	for (j=0; j+4<=size; j+=4){
+		_mm256_storeu_pd(y+j, _mm256_fmadd_pd(s, _mm256_loadu_pd(x+j), _mm256_loadu_pd(y+j)));
+	}
+	for (; j<size; j++){
+		y[j] += scale * x[j];
+	}
+
+	return;
+}
+
+SIMD_TARGET static double simd_dot( double* x,
+									double* y,
+									int size )
+{
+	int j;
+	double sum, lanes[4];
+	__m256d even, odd;
+
+	//===Two Accumulators Hide FMA Latency===//
+	even = _mm256_setzero_pd();
+	odd = _mm256_setzero_pd();
+	if (simd_rows_are_padded(x, y, size)){
+		for (j=0; j<size; j+=8){
+			even = _mm256_fmadd_pd(_mm256_load_pd(x+j), _mm256_load_pd(y+j), even);
+			odd = _mm256_fmadd_pd(_mm256_load_pd(x+j+4), _mm256_load_pd(y+j+4), odd);
+		}
+		_mm256_storeu_pd(lanes, _mm256_add_pd(even, odd));
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+	for (j=0; j+8<=size; j+=8){
+		even = _mm256_fmadd_pd(_mm256_loadu_pd(x+j), _mm256_loadu_pd(y+j), even);
+		odd = _mm256_fmadd_pd(_mm256_loadu_pd(x+j+4), _mm256_loadu_pd(y+j+4), odd);
+	}
+	for (; j+4<=size; j+=4){
+		even = _mm256_fmadd_pd(_mm256_loadu_pd(x+j), _mm256_loadu_pd(y+j), even);
+	}
+	_mm256_storeu_pd(lanes, _mm256_add_pd(even, odd));
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	for (; j<size; j++){
+		sum += x[j] * y[j];
+	}
+
+	return sum;
+}
+
+SIMD_TARGET static void simd_gemm( int rows,
+								   int columns,
+								   int inner,
+								   double alpha,
+								   double* a,
+								   int lda,
+								   double* b,
+								   int ldb,
+								   double beta,
+								   double* c,
+								   int ldc )
+{
+	int i, j, k;
+	double* row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+		for (k=0; k<inner; k++){
+			simd_row_update(alpha * a[k + (size_t)i*lda], b + (size_t)k*ldb, row, columns);
+		}
+	}
+
+	return;
+}
+
+SIMD_TARGET static void simd_blocked_gemm( int rows,
+										   int columns,
+										   int inner,
+										   double alpha,
+										   double* a,
+										   int lda,
+										   double* b,
+										   int ldb,
+										   double beta,
+										   double* c,
+										   int ldc )
+{
+	int i, j, k, jj, kk, width, depth;
+	double* row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+	}
+
+	//===Every Row Of A Reuses One Tile Of B While It Is In Cache===//
+	for (jj=0; jj<columns; jj+=GEMM_BLOCK_COLUMNS){
+		width = MIN(GEMM_BLOCK_COLUMNS, columns - jj);
+		for (kk=0; kk<inner; kk+=GEMM_BLOCK_INNER){
+			depth = MIN(GEMM_BLOCK_INNER, inner - kk);
+			for (i=0; i<rows; i++){
+				row = c + (size_t)i*ldc + jj;
+				for (k=kk; k<kk+depth; k++){
+					simd_row_update(alpha * a[k + (size_t)i*lda], b + (size_t)k*ldb + jj, row, width);
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+SIMD_TARGET static void simd_gemv( int rows,
+								   int columns,
+								   double alpha,
+								   double* a,
+								   int lda,
+								   double* x,
+								   double beta,
+								   double* y )
+{
+	int i;
+	for (i=0; i<rows; i++){
+		y[i] = alpha*simd_dot(a + (size_t)i*lda, x, columns) + ((beta == 0) ? 0 : beta*y[i]);
+	}
+	return;
+}
+
+SIMD_TARGET static void simd_ger( int rows,
+								  int columns,
+								  double alpha,
+								  double* x,
+								  double* y,
+								  double* a,
+								  int lda )
+{
+	int i;
+	for (i=0; i<rows; i++){
+		simd_row_update(alpha * x[i], y, a + (size_t)i*lda, columns);
+	}
+	return;
+}
+
+SIMD_TARGET static void simd_axpy( int size,
+								   double alpha,
+								   double* x,
+								   double* y )
+{
+	simd_row_update(alpha, x, y, size);
+	return;
+}
+
+SIMD_TARGET static void simd_row_update_float( float scale,
+											   float* x,
+											   float* y,
+											   int size )
+{
+	int j;
+	__m256 s;
+
+	s = _mm256_set1_ps(scale);
+	for (j=0; j+8<=size; j+=8){
+		_mm256_storeu_ps(y+j, _mm256_fmadd_ps(s, _mm256_loadu_ps(x+j), _mm256_loadu_ps(y+j)));
+	}
+	for (; j<size; j++){
+		y[j] += scale * x[j];
+	}
+
+	return;
+}
+
+SIMD_TARGET static float simd_dot_float( float* x,
+										 float* y,
+										 int size )
+{
+	int j;
+	float sum, lanes[8];
+	__m256 even, odd;
+
+	even = _mm256_setzero_ps();
+	odd = _mm256_setzero_ps();
+	for (j=0; j+16<=size; j+=16){
+		even = _mm256_fmadd_ps(_mm256_loadu_ps(x+j), _mm256_loadu_ps(y+j), even);
+		odd = _mm256_fmadd_ps(_mm256_loadu_ps(x+j+8), _mm256_loadu_ps(y+j+8), odd);
+	}
+	for (; j+8<=size; j+=8){
+		even = _mm256_fmadd_ps(_mm256_loadu_ps(x+j), _mm256_loadu_ps(y+j), even);
+	}
+	_mm256_storeu_ps(lanes, _mm256_add_ps(even, odd));
+	sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	for (; j<size; j++){
+		sum += x[j] * y[j];
+	}
+
+	return sum;
+}
+
+SIMD_TARGET static void simd_sgemm( int rows,
+									int columns,
+									int inner,
+									float alpha,
+									float* a,
+									int lda,
+									float* b,
+									int ldb,
+									float beta,
+									float* c,
+									int ldc )
+{
+	int i, j, k;
+	float* row;
+
+	for (i=0; i<rows; i++){
+		row = c + (size_t)i*ldc;
+		for (j=0; j<columns; j++){
+			row[j] = (beta == 0) ? 0 : beta*row[j];
+		}
+		for (k=0; k<inner; k++){
+			simd_row_update_float(alpha * a[k + (size_t)i*lda], b + (size_t)k*ldb, row, columns);
+		}
+	}
+
+	return;
+}
+
+SIMD_TARGET static void simd_sgemv( int rows,
+									int columns,
+									float alpha,
+									float* a,
+									int lda,
+									float* x,
+									float beta,
+									float* y )
+{
+	int i;
+	for (i=0; i<rows; i++){
+		y[i] = alpha*simd_dot_float(a + (size_t)i*lda, x, columns) + ((beta == 0) ? 0 : beta*y[i]);
+	}
+	return;
+}
+
+SIMD_TARGET static void simd_identity_kernel( double* input,
+											  double* activation,
+											  double* derivative,
+											  unsigned int num_nodes )
+{
+	unsigned int i;
+	__m256d one;
+
+	one = _mm256_set1_pd(1);
+	for (i=0; i+4<=num_nodes; i+=4){
+		_mm256_storeu_pd(activation+i, _mm256_loadu_pd(input+i));
+		_mm256_storeu_pd(derivative+i, one);
+	}
+	identity_kernel(input+i, activation+i, derivative+i, num_nodes-i);
+
+	return;
+}
+
+SIMD_TARGET static void simd_relu_kernel( double* input,
+										  double* activation,
+										  double* derivative,
+										  unsigned int num_nodes )
+{
+	unsigned int i;
+	__m256d x, zero, one, positive;
+
+	zero = _mm256_setzero_pd();
+	one = _mm256_set1_pd(1);
+	for (i=0; i+4<=num_nodes; i+=4){
+		x = _mm256_loadu_pd(input+i);
+		positive = _mm256_cmp_pd(x, zero, _CMP_GT_OQ);
+		_mm256_storeu_pd(activation+i, _mm256_and_pd(positive, x));
+		_mm256_storeu_pd(derivative+i, _mm256_and_pd(positive, one));
+	}
+	relu_kernel(input+i, activation+i, derivative+i, num_nodes-i);
+
+	return;
+}
+
+SIMD_TARGET static void simd_leaky_relu_kernel( double* input,
+												double* activation,
+												double* derivative,
+												unsigned int num_nodes )
+{
+	unsigned int i;
+	__m256d x, zero, one, slope, positive;
+
+	zero = _mm256_setzero_pd();
+	one = _mm256_set1_pd(1);
+	slope = _mm256_set1_pd(LEAKY_RELU_SLOPE);
+	for (i=0; i+4<=num_nodes; i+=4){
+		x = _mm256_loadu_pd(input+i);
+		positive = _mm256_cmp_pd(x, zero, _CMP_GT_OQ);
+		_mm256_storeu_pd(activation+i, _mm256_blendv_pd(_mm256_mul_pd(slope, x), x, positive));
+		_mm256_storeu_pd(derivative+i, _mm256_blendv_pd(slope, one, positive));
+	}
+	leaky_relu_kernel(input+i, activation+i, derivative+i, num_nodes-i);
+
+	return;
+}
+
+#endif
+
+//================================================================================================//
+//=======================================CBLAS Kernels============================================//
+//================================================================================================//
+
+typedef void (*cblas_dgemm_t)(int, int, int, int, int, int, double, const double*, int,
+							  const double*, int, double, double*, int);
+typedef void (*cblas_dgemv_t)(int, int, int, int, double, const double*, int,
+							  const double*, int, double, double*, int);
+typedef void (*cblas_dger_t)(int, int, int, double, const double*, int, const double*, int,
+							 double*, int);
+typedef void (*cblas_daxpy_t)(int, double, const double*, int, double*, int);
+typedef void (*cblas_sgemm_t)(int, int, int, int, int, int, float, const float*, int,
+							  const float*, int, float, float*, int);
+typedef void (*cblas_sgemv_t)(int, int, int, int, float, const float*, int,
+							  const float*, int, float, float*, int);
+
+//===Searched In Order, Optimized Libraries First===//
+static const char* cblas_libraries[] = { "libopenblas.so.0",
+										 "libmkl_rt.so",
+										 "libblis.so.4",
+										 "libcblas.so.3",
+										 "libblas.so.3",
+										 NULL };
+
+static pthread_once_t cblas_once = PTHREAD_ONCE_INIT;
+static void* cblas_handle = NULL;
+static cblas_dgemm_t cblas_dgemm_symbol;
+static cblas_dgemv_t cblas_dgemv_symbol;
+static cblas_dger_t cblas_dger_symbol;
+static cblas_daxpy_t cblas_daxpy_symbol;
+static cblas_sgemm_t cblas_sgemm_symbol;
+static cblas_sgemv_t cblas_sgemv_symbol;
+
+static void load_cblas()
+{
+	unsigned int i;
+	void* handle;
+
+	for (i=0; cblas_libraries[i] != NULL; i++){
+		handle = dlopen(cblas_libraries[i], RTLD_NOW | RTLD_LOCAL);
+		if (handle == NULL){
+			continue;
+		}
+		cblas_dgemm_symbol = (cblas_dgemm_t)dlsym(handle, "cblas_dgemm");
+		cblas_dgemv_symbol = (cblas_dgemv_t)dlsym(handle, "cblas_dgemv");
+		cblas_dger_symbol = (cblas_dger_t)dlsym(handle, "cblas_dger");
+		cblas_daxpy_symbol = (cblas_daxpy_t)dlsym(handle, "cblas_daxpy");
+		cblas_sgemm_symbol = (cblas_sgemm_t)dlsym(handle, "cblas_sgemm");
+		cblas_sgemv_symbol = (cblas_sgemv_t)dlsym(handle, "cblas_sgemv");
+
+		//===Some BLAS Builds Ship Without The C Interface===//
+		if (cblas_dgemm_symbol != NULL && cblas_dgemv_symbol != NULL &&
+			cblas_dger_symbol != NULL && cblas_daxpy_symbol != NULL &&
+			cblas_sgemm_symbol != NULL && cblas_sgemv_symbol != NULL){
+			cblas_handle = handle;
+			return;
+		}
+		dlclose(handle);
+	}
+
+	return;
+}
+
+static void cblas_gemm( int rows,
+						int columns,
+						int inner,
+						double alpha,
+						double* a,
+						int lda,
+						double* b,
+						int ldb,
+						double beta,
+						double* c,
+						int ldc )
+{
+	cblas_dgemm_symbol(CBLAS_ROW_MAJOR, CBLAS_NO_TRANSPOSE, CBLAS_NO_TRANSPOSE,
+					   rows, columns, inner, alpha, a, lda, b, ldb, beta, c, ldc);
+	return;
+}
+
+static void cblas_gemv( int rows,
+						int columns,
+						double alpha,
+						double* a,
+						int lda,
+						double* x,
+						double beta,
+						double* y )
+{
+	cblas_dgemv_symbol(CBLAS_ROW_MAJOR, CBLAS_NO_TRANSPOSE, rows, columns,
+					   alpha, a, lda, x, 1, beta, y, 1);
+	return;
+}
+
+static void cblas_ger( int rows,
+					   int columns,
+					   double alpha,
+					   double* x,
+					   double* y,
+					   double* a,
+					   int lda )
+{
+	cblas_dger_symbol(CBLAS_ROW_MAJOR, rows, columns, alpha, x, 1, y, 1, a, lda);
+	return;
+}
+
+static void cblas_axpy( int size,
+						double alpha,
+						double* x,
+						double* y )
+{
+	cblas_daxpy_symbol(size, alpha, x, 1, y, 1);
+	return;
+}
+
+static void cblas_sgemm( int rows,
+						 int columns,
+						 int inner,
+						 float alpha,
+						 float* a,
+						 int lda,
+						 float* b,
+						 int ldb,
+						 float beta,
+						 float* c,
+						 int ldc )
+{
+	cblas_sgemm_symbol(CBLAS_ROW_MAJOR, CBLAS_NO_TRANSPOSE, CBLAS_NO_TRANSPOSE,
+					   rows, columns, inner, alpha, a, lda, b, ldb, beta, c, ldc);
+	return;
+}
+
+static void cblas_sgemv( int rows,
+						 int columns,
+						 float alpha,
+						 float* a,
+						 int lda,
+						 float* x,
+						 float beta,
+						 float* y )
+{
+	cblas_sgemv_symbol(CBLAS_ROW_MAJOR, CBLAS_NO_TRANSPOSE, rows, columns,
+					   alpha, a, lda, x, 1, beta, y, 1);
+	return;
+}
+
+//================================================================================================//
+//====================================Backend Functions===========================================//
+//================================================================================================//
+
+static compute_backend_t portable_backend = { COMPUTE_BACKEND_PORTABLE, "portable",
+											  portable_gemm, portable_gemv, portable_ger, portable_axpy,
+											  portable_sgemm, portable_sgemv,
+											  { identity_kernel, sigmoid_kernel, tanh_kernel,
+												relu_kernel, leaky_relu_kernel, softmax_kernel } };
+
+static compute_backend_t unrolled_backend = { COMPUTE_BACKEND_UNROLLED, "unrolled",
+											  unrolled_gemm, unrolled_gemv, unrolled_ger, unrolled_axpy,
+											  portable_sgemm, portable_sgemv,
+											  { identity_kernel, sigmoid_kernel, tanh_kernel,
+												relu_kernel, leaky_relu_kernel, softmax_kernel } };
+
+static compute_backend_t cblas_backend = { COMPUTE_BACKEND_CBLAS, "cblas",
+										   cblas_gemm, cblas_gemv, cblas_ger, cblas_axpy,
+										   cblas_sgemm, cblas_sgemv,
+										   { identity_kernel, sigmoid_kernel, tanh_kernel,
+											 relu_kernel, leaky_relu_kernel, softmax_kernel } };
+
+#if SIMD_BACKEND_SUPPORTED
+static compute_backend_t simd_backend = { COMPUTE_BACKEND_SIMD, "simd",
+										  simd_gemm, simd_gemv, simd_ger, simd_axpy,
+										  simd_sgemm, simd_sgemv,
+										  { simd_identity_kernel, sigmoid_kernel, tanh_kernel,
+											simd_relu_kernel, simd_leaky_relu_kernel, softmax_kernel } };
+
+static compute_backend_t simd_blocked_backend = { COMPUTE_BACKEND_SIMD_BLOCKED, "simd_blocked",
+												  simd_blocked_gemm, simd_gemv, simd_ger, simd_axpy,
+												  simd_sgemm, simd_sgemv,
+												  { simd_identity_kernel, sigmoid_kernel, tanh_kernel,
+													simd_relu_kernel, simd_leaky_relu_kernel, softmax_kernel } };
+#endif
+
+compute_backend_t* get_compute_backend( compute_backend_type_t type )
+{
+	switch (type){
+		case COMPUTE_BACKEND_AUTO:
+			if (get_compute_backend(COMPUTE_BACKEND_CBLAS) != NULL){
+				return &cblas_backend;
+			}
+			if (get_compute_backend(COMPUTE_BACKEND_SIMD) != NULL){
+				return get_compute_backend(COMPUTE_BACKEND_SIMD);
+			}
+			return &portable_backend;
+		case COMPUTE_BACKEND_CBLAS:
+			pthread_once(&cblas_once, load_cblas);
+			return (cblas_handle != NULL) ? &cblas_backend : NULL;
+		case COMPUTE_BACKEND_PORTABLE:
+			return &portable_backend;
+		case COMPUTE_BACKEND_SIMD:
+			#if SIMD_BACKEND_SUPPORTED
+				if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+					return &simd_backend;
+				}
+			#endif
+			return NULL;
+		case COMPUTE_BACKEND_UNROLLED:
+			return &unrolled_backend;
+		case COMPUTE_BACKEND_SIMD_BLOCKED:
+			#if SIMD_BACKEND_SUPPORTED
+				if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+					return &simd_blocked_backend;
+				}
+			#endif
+			return NULL;
+		default:
+			fprintf(stderr, "Error:: Input Parameter 'type' Is Invalid! In Function -- get_compute_backend\n");
+			return NULL;
+	}
+}
+
+int set_compute_backend( neural_network_t* self,
+						 compute_backend_type_t type )
+{
+	unsigned int i, o;
+	compute_backend_t* backend;
+
+	backend = get_compute_backend(type);
+	if (backend == NULL){
+		fprintf(stderr, "Error:: Compute Backend %d Is Not Available! In Function -- set_compute_backend\n", type);
+		return -1;
+	}
+
+	self->backend = backend;
+	for (i=0; i<self->num_hidden_layers+2; i++){
+		self->layer[i].backend = backend;
+		for (o=0; o<NUM_LAYER_OPERATIONS; o++){
+			self->layer[i].operation_backend[o] = backend;
+		}
+	}
+
+	return 0;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+static double max_difference( double* x,
+							  double* y,
+							  unsigned int size )
+{
+	unsigned int i;
+	double difference;
+
+	difference = 0;
+	for (i=0; i<size; i++){
+		difference = MAX(difference, fabs(x[i] - y[i]));
+	}
+
+	return difference;
+}
+
+void test_compute_backends()
+{
+	unsigned int i, a, t;
+	unsigned int num_nodes[4];
+	double a_matrix[5*19], b_matrix[17*13], x[17], y[5];
+	double expected[5*13], result[5*13], activation[2][17], derivative[2][17];
+	double output[2], *large_a, *large_b, *large_expected, *large_result;
+	float a_float[5*19], b_float[17*13], expected_float[5*13+5], result_float[5*13+5];
+	compute_backend_t *reference, *backend;
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *padded;
+
+	//===Odd Sizes And Strides Exercise Every Remainder Loop===//
+	for (i=0; i<5*19; i++){
+		a_matrix[i] = sin(0.3*i);
+	}
+	for (i=0; i<17*13; i++){
+		b_matrix[i] = cos(0.7*i);
+	}
+	for (i=0; i<17; i++){
+		x[i] = 0.25*i - 2;
+	}
+
+	//===Shapes Spanning Several gemm Blocks===//
+	large_a = malloc(3*140*sizeof(double));
+	large_b = malloc(140*150*sizeof(double));
+	large_expected = malloc(3*150*sizeof(double));
+	large_result = malloc(3*150*sizeof(double));
+	if (large_a == NULL || large_b == NULL || large_expected == NULL || large_result == NULL){
+		fprintf(stderr, "Error: Test Buffers Were Not Allocated!\n");
+		free(large_a); free(large_b); free(large_expected); free(large_result);
+		return;
+	}
+	for (i=0; i<3*140; i++){
+		large_a[i] = sin(0.11*i);
+	}
+	for (i=0; i<140*150; i++){
+		large_b[i] = cos(0.13*i);
+	}
+
+	reference = get_compute_backend(COMPUTE_BACKEND_PORTABLE);
+	for (t=COMPUTE_BACKEND_CBLAS; t<NUM_COMPUTE_BACKENDS; t++){
+		backend = get_compute_backend(t);
+		if (backend == NULL || backend == reference){
+			continue;
+		}
+
+		//===gemm With beta Zero Then Accumulating===//
+		reference->gemm(5, 11, 17, 0.5, a_matrix, 19, b_matrix, 13, 0, expected, 13);
+		backend->gemm(5, 11, 17, 0.5, a_matrix, 19, b_matrix, 13, 0, result, 13);
+		reference->gemm(5, 11, 17, 1, a_matrix, 19, b_matrix, 13, -2, expected, 13);
+		backend->gemm(5, 11, 17, 1, a_matrix, 19, b_matrix, 13, -2, result, 13);
+		for (i=0; i<5; i++){
+			if (max_difference(expected + i*13, result + i*13, 11) > 1e-12){
+				fprintf(stderr, "Error: Backend %s gemm Has Failed!\n", backend->name);
+				break;
+			}
+		}
+		reference->gemm(3, 150, 140, 1, large_a, 140, large_b, 150, 0, large_expected, 150);
+		backend->gemm(3, 150, 140, 1, large_a, 140, large_b, 150, 0, large_result, 150);
+		if (max_difference(large_expected, large_result, 3*150) > 1e-10){
+			fprintf(stderr, "Error: Backend %s gemm Has Failed Across Blocks!\n", backend->name);
+		}
+
+		//===gemv===//
+		reference->gemv(5, 17, 2, a_matrix, 19, x, 0, expected);
+		backend->gemv(5, 17, 2, a_matrix, 19, x, 0, result);
+		if (max_difference(expected, result, 5) > 1e-12){
+			fprintf(stderr, "Error: Backend %s gemv Has Failed!\n", backend->name);
+		}
+
+		//===ger And axpy===//
+		for (i=0; i<5; i++){
+			y[i] = i - 1.5;
+		}
+		memcpy(expected, b_matrix, 5*13*sizeof(double));
+		memcpy(result, b_matrix, 5*13*sizeof(double));
+		reference->ger(5, 13, 0.1, y, x, expected, 13);
+		backend->ger(5, 13, 0.1, y, x, result, 13);
+		reference->axpy(63, -0.3, a_matrix, expected);
+		backend->axpy(63, -0.3, a_matrix, result);
+		if (max_difference(expected, result, 5*13) > 1e-12){
+			fprintf(stderr, "Error: Backend %s ger Or axpy Has Failed!\n", backend->name);
+		}
+
+		//===Single Precision gemm And gemv===//
+		for (i=0; i<5*19; i++){
+			a_float[i] = (float)a_matrix[i];
+		}
+		for (i=0; i<17*13; i++){
+			b_float[i] = (float)b_matrix[i];
+		}
+		reference->sgemm(5, 11, 17, 0.5f, a_float, 19, b_float, 13, 0, expected_float, 13);
+		backend->sgemm(5, 11, 17, 0.5f, a_float, 19, b_float, 13, 0, result_float, 13);
+		reference->sgemv(5, 17, 2, a_float, 19, b_float, 0, expected_float + 5*13);
+		backend->sgemv(5, 17, 2, a_float, 19, b_float, 0, result_float + 5*13);
+		for (i=0; i<5*13+5; i++){
+			if ((i%13 < 11 || i >= 5*13) && fabsf(expected_float[i] - result_float[i]) > 1e-4f){
+				fprintf(stderr, "Error: Backend %s sgemm Or sgemv Has Failed!\n", backend->name);
+				break;
+			}
+		}
+
+		//===Activations===//
+		for (a=0; a<NUM_ACTIVATIONS; a++){
+			reference->activate[a](x, activation[0], derivative[0], 17);
+			backend->activate[a](x, activation[1], derivative[1], 17);
+			if (max_difference(activation[0], activation[1], 17) > 1e-12 ||
+				max_difference(derivative[0], derivative[1], 17) > 1e-12){
+				fprintf(stderr, "Error: Backend %s Activation %d Has Failed!\n", backend->name, a);
+			}
+		}
+	}
+
+	free(large_a);
+	free(large_b);
+	free(large_expected);
+	free(large_result);
+
+	//===Switching Backends Keeps Outputs===//
+	num_nodes[0] = 17; num_nodes[1] = 9; num_nodes[2] = 6; num_nodes[3] = 2;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->activation[1] = ACTIVATION_RELU;
+	parameters->activation[3] = ACTIVATION_SOFTMAX;
+	parameters->backend = COMPUTE_BACKEND_PORTABLE;
+	network = create_neural_network(parameters);
+	feed_forward(network, x);
+	output[0] = network->output[0]; output[1] = network->output[1];
+	for (t=COMPUTE_BACKEND_CBLAS; t<NUM_COMPUTE_BACKENDS; t++){
+		if (get_compute_backend(t) == NULL){
+			continue;
+		}
+		set_compute_backend(network, t);
+		feed_forward(network, x);
+		if (max_difference(output, network->output, 2) > 1e-12){
+			fprintf(stderr, "Error: Function set_compute_backend Has Failed!\n");
+		}
+	}
+
+	//===Padded Storage Runs Whole Rows Yet Trains Like Packed===//
+	set_compute_backend(network, COMPUTE_BACKEND_PORTABLE);
+	y[0] = 1; y[1] = 0;
+	iterate_network(network, x, y);
+	feed_forward(network, x);
+	output[0] = network->output[0]; output[1] = network->output[1];
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	for (t=COMPUTE_BACKEND_PORTABLE; t<NUM_COMPUTE_BACKENDS; t++){
+		if (get_compute_backend(t) == NULL){
+			continue;
+		}
+		parameters->backend = t;
+		padded = create_neural_network(parameters);
+		iterate_network(padded, x, y);
+		feed_forward(padded, x);
+		if (max_difference(output, padded->output, 2) > 1e-12){
+			fprintf(stderr, "Error: Backend %s Does Not Match On Padded Storage!\n", padded->backend->name);
+		}
+		for (i=0; i<padded->layer[0].num_nodes+1; i++){
+			if (padded->layer[0].weight_matrix[i*padded->layer[0].leading_dimension + 9] != 0){
+				fprintf(stderr, "Error: Backend %s Wrote Into Padding!\n", padded->backend->name);
+				break;
+			}
+		}
+		destroy_neural_network(padded);
+	}
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
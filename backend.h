@@ -0,0 +1,64 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include "neural_network.h"
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function returns the kernels of a compute backend.
+*
+* The CBLAS backend resolves its kernels from the first of the known CBLAS libraries that can be
+* opened at run time, so no BLAS is needed at link time. The SIMD backends are only returned on
+* CPUs with AVX2 and FMA. COMPUTE_BACKEND_AUTO returns the first available of CBLAS, SIMD and
+* portable.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compute_backend_type_t type
+*
+* @return compute_backend_t* backend (NULL if not available on this machine)
+*/
+//================================================================================================//
+compute_backend_t* get_compute_backend( compute_backend_type_t type );
+
+
+//================================================================================================//
+/**
+* @brief This function switches a network and all of its layers to another backend.
+*
+* Every layer operation is switched too, discarding any autotuned choice. It must not be
+* called while another thread is using the network.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] compute_backend_type_t type
+*
+* @return int status (0 on success, -1 if the backend is not available)
+*/
+//================================================================================================//
+int set_compute_backend( neural_network_t* self,
+						 compute_backend_type_t type );
+
+
+//================================================================================================//
+/**
+* @brief This function tests every available backend against the portable one.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_compute_backends();
+
+
+
+#endif //BACKEND_H//
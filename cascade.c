@@ -0,0 +1,358 @@
+#include "cascade.h"
+#include "helper.h"
+
+//================================================================================================//
+//=======================================Helper Functions=========================================//
+//================================================================================================//
+
+static double count_multiply_adds( neural_network_t* network )
+{
+	unsigned int l;
+	double total;
+
+	total = 0;
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		total += (double)(network->layer[l].num_nodes + 1) * network->layer[l+1].num_nodes;
+	}
+
+	return total;
+}
+
+static double output_confidence( double* output,
+								 unsigned int num_outputs )
+{
+	if (num_outputs == 1){
+		return MAX(output[0], 1 - output[0]);
+	}
+	return output[vector_argmax(output, num_outputs)];
+}
+
+static int output_is_correct( double* output,
+							  double* label,
+							  unsigned int num_outputs )
+{
+	if (num_outputs == 1){
+		return (output[0] >= 0.5) == (label[0] >= 0.5);
+	}
+	return vector_argmax(output, num_outputs) == vector_argmax(label, num_outputs);
+}
+
+//===A Calibration Sample's Small Network Confidence===//
+typedef struct confidence_rank_s{
+	double confidence;
+	unsigned int sample;
+} confidence_rank_t;
+
+//===Most Confident First===//
+static int compare_confidence( const void* a,
+							   const void* b )
+{
+	double x, y;
+	x = ((const confidence_rank_t*)a)->confidence;
+	y = ((const confidence_rank_t*)b)->confidence;
+	return (x < y) - (x > y);
+}
+
+//================================================================================================//
+//======================================Cascade Functions=========================================//
+//================================================================================================//
+
+cascade_t* create_cascade( neural_network_t* small,
+						   neural_network_t* large,
+						   double threshold )
+{
+	cascade_t* self;
+
+	if (small == NULL || large == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- create_cascade\n");
+		return NULL;
+	}
+	if (small->layer[0].num_nodes != large->layer[0].num_nodes ||
+		small->layer[small->num_hidden_layers+1].num_nodes != large->layer[large->num_hidden_layers+1].num_nodes){
+		fprintf(stderr, "Error:: Networks Have Different Inputs Or Outputs! In Function -- create_cascade\n");
+		return NULL;
+	}
+
+	self = malloc(sizeof(cascade_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Cascade Was Not Allocated! In Function -- create_cascade\n");
+		return NULL;
+	}
+	self->small = small;
+	self->large = large;
+	self->threshold = threshold;
+	self->small_cost = count_multiply_adds(small);
+	self->large_cost = count_multiply_adds(large);
+	atomic_init(&(self->num_samples), 0);
+	atomic_init(&(self->num_escalated), 0);
+
+	return self;
+}
+
+void destroy_cascade( cascade_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Cascade Is NULL! In Function -- destroy_cascade\n");
+		return;
+	}
+	free(self);
+	return;
+}
+
+int cascade_feed_forward( cascade_t* self,
+						  neural_context_t* small_context,
+						  neural_context_t* large_context,
+						  double* input,
+						  double* output )
+{
+	unsigned int num_outputs;
+
+	if (self == NULL || small_context == NULL || large_context == NULL || input == NULL || output == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- cascade_feed_forward\n");
+		return -1;
+	}
+	num_outputs = self->small->layer[self->small->num_hidden_layers+1].num_nodes;
+	atomic_fetch_add_explicit(&(self->num_samples), 1, memory_order_relaxed);
+
+	//===Easy Inputs Stop At The Small Network===//
+	feed_forward_context(self->small, small_context, input);
+	if (output_confidence(small_context->output, num_outputs) >= self->threshold){
+		memcpy(output, small_context->output, num_outputs * sizeof(double));
+		return 0;
+	}
+
+	atomic_fetch_add_explicit(&(self->num_escalated), 1, memory_order_relaxed);
+	feed_forward_context(self->large, large_context, input);
+	memcpy(output, large_context->output, num_outputs * sizeof(double));
+
+	return 1;
+}
+
+double calibrate_cascade( cascade_t* self,
+						  double* inputs,
+						  double* labels,
+						  unsigned int num_samples,
+						  double target_accuracy )
+{
+	unsigned int s, k, best, num_inputs, num_outputs, *small_right, *large_right;
+	unsigned int kept_right, escalated_right;
+	double *label, accuracy, best_accuracy;
+	confidence_rank_t* ranked;
+	neural_context_t *small_context, *large_context;
+
+	if (self == NULL || inputs == NULL || labels == NULL || num_samples == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- calibrate_cascade\n");
+		return -1;
+	}
+	num_inputs = self->small->layer[0].num_nodes;
+	num_outputs = self->small->layer[self->small->num_hidden_layers+1].num_nodes;
+
+	ranked = malloc(num_samples * sizeof(confidence_rank_t));
+	small_right = malloc(num_samples * sizeof(unsigned int));
+	large_right = malloc(num_samples * sizeof(unsigned int));
+	small_context = create_neural_context(self->small);
+	large_context = create_neural_context(self->large);
+	if (ranked == NULL || small_right == NULL || large_right == NULL ||
+		small_context == NULL || large_context == NULL){
+		fprintf(stderr, "Error:: Buffers Were Not Allocated! In Function -- calibrate_cascade\n");
+		free(ranked); free(small_right); free(large_right);
+		if (small_context != NULL) destroy_neural_context(small_context);
+		if (large_context != NULL) destroy_neural_context(large_context);
+		return -1;
+	}
+
+	//===Both Stages On Every Sample===//
+	escalated_right = 0;
+	for (s=0; s<num_samples; s++){
+		label = labels + (size_t)s*num_outputs;
+		feed_forward_context(self->small, small_context, inputs + (size_t)s*num_inputs);
+		feed_forward_context(self->large, large_context, inputs + (size_t)s*num_inputs);
+		ranked[s].confidence = output_confidence(small_context->output, num_outputs);
+		ranked[s].sample = s;
+		small_right[s] = output_is_correct(small_context->output, label, num_outputs);
+		large_right[s] = output_is_correct(large_context->output, label, num_outputs);
+		escalated_right += large_right[s];
+	}
+	qsort(ranked, num_samples, sizeof(confidence_rank_t), compare_confidence);
+
+	//===Keep The k Most Confident On The Small Network; Only Splits Between Distinct Confidences===//
+	kept_right = 0;
+	best = 0;
+	best_accuracy = (double)escalated_right / num_samples;
+	for (k=1; k<=num_samples; k++){
+		kept_right += small_right[ranked[k-1].sample];
+		escalated_right -= large_right[ranked[k-1].sample];
+		if (k < num_samples && ranked[k].confidence == ranked[k-1].confidence){
+			continue;
+		}
+		accuracy = (double)(kept_right + escalated_right) / num_samples;
+		if (accuracy >= target_accuracy){
+			best = k;
+			best_accuracy = accuracy;
+		}
+	}
+	self->threshold = (best == 0) ? DBL_MAX : ranked[best-1].confidence;
+
+	free(ranked);
+	free(small_right);
+	free(large_right);
+	destroy_neural_context(small_context);
+	destroy_neural_context(large_context);
+
+	return best_accuracy;
+}
+
+void get_cascade_stats( cascade_t* self,
+						cascade_stats_t* stats )
+{
+	if (self == NULL || stats == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- get_cascade_stats\n");
+		return;
+	}
+
+	stats->num_samples = atomic_load_explicit(&(self->num_samples), memory_order_relaxed);
+	stats->num_escalated = atomic_load_explicit(&(self->num_escalated), memory_order_relaxed);
+	stats->escalation_rate = (stats->num_samples > 0) ? (double)stats->num_escalated / stats->num_samples : 0;
+	stats->average_cost = self->small_cost + stats->escalation_rate * self->large_cost;
+	stats->relative_cost = stats->average_cost / self->large_cost;
+
+	return;
+}
+
+void reset_cascade_stats( cascade_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Cascade Is NULL! In Function -- reset_cascade_stats\n");
+		return;
+	}
+	atomic_store(&(self->num_samples), 0);
+	atomic_store(&(self->num_escalated), 0);
+	return;
+}
+
+void print_cascade_report( cascade_t* self )
+{
+	cascade_stats_t stats;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Cascade Is NULL! In Function -- print_cascade_report\n");
+		return;
+	}
+
+	get_cascade_stats(self, &stats);
+	fprintf(stdout, "Cascade: Threshold %lf, %lu Samples, Escalation Rate %.1lf%%\n",
+			self->threshold, stats.num_samples, 100.0*stats.escalation_rate);
+	fprintf(stdout, "Average Cost %.0lf Multiply-Adds Per Sample (Small %.0lf, Large %.0lf), %.1lf%% Of Large Alone\n",
+			stats.average_cost, self->small_cost, self->large_cost, 100.0*stats.relative_cost);
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_cascade()
+{
+	unsigned int i, j, s, n, num_right, num_escalated, num_nodes[4];
+	double inputs[200*5], labels[200*3], output[3], accuracy;
+	neural_network_parameters_t *small_parameters, *large_parameters;
+	neural_network_t *small, *large;
+	neural_context_t *small_context, *large_context;
+	cascade_t* cascade;
+	cascade_stats_t stats;
+
+	//===The Label Is The Largest Of The First Three Inputs===//
+	for (s=0; s<200; s++){
+		for (i=0; i<5; i++){
+			inputs[s*5 + i] = sin(0.41*s*(i+1) + i);
+		}
+		memset(labels + s*3, 0, 3*sizeof(double));
+		for (j=1, i=0; j<3; j++){
+			i = (inputs[s*5 + j] > inputs[s*5 + i]) ? j : i;
+		}
+		labels[s*3 + i] = 1;
+	}
+
+	//===A Briefly Trained Small Network And A Longer Trained Large One===//
+	num_nodes[0] = 5; num_nodes[1] = 4; num_nodes[2] = 3;
+	small_parameters = create_neural_network_parameters(1, num_nodes, 0.1);
+	small_parameters->activation[2] = ACTIVATION_SOFTMAX;
+	num_nodes[0] = 5; num_nodes[1] = 24; num_nodes[2] = 16; num_nodes[3] = 3;
+	large_parameters = create_neural_network_parameters(2, num_nodes, 0.1);
+	large_parameters->activation[3] = ACTIVATION_SOFTMAX;
+	small = create_neural_network(small_parameters);
+	large = create_neural_network(large_parameters);
+	for (n=0; n<40; n++){
+		for (s=0; s<200; s++){
+			if (n < 2){
+				iterate_network(small, inputs + s*5, labels + s*3);
+			}
+			iterate_network(large, inputs + s*5, labels + s*3);
+		}
+	}
+
+	cascade = create_cascade(small, large, 0);
+	small_context = create_neural_context(small);
+	large_context = create_neural_context(large);
+	if (cascade == NULL || small_context == NULL || large_context == NULL){
+		fprintf(stderr, "Error: Function create_cascade Has Failed!\n");
+		if (cascade != NULL){
+			destroy_cascade(cascade);
+		}
+		if (small_context != NULL){
+			destroy_neural_context(small_context);
+		}
+		if (large_context != NULL){
+			destroy_neural_context(large_context);
+		}
+		destroy_neural_network(small);
+		destroy_neural_network(large);
+		free(small_parameters);
+		free(large_parameters);
+		return;
+	}
+
+	//===The Calibrated Threshold Achieves What Calibration Reported===//
+	accuracy = calibrate_cascade(cascade, inputs, labels, 200, 0.9);
+	num_right = 0;
+	num_escalated = 0;
+	for (s=0; s<200; s++){
+		num_escalated += cascade_feed_forward(cascade, small_context, large_context, inputs + s*5, output);
+		for (j=1, i=0; j<3; j++){
+			i = (output[j] > output[i]) ? j : i;
+		}
+		num_right += (labels[s*3 + i] == 1);
+	}
+	if (accuracy < 0.9 || fabs(accuracy - num_right/200.0) > 1e-12 || num_escalated == 200){
+		fprintf(stderr, "Error: Function calibrate_cascade Reported %lf But Achieved %lf!\n", accuracy, num_right/200.0);
+	}
+
+	//===Counters And Cost Follow The Escalations===//
+	get_cascade_stats(cascade, &stats);
+	if (stats.num_samples != 200 || stats.num_escalated != num_escalated ||
+		fabs(stats.average_cost - (cascade->small_cost + num_escalated/200.0 * cascade->large_cost)) > 1e-9){
+		fprintf(stderr, "Error: Function get_cascade_stats Has Failed!\n");
+	}
+
+	//===Without A Target Nothing Escalates===//
+	reset_cascade_stats(cascade);
+	calibrate_cascade(cascade, inputs, labels, 200, 0);
+	for (s=0; s<200; s++){
+		cascade_feed_forward(cascade, small_context, large_context, inputs + s*5, output);
+	}
+	get_cascade_stats(cascade, &stats);
+	if (stats.num_samples != 200 || stats.num_escalated != 0){
+		fprintf(stderr, "Error: Function calibrate_cascade Escalated Without A Target!\n");
+	}
+
+	destroy_cascade(cascade);
+	destroy_neural_context(small_context);
+	destroy_neural_context(large_context);
+	destroy_neural_network(small);
+	destroy_neural_network(large);
+	free(small_parameters);
+	free(large_parameters);
+
+	return;
+}
@@ -0,0 +1,199 @@
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct cascade_t
+*   @brief This structure comprises a two-stage early-exit cascade of networks.
+*
+*	Every input goes through the small network first. Its confidence is the largest output, or
+*	max(y, 1-y) for a single output; at or above threshold its output is returned, otherwise the
+*	input escalates to the large network. Costs are multiply-adds per sample of each network;
+*	the counters are shared by every thread using the cascade.
+*/
+//================================================================================================//
+typedef struct cascade_s cascade_t;
+typedef struct cascade_s{
+	neural_network_t* small;
+	neural_network_t* large;
+	double threshold;
+	double small_cost;
+	double large_cost;
+	atomic_uint_fast64_t num_samples;
+	atomic_uint_fast64_t num_escalated;
+} cascade_t;
+
+
+//================================================================================================//
+/** @struct cascade_stats_t
+*   @brief This structure comprises the escalation rate and cost of a cascade so far.
+*
+*	average_cost is small_cost + escalation_rate * large_cost, and relative_cost is that over
+*	the cost of running only the large network.
+*/
+//================================================================================================//
+typedef struct cascade_stats_s cascade_stats_t;
+typedef struct cascade_stats_s{
+	uint64_t num_samples;
+	uint64_t num_escalated;
+	double escalation_rate;
+	double average_cost;
+	double relative_cost;
+} cascade_stats_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a cascade_t object over two networks with the same inputs and outputs.
+*
+* The networks are not owned by the cascade.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* small
+* @param[in] neural_network_t* large
+* @param[in] double threshold
+*
+* @return cascade_t* self
+*/
+//================================================================================================//
+cascade_t* create_cascade( neural_network_t* small,
+						   neural_network_t* large,
+						   double threshold );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a cascade_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] cascade_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_cascade( cascade_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function runs one input through the cascade and copies the answer to output.
+*
+* Threads may share a cascade, each with its own pair of contexts.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] cascade_t* self
+* @param[in,out] neural_context_t* small_context
+* @param[in,out] neural_context_t* large_context
+* @param[in] double* input
+* @param[out] double* output
+*
+* @return int stage (0 if the small network answered, 1 if escalated, -1 on error)
+*/
+//================================================================================================//
+int cascade_feed_forward( cascade_t* self,
+						  neural_context_t* small_context,
+						  neural_context_t* large_context,
+						  double* input,
+						  double* output );
+
+
+//================================================================================================//
+/**
+* @brief This function sets the lowest threshold whose cascade accuracy meets a target.
+*
+* Both networks are run on the labelled calibration set. A sample is right when its largest
+* output matches the label's (or, for one output, both sit on the same side of one half). Of
+* the thresholds that keep accuracy at or above target_accuracy, the one escalating fewest
+* samples is kept; if none does, every sample escalates.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] cascade_t* self
+* @param[in] double* inputs
+* @param[in] double* labels
+* @param[in] unsigned int num_samples
+* @param[in] double target_accuracy
+*
+* @return double accuracy (calibration set accuracy at the chosen threshold, -1 on error)
+*/
+//================================================================================================//
+double calibrate_cascade( cascade_t* self,
+						  double* inputs,
+						  double* labels,
+						  unsigned int num_samples,
+						  double target_accuracy );
+
+
+//================================================================================================//
+/**
+* @brief This function reads the escalation rate and average cost of a cascade.
+*
+* If errors occur, the function exits.
+*
+* @param[in] cascade_t* self
+* @param[out] cascade_stats_t* stats
+*
+* @return NONE
+*/
+//================================================================================================//
+void get_cascade_stats( cascade_t* self,
+						cascade_stats_t* stats );
+
+
+//================================================================================================//
+/**
+* @brief This function clears the counters of a cascade.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] cascade_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void reset_cascade_stats( cascade_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function prints the threshold, escalation rate and average cost of a cascade.
+*
+* If errors occur, the function exits.
+*
+* @param[in] cascade_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_cascade_report( cascade_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests cascade inference, calibration and the cost counters.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_cascade();
+
+
+
+#endif //CASCADE_H//
@@ -0,0 +1,588 @@
+#include "checkpoint.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//=====================================File Functions=============================================//
+//================================================================================================//
+
+static void make_checkpoint_path( checkpoint_writer_t* self,
+								  uint64_t iteration,
+								  char* suffix,
+								  char* path )
+{
+	snprintf(path, MAX_CHECKPOINT_PATH, "%s_%llu.ckpt%s", self->prefix, (unsigned long long)iteration, suffix);
+	return;
+}
+
+static void split_checkpoint_prefix( checkpoint_writer_t* self,
+									 char* directory,
+									 char** base )
+{
+	char* slash;
+
+	strcpy(directory, self->prefix);
+	slash = strrchr(directory, '/');
+	if (slash == NULL){
+		strcpy(directory, ".");
+		*base = self->prefix;
+		return;
+	}
+	*base = self->prefix + (slash - directory) + 1;
+	if (slash == directory){
+		slash++;
+	}
+	*slash = '\0';
+
+	return;
+}
+
+static int sync_checkpoint_directory( checkpoint_writer_t* self )
+{
+	int fd, status;
+	char directory[MAX_CHECKPOINT_PATH], *base;
+
+	split_checkpoint_prefix(self, directory, &base);
+	fd = open(directory, O_RDONLY | O_DIRECTORY);
+	if (fd < 0){
+		return -1;
+	}
+	status = fsync(fd);
+	close(fd);
+
+	return status;
+}
+
+static void fill_checkpoint_header( neural_network_t* network,
+									uint64_t iteration,
+									checkpoint_header_t* header )
+{
+	unsigned int i;
+
+	memset(header, 0, sizeof(checkpoint_header_t));
+	header->magic = CHECKPOINT_MAGIC;
+	header->format_version = CHECKPOINT_FORMAT_VERSION;
+	header->iteration = iteration;
+	header->arena_size = network->arena_size;
+	header->num_hidden_layers = network->num_hidden_layers;
+	header->weight_storage = network->weight_storage;
+	for (i=0; i<network->num_hidden_layers+2; i++){
+		header->num_nodes[i] = network->layer[i].num_nodes;
+	}
+
+	return;
+}
+
+static int write_checkpoint_file( checkpoint_writer_t* self,
+								  double* arena,
+								  uint64_t iteration )
+{
+	FILE* fp;
+	int status;
+	char temp_path[MAX_CHECKPOINT_PATH], path[MAX_CHECKPOINT_PATH];
+	checkpoint_header_t header;
+
+	make_checkpoint_path(self, iteration, ".tmp", temp_path);
+	make_checkpoint_path(self, iteration, "", path);
+	fill_checkpoint_header(self->network, iteration, &header);
+
+	//===Write To A Temporary File===//
+	fp = NULL;
+	fp = fopen(temp_path, "wb");
+	if (fp == NULL){
+		fprintf(stderr, "Error:: Could Not Open '%s'! In Function -- write_checkpoint_file\n", temp_path);
+		return -1;
+	}
+	status = 0;
+	if (fwrite(&header, sizeof(checkpoint_header_t), 1, fp) != 1 ||
+		fwrite(arena, sizeof(double), header.arena_size, fp) != header.arena_size ||
+		fflush(fp) != 0 || fsync(fileno(fp)) != 0){
+		status = -1;
+	}
+	if (fclose(fp) != 0){
+		status = -1;
+	}
+	if (status != 0){
+		fprintf(stderr, "Error:: Could Not Write '%s'! In Function -- write_checkpoint_file\n", temp_path);
+		unlink(temp_path);
+		return status;
+	}
+
+	//===Publish Atomically; The Rename Is Durable Once The Directory Is Synced===//
+	if (rename(temp_path, path) != 0){
+		fprintf(stderr, "Error:: Could Not Rename '%s'! In Function -- write_checkpoint_file\n", temp_path);
+		unlink(temp_path);
+		return -1;
+	}
+	if (sync_checkpoint_directory(self) != 0){
+		fprintf(stderr, "Error:: Could Not Sync The Directory Of '%s'! In Function -- write_checkpoint_file\n", path);
+		unlink(path);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void rotate_checkpoints( checkpoint_writer_t* self,
+								uint64_t iteration )
+{
+	unsigned int i;
+	char path[MAX_CHECKPOINT_PATH];
+
+	//===Drop The Oldest Once Full===//
+	if (self->num_kept == self->keep_last){
+		make_checkpoint_path(self, self->kept[0], "", path);
+		unlink(path);
+		for (i=1; i<self->num_kept; i++){
+			self->kept[i-1] = self->kept[i];
+		}
+		self->num_kept--;
+	}
+	self->kept[self->num_kept++] = iteration;
+
+	return;
+}
+
+static void seed_checkpoint_rotation( checkpoint_writer_t* self )
+{
+	unsigned int i;
+	size_t length;
+	uint64_t iteration;
+	char directory[MAX_CHECKPOINT_PATH], path[MAX_CHECKPOINT_PATH], *base, *end;
+	DIR* stream;
+	struct dirent* entry;
+
+	split_checkpoint_prefix(self, directory, &base);
+	stream = opendir(directory);
+	if (stream == NULL){
+		return;
+	}
+	length = strlen(base);
+
+	//===Keep The Newest keep_last "<base>_<iteration>.ckpt" In Ascending Order===//
+	while ((entry = readdir(stream)) != NULL){
+		if (strncmp(entry->d_name, base, length) != 0 || entry->d_name[length] != '_' ||
+			entry->d_name[length+1] < '0' || entry->d_name[length+1] > '9'){
+			continue;
+		}
+		iteration = strtoull(entry->d_name + length + 1, &end, 10);
+		if (strcmp(end, ".ckpt") != 0){
+			continue;
+		}
+		if (self->num_kept == self->keep_last){
+			if (iteration < self->kept[0]){
+				make_checkpoint_path(self, iteration, "", path);
+				unlink(path);
+				continue;
+			}
+			make_checkpoint_path(self, self->kept[0], "", path);
+			unlink(path);
+			for (i=1; i<self->num_kept; i++){
+				self->kept[i-1] = self->kept[i];
+			}
+			self->num_kept--;
+		}
+		for (i=self->num_kept; i>0 && self->kept[i-1] > iteration; i--){
+			self->kept[i] = self->kept[i-1];
+		}
+		self->kept[i] = iteration;
+		self->num_kept++;
+	}
+	closedir(stream);
+
+	return;
+}
+
+//================================================================================================//
+//====================================Writer Functions============================================//
+//================================================================================================//
+
+static void* checkpoint_writer_thread( void* argument )
+{
+	int i, buffer, status;
+	checkpoint_writer_t* self;
+
+	self = (checkpoint_writer_t*)argument;
+	pthread_mutex_lock(&(self->lock));
+	while (1){
+
+		//===Pick The Oldest Staged Buffer===//
+		buffer = -1;
+		for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+			if (self->staging_full[i] == 1 &&
+				(buffer < 0 || self->staged_iteration[i] < self->staged_iteration[buffer])){
+				buffer = i;
+			}
+		}
+		if (buffer < 0){
+			if (self->shutdown){
+				break;
+			}
+			pthread_cond_wait(&(self->staged), &(self->lock));
+			continue;
+		}
+
+		//===Write Without Holding The Lock===//
+		self->writing = 1;
+		pthread_mutex_unlock(&(self->lock));
+		status = write_checkpoint_file(self, self->staging[buffer], self->staged_iteration[buffer]);
+		pthread_mutex_lock(&(self->lock));
+
+		if (status == 0){
+			rotate_checkpoints(self, self->staged_iteration[buffer]);
+			self->num_written++;
+		}
+		else{
+			self->num_failed++;
+		}
+		self->staging_full[buffer] = 0;
+		self->writing = 0;
+		pthread_cond_broadcast(&(self->drained));
+	}
+	pthread_mutex_unlock(&(self->lock));
+
+	return NULL;
+}
+
+checkpoint_writer_t* create_checkpoint_writer( neural_network_t* network,
+											   char* prefix,
+											   unsigned int keep_last )
+{
+	unsigned int i;
+	size_t bytes;
+	checkpoint_writer_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL || prefix == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- create_checkpoint_writer\n");
+		return NULL;
+	}
+	if (keep_last == 0 || keep_last > MAX_CHECKPOINTS_KEPT){
+		fprintf(stderr, "Error:: Input Parameter 'keep_last' Is Invalid! In Function -- create_checkpoint_writer\n");
+		return NULL;
+	}
+	if (strlen(prefix) >= sizeof(self->prefix)){
+		fprintf(stderr, "Error:: Input Parameter 'prefix' Is Too Long! In Function -- create_checkpoint_writer\n");
+		return NULL;
+	}
+
+	self = NULL;
+	self = malloc(sizeof(checkpoint_writer_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Checkpoint Writer Was Not Allocated! In Function -- create_checkpoint_writer\n");
+		return self;
+	}
+
+	//===Allocate Staging Buffers===//
+	bytes = round_up(network->arena_size * sizeof(double), WEIGHT_ALIGNMENT);
+	for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+		self->staging[i] = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+		self->staging_full[i] = 0;
+		self->staged_iteration[i] = 0;
+		if (self->staging[i] == NULL){
+			fprintf(stderr, "Error:: Staging Buffer Was Not Allocated! In Function -- create_checkpoint_writer\n");
+			while (i > 0){
+				free(self->staging[--i]);
+			}
+			free(self);
+			return NULL;
+		}
+	}
+
+	//===Set Local Data===//
+	self->network = network;
+	strcpy(self->prefix, prefix);
+	self->keep_last = keep_last;
+	self->num_kept = 0;
+	self->num_written = 0;
+	self->num_dropped = 0;
+	self->num_failed = 0;
+	self->writing = 0;
+	self->shutdown = 0;
+	seed_checkpoint_rotation(self);
+	pthread_mutex_init(&(self->lock), NULL);
+	pthread_cond_init(&(self->staged), NULL);
+	pthread_cond_init(&(self->drained), NULL);
+
+	//===Start Writer===//
+	if (pthread_create(&(self->thread), NULL, checkpoint_writer_thread, self) != 0){
+		fprintf(stderr, "Error:: Writer Thread Was Not Started! In Function -- create_checkpoint_writer\n");
+		for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+			free(self->staging[i]);
+		}
+		free(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+void destroy_checkpoint_writer( checkpoint_writer_t* self )
+{
+	unsigned int i;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Checkpoint Writer Is NULL! In Function -- destroy_checkpoint_writer\n");
+		return;
+	}
+
+	//===Drain And Stop===//
+	pthread_mutex_lock(&(self->lock));
+	self->shutdown = 1;
+	pthread_cond_signal(&(self->staged));
+	pthread_mutex_unlock(&(self->lock));
+	pthread_join(self->thread, NULL);
+
+	for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+		free(self->staging[i]);
+	}
+	pthread_mutex_destroy(&(self->lock));
+	pthread_cond_destroy(&(self->staged));
+	pthread_cond_destroy(&(self->drained));
+	free(self);
+
+	return;
+}
+
+int checkpoint_network( checkpoint_writer_t* self,
+						uint64_t iteration )
+{
+	int i, buffer;
+
+	//===Reserve A Free Buffer===//
+	buffer = -1;
+	pthread_mutex_lock(&(self->lock));
+	for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+		if (self->staging_full[i] == 0){
+			buffer = i;
+			self->staging_full[i] = -1;
+			break;
+		}
+	}
+	if (buffer < 0){
+		self->num_dropped++;
+	}
+	pthread_mutex_unlock(&(self->lock));
+	if (buffer < 0){
+		return 0;
+	}
+
+	//===Copy Weights Outside The Lock===//
+	memcpy(self->staging[buffer], self->network->weight_arena, self->network->arena_size * sizeof(double));
+
+	//===Hand Off===//
+	pthread_mutex_lock(&(self->lock));
+	self->staged_iteration[buffer] = iteration;
+	self->staging_full[buffer] = 1;
+	pthread_cond_signal(&(self->staged));
+	pthread_mutex_unlock(&(self->lock));
+
+	return 1;
+}
+
+void flush_checkpoints( checkpoint_writer_t* self )
+{
+	int i, pending;
+
+	pthread_mutex_lock(&(self->lock));
+	do{
+		pending = self->writing;
+		for (i=0; i<CHECKPOINT_STAGING_BUFFERS; i++){
+			pending |= (self->staging_full[i] != 0);
+		}
+		if (pending){
+			pthread_cond_wait(&(self->drained), &(self->lock));
+		}
+	} while (pending);
+	pthread_mutex_unlock(&(self->lock));
+
+	return;
+}
+
+int load_checkpoint( neural_network_t* network,
+					 char* path )
+{
+	unsigned int l;
+	FILE* fp;
+	double* weights;
+	neural_layer_t* layer;
+	checkpoint_header_t header, expected;
+
+	if (network == NULL || path == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- load_checkpoint\n");
+		return -1;
+	}
+
+	fp = NULL;
+	fp = fopen(path, "rb");
+	if (fp == NULL){
+		fprintf(stderr, "Error:: Could Not Open '%s'! In Function -- load_checkpoint\n", path);
+		return -1;
+	}
+	if (fread(&header, sizeof(checkpoint_header_t), 1, fp) != 1){
+		fprintf(stderr, "Error:: Could Not Read Header Of '%s'! In Function -- load_checkpoint\n", path);
+		fclose(fp);
+		return -1;
+	}
+
+	//===Topology And Layout Must Match Exactly===//
+	fill_checkpoint_header(network, header.iteration, &expected);
+	if (memcmp(&header, &expected, sizeof(checkpoint_header_t)) != 0){
+		fprintf(stderr, "Error:: Checkpoint '%s' Does Not Match Network! In Function -- load_checkpoint\n", path);
+		fclose(fp);
+		return -1;
+	}
+
+	//===Read Into A Scratch Arena So A Short File Leaves The Weights Intact===//
+	weights = malloc(network->arena_size * sizeof(double));
+	if (weights == NULL){
+		fprintf(stderr, "Error:: Weights Were Not Allocated! In Function -- load_checkpoint\n");
+		fclose(fp);
+		return -1;
+	}
+	if (fread(weights, sizeof(double), network->arena_size, fp) != network->arena_size){
+		fprintf(stderr, "Error:: Could Not Read Weights Of '%s'! In Function -- load_checkpoint\n", path);
+		free(weights);
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	memcpy(network->weight_arena, weights, network->arena_size * sizeof(double));
+	free(weights);
+
+	//===Pruned Weights Stay Pruned===//
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		layer = &(network->layer[l]);
+		if (layer->weight_mask != NULL){
+			matrix_mask(layer->weight_matrix, layer->num_nodes+1, layer->leading_dimension, layer->weight_mask);
+			if (layer->sparse_weights != NULL){
+				refresh_sparse_weights(layer);
+			}
+		}
+	}
+	mark_weights_changed(network);
+
+	return 0;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+void test_checkpoint_writer()
+{
+	unsigned int i, l;
+	double input[3], decision[1], expected;
+	unsigned int num_nodes[4];
+	char path[MAX_CHECKPOINT_PATH];
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *restored;
+	neural_layer_t* layer;
+	checkpoint_writer_t *writer, *reopened;
+
+	//===Create Networks===//
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	network = create_neural_network(parameters);
+	parameters->seed = 1;
+	restored = create_neural_network(parameters);
+
+	//===Train And Checkpoint===//
+	snprintf(path, MAX_CHECKPOINT_PATH, "/tmp/test_checkpoint_%d", (int)getpid());
+	writer = create_checkpoint_writer(network, path, 2);
+	input[0] = 0.1; input[1] = 0.2; input[2] = 0.3;
+	decision[0] = 1;
+	for (i=1; i<=100; i++){
+		iterate_network(network, input, decision);
+		if (i % 10 == 0){
+			checkpoint_network(writer, i);
+		}
+	}
+	flush_checkpoints(writer);
+	checkpoint_network(writer, 1000);
+	flush_checkpoints(writer);
+
+	//===Only The Newest Files Remain===//
+	if (writer->num_kept != 2 || writer->kept[1] != 1000){
+		fprintf(stderr, "Error: Function checkpoint_network Did Not Rotate Old Checkpoints!\n");
+	}
+	make_checkpoint_path(writer, 10, "", path);
+	if (access(path, F_OK) == 0){
+		fprintf(stderr, "Error: Function checkpoint_network Did Not Remove Old Checkpoints!\n");
+	}
+
+	//===Restore Final Weights===//
+	make_checkpoint_path(writer, 1000, "", path);
+	if (load_checkpoint(restored, path) != 0){
+		fprintf(stderr, "Error: Function load_checkpoint Has Failed!\n");
+	}
+	feed_forward(network, input);
+	expected = network->output[0];
+	feed_forward(restored, input);
+	if (restored->output[0] != expected){
+		fprintf(stderr, "Error: Restored Checkpoint Does Not Match!\n");
+	}
+
+	//===Loading Into A Pruned Network Keeps The Mask And CSR Copy===//
+	prune_network_to_sparsity(restored, 0.5);
+	select_weight_kernels(restored);
+	if (load_checkpoint(restored, path) != 0){
+		fprintf(stderr, "Error: Function load_checkpoint Has Failed!\n");
+	}
+	for (l=0; l<restored->num_hidden_layers+1; l++){
+		layer = &(restored->layer[l]);
+		for (i=0; i<(layer->num_nodes+1)*layer->leading_dimension; i++){
+			if (layer->weight_mask[i] == 0 && layer->weight_matrix[i] != 0){
+				fprintf(stderr, "Error: Function load_checkpoint Revived A Pruned Weight!\n");
+				l = restored->num_hidden_layers+1;
+				break;
+			}
+		}
+	}
+	for (l=0; l<restored->num_hidden_layers+1; l++){
+		restored->layer[l].use_sparse_weights = 0;
+	}
+	feed_forward(restored, input);
+	expected = restored->output[0];
+	for (l=0; l<restored->num_hidden_layers+1; l++){
+		restored->layer[l].use_sparse_weights = 1;
+	}
+	feed_forward(restored, input);
+	if (fabs(restored->output[0] - expected) > 1e-12){
+		fprintf(stderr, "Error: Function load_checkpoint Left A Stale CSR Copy!\n");
+	}
+
+	//===A Truncated Checkpoint Leaves The Weights Untouched===//
+	if (truncate(path, sizeof(checkpoint_header_t) + sizeof(double)) != 0
+		|| load_checkpoint(restored, path) == 0){
+		fprintf(stderr, "Error: Function load_checkpoint Accepted A Truncated Checkpoint!\n");
+	}
+	feed_forward(restored, input);
+	if (restored->output[0] != expected){
+		fprintf(stderr, "Error: Function load_checkpoint Overwrote Weights From A Truncated Checkpoint!\n");
+	}
+
+	//===A Writer Over The Same Prefix Rotates Files Left By Earlier Runs===//
+	snprintf(path, MAX_CHECKPOINT_PATH, "/tmp/test_checkpoint_%d", (int)getpid());
+	reopened = create_checkpoint_writer(network, path, 1);
+	make_checkpoint_path(writer, writer->kept[0], "", path);
+	if (reopened == NULL || reopened->num_kept != 1 || reopened->kept[0] != 1000 || access(path, F_OK) == 0){
+		fprintf(stderr, "Error: Function create_checkpoint_writer Did Not Rotate Earlier Checkpoints!\n");
+	}
+	if (reopened != NULL){
+		destroy_checkpoint_writer(reopened);
+	}
+
+	//===Clean Up Files===//
+	for (i=0; i<writer->num_kept; i++){
+		make_checkpoint_path(writer, writer->kept[i], "", path);
+		unlink(path);
+	}
+	destroy_checkpoint_writer(writer);
+
+	destroy_neural_network(network);
+	destroy_neural_network(restored);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,179 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <dirent.h>
+#include <fcntl.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define CHECKPOINT_MAGIC 0x4B43434E
+#define CHECKPOINT_FORMAT_VERSION 1
+#define CHECKPOINT_STAGING_BUFFERS 2
+#define MAX_CHECKPOINTS_KEPT 64
+#define MAX_CHECKPOINT_PATH 256
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct checkpoint_header_t
+*   @brief This structure comprises the header written at the start of every checkpoint file.
+*
+*	The weight arena follows the header verbatim, in the network's own storage layout.
+*/
+//================================================================================================//
+typedef struct checkpoint_header_s checkpoint_header_t;
+typedef struct checkpoint_header_s{
+	uint32_t magic;
+	uint32_t format_version;
+	uint64_t iteration;
+	uint64_t arena_size;
+	uint32_t num_hidden_layers;
+	uint32_t weight_storage;
+	uint32_t num_nodes[MAX_LAYERS];
+} checkpoint_header_t;
+
+
+//================================================================================================//
+/** @struct checkpoint_writer_t
+*   @brief This structure comprises a background checkpoint writer.
+*
+*	The training thread copies the weight arena into a free staging buffer and returns at once;
+*	a writer thread saves staged buffers to disk. If every staging buffer is still being written
+*	the checkpoint is dropped and counted rather than stalling training.
+*/
+//================================================================================================//
+typedef struct checkpoint_writer_s checkpoint_writer_t;
+typedef struct checkpoint_writer_s{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t staged;
+	pthread_cond_t drained;
+	neural_network_t* network;
+	double* staging[CHECKPOINT_STAGING_BUFFERS];
+	uint64_t staged_iteration[CHECKPOINT_STAGING_BUFFERS];
+	int staging_full[CHECKPOINT_STAGING_BUFFERS];
+	uint64_t kept[MAX_CHECKPOINTS_KEPT];
+	char prefix[MAX_CHECKPOINT_PATH-32];
+	unsigned int keep_last;
+	unsigned int num_kept;
+	unsigned int num_written;
+	unsigned int num_dropped;
+	unsigned int num_failed;
+	int writing;
+	int shutdown;
+} checkpoint_writer_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a checkpoint_writer_t object and starts its writer thread.
+*
+* Checkpoints are written to "<prefix>_<iteration>.ckpt" and only the newest keep_last files
+* are kept. Files with the same prefix left by earlier runs are picked up and rotated too.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] char* prefix
+* @param[in] unsigned int keep_last
+*
+* @return checkpoint_writer_t* self
+*/
+//================================================================================================//
+checkpoint_writer_t* create_checkpoint_writer( neural_network_t* network,
+											   char* prefix,
+											   unsigned int keep_last );
+
+
+//================================================================================================//
+/**
+* @brief This function writes all staged checkpoints, stops the writer thread and frees it.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] checkpoint_writer_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_checkpoint_writer( checkpoint_writer_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function stages a checkpoint of the network's current weights.
+*
+* The only work done on the calling thread is one memcpy of the weight arena.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] checkpoint_writer_t* self
+* @param[in] uint64_t iteration
+*
+* @return int staged (1 if staged, 0 if dropped because the writer is behind)
+*/
+//================================================================================================//
+int checkpoint_network( checkpoint_writer_t* self,
+						uint64_t iteration );
+
+
+//================================================================================================//
+/**
+* @brief This function blocks until every staged checkpoint has been written.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] checkpoint_writer_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void flush_checkpoints( checkpoint_writer_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function loads a checkpoint file into a network with the same topology.
+*
+* The weights are only replaced once the whole arena has been read, so a truncated file
+* leaves the network as it was. Pruned layers keep their masks and CSR copies in step.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* network
+* @param[in] char* path
+*
+* @return int status (0 on success)
+*/
+//================================================================================================//
+int load_checkpoint( neural_network_t* network,
+					 char* path );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the checkpoint_writer_t object.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_checkpoint_writer();
+
+
+
+#endif //CHECKPOINT_H//
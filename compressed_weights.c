@@ -0,0 +1,549 @@
+#include "compressed_weights.h"
+#include "helper.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HALF_SIMD_SUPPORTED 1
+#else
+#define HALF_SIMD_SUPPORTED 0
+#endif
+
+//================================================================================================//
+//=====================================Conversion Functions=======================================//
+//================================================================================================//
+
+static inline float bits_to_float( uint32_t bits )
+{
+	float value;
+	memcpy(&value, &bits, sizeof(float));
+	return value;
+}
+
+static inline float bf16_to_float( uint16_t half )
+{
+	return bits_to_float((uint32_t)half << 16);
+}
+
+static inline float fp16_to_float( uint16_t half )
+{
+	uint32_t sign, exponent, mantissa;
+	float value;
+
+	sign = (uint32_t)(half & 0x8000) << 16;
+	exponent = (half >> 10) & 0x1F;
+	mantissa = half & 0x3FF;
+	if (exponent == 0x1F){
+		return bits_to_float(sign | 0x7F800000 | (mantissa << 13));
+	}
+	if (exponent == 0){
+
+		//===Subnormal: mantissa Units Of 2^-24===//
+		value = mantissa * (1.0f/16777216.0f);
+		return (sign) ? -value : value;
+	}
+	return bits_to_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t float_to_half( float value,
+						half_format_t format )
+{
+	uint32_t bits, sign, magnitude, mantissa, remainder, halfway, shift, result;
+
+	memcpy(&bits, &value, sizeof(uint32_t));
+
+	//===bf16 Is The Top Half, Rounded To Nearest Even; NaN Stays Quiet NaN===//
+	if (format == HALF_FORMAT_BF16){
+		if ((bits & 0x7FFFFFFF) > 0x7F800000){
+			return (uint16_t)((bits >> 16) | 0x40);
+		}
+		return (uint16_t)((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+	}
+
+	sign = (bits >> 16) & 0x8000;
+	magnitude = bits & 0x7FFFFFFF;
+	if (magnitude >= 0x7F800000){
+		return (uint16_t)(sign | 0x7C00 | ((magnitude > 0x7F800000) ? 0x200 : 0));
+	}
+
+	//===65520 And Up Round Past 65504===//
+	if (magnitude >= 0x477FF000){
+		return (uint16_t)(sign | 0x7C00);
+	}
+
+	//===Below 2^-14 The Result Is Subnormal; 2^-25 And Below Round To Zero===//
+	if (magnitude < 0x38800000){
+		if (magnitude <= 0x33000000){
+			return (uint16_t)sign;
+		}
+		mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		shift = 126 - (magnitude >> 23);
+		result = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (result & 1))){
+			result++;
+		}
+		return (uint16_t)(sign | result);
+	}
+
+	//===Normal: Rebias The Exponent And Round Off 13 Mantissa Bits===//
+	magnitude -= 112u << 23;
+	return (uint16_t)(sign | ((magnitude + 0xFFF + ((magnitude >> 13) & 1)) >> 13));
+}
+
+float half_to_float( uint16_t half,
+					 half_format_t format )
+{
+	return (format == HALF_FORMAT_BF16) ? bf16_to_float(half) : fp16_to_float(half);
+}
+
+//================================================================================================//
+//=====================================Portable Kernels===========================================//
+//================================================================================================//
+
+static void portable_bf16_kernel( int rows,
+								  int columns,
+								  float* x,
+								  uint16_t* a,
+								  int lda,
+								  float* y )
+{
+	int j, k;
+	float scale;
+	uint16_t* row;
+
+	for (j=0; j<columns; j++){
+		y[j] = 0;
+	}
+	for (k=0; k<rows; k++){
+		scale = x[k];
+		row = a + (size_t)k*lda;
+		for (j=0; j<columns; j++){
+			y[j] += scale * bf16_to_float(row[j]);
+		}
+	}
+
+	return;
+}
+
+static void portable_fp16_kernel( int rows,
+								  int columns,
+								  float* x,
+								  uint16_t* a,
+								  int lda,
+								  float* y )
+{
+	int j, k;
+	float scale;
+	uint16_t* row;
+
+	for (j=0; j<columns; j++){
+		y[j] = 0;
+	}
+	for (k=0; k<rows; k++){
+		scale = x[k];
+		row = a + (size_t)k*lda;
+		for (j=0; j<columns; j++){
+			y[j] += scale * fp16_to_float(row[j]);
+		}
+	}
+
+	return;
+}
+
+//================================================================================================//
+//=======================================SIMD Kernels=============================================//
+//================================================================================================//
+
+#if HALF_SIMD_SUPPORTED
+
+//===Compiled For AVX2, FMA And F16C But Only Called When The CPU Has Them===//
+#define HALF_SIMD_TARGET __attribute__((target("avx2,fma,f16c")))
+
+HALF_SIMD_TARGET static inline __m256 widen_halves( uint16_t* half,
+													half_format_t format )
+{
+	__m128i packed;
+
+	packed = _mm_loadu_si128((__m128i*)half);
+	if (format == HALF_FORMAT_BF16){
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(packed), 16));
+	}
+	return _mm256_cvtph_ps(packed);
+}
+
+//===Column Blocks Stay In Registers While Every Row Streams Past===//
+HALF_SIMD_TARGET static inline __attribute__((always_inline)) void simd_half_kernel( int rows,
+																					int columns,
+																					float* x,
+																					uint16_t* a,
+																					int lda,
+																					float* y,
+																					half_format_t format )
+{
+	int j, k;
+	float sum;
+	uint16_t* row;
+	__m256 scale, block0, block1, block2, block3;
+
+	for (j=0; j+32<=columns; j+=32){
+		block0 = _mm256_setzero_ps();
+		block1 = _mm256_setzero_ps();
+		block2 = _mm256_setzero_ps();
+		block3 = _mm256_setzero_ps();
+		for (k=0; k<rows; k++){
+			scale = _mm256_set1_ps(x[k]);
+			row = a + (size_t)k*lda + j;
+			block0 = _mm256_fmadd_ps(scale, widen_halves(row, format), block0);
+			block1 = _mm256_fmadd_ps(scale, widen_halves(row+8, format), block1);
+			block2 = _mm256_fmadd_ps(scale, widen_halves(row+16, format), block2);
+			block3 = _mm256_fmadd_ps(scale, widen_halves(row+24, format), block3);
+		}
+		_mm256_storeu_ps(y+j, block0);
+		_mm256_storeu_ps(y+j+8, block1);
+		_mm256_storeu_ps(y+j+16, block2);
+		_mm256_storeu_ps(y+j+24, block3);
+	}
+	for (; j+8<=columns; j+=8){
+		block0 = _mm256_setzero_ps();
+		for (k=0; k<rows; k++){
+			block0 = _mm256_fmadd_ps(_mm256_set1_ps(x[k]), widen_halves(a + (size_t)k*lda + j, format), block0);
+		}
+		_mm256_storeu_ps(y+j, block0);
+	}
+	for (; j<columns; j++){
+		sum = 0;
+		for (k=0; k<rows; k++){
+			sum += x[k] * half_to_float(a[(size_t)k*lda + j], format);
+		}
+		y[j] = sum;
+	}
+
+	return;
+}
+
+HALF_SIMD_TARGET static void simd_bf16_kernel( int rows,
+											   int columns,
+											   float* x,
+											   uint16_t* a,
+											   int lda,
+											   float* y )
+{
+	simd_half_kernel(rows, columns, x, a, lda, y, HALF_FORMAT_BF16);
+	return;
+}
+
+HALF_SIMD_TARGET static void simd_fp16_kernel( int rows,
+											   int columns,
+											   float* x,
+											   uint16_t* a,
+											   int lda,
+											   float* y )
+{
+	simd_half_kernel(rows, columns, x, a, lda, y, HALF_FORMAT_FP16);
+	return;
+}
+
+#endif
+
+static half_kernel_t select_half_kernel( half_format_t format )
+{
+	#if HALF_SIMD_SUPPORTED
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")){
+			return (format == HALF_FORMAT_BF16) ? simd_bf16_kernel : simd_fp16_kernel;
+		}
+	#endif
+	return (format == HALF_FORMAT_BF16) ? portable_bf16_kernel : portable_fp16_kernel;
+}
+
+//================================================================================================//
+//=====================================Network Functions==========================================//
+//================================================================================================//
+
+compressed_network_t* create_compressed_network( neural_network_t* network,
+												 half_format_t format )
+{
+	size_t bytes;
+	compressed_network_t* self;
+
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- create_compressed_network\n");
+		return NULL;
+	}
+	if (format >= NUM_HALF_FORMATS){
+		fprintf(stderr, "Error:: Input Parameter 'format' Is Invalid! In Function -- create_compressed_network\n");
+		return NULL;
+	}
+
+	self = malloc(sizeof(compressed_network_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Compressed Network Was Not Allocated! In Function -- create_compressed_network\n");
+		return NULL;
+	}
+	bytes = round_up(network->arena_size * sizeof(uint16_t), WEIGHT_ALIGNMENT);
+	self->weight_arena = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	if (self->weight_arena == NULL){
+		fprintf(stderr, "Error:: Compressed Arena Was Not Allocated! In Function -- create_compressed_network\n");
+		free(self);
+		return NULL;
+	}
+	self->network = network;
+	self->format = format;
+	self->kernel = select_half_kernel(format);
+	compress_weights(self);
+
+	return self;
+}
+
+void destroy_compressed_network( compressed_network_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Compressed Network Is NULL! In Function -- destroy_compressed_network\n");
+		return;
+	}
+	free(self->weight_arena);
+	free(self);
+	return;
+}
+
+void compress_weights( compressed_network_t* self )
+{
+	size_t i;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Compressed Network Is NULL! In Function -- compress_weights\n");
+		return;
+	}
+	for (i=0; i<self->network->arena_size; i++){
+		self->weight_arena[i] = float_to_half((float)self->network->weight_arena[i], self->format);
+	}
+	self->weight_version = get_weight_version(self->network);
+
+	return;
+}
+
+int feed_forward_compressed( compressed_network_t* self,
+							 neural_context_t* context,
+							 double* input )
+{
+	unsigned int l, i, output_layer, num_columns;
+	float activation[MAX_LAYER_NODES+1], product[MAX_LAYER_NODES];
+	neural_layer_t* layer;
+	layer_state_t* state;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL || input == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- feed_forward_compressed\n");
+		return -1;
+	}
+	network = self->network;
+
+	//===Weights Changed Since compress_weights: The Copy Is Stale===//
+	if (self->weight_version != get_weight_version(network)){
+		fprintf(stderr, "Error:: Compressed Weights Are Stale! In Function -- feed_forward_compressed\n");
+		return -1;
+	}
+	output_layer = network->num_hidden_layers+1;
+	memcpy(context->input, input, network->layer[0].num_nodes * sizeof(double));
+
+	for (l=0; l<=output_layer; l++){
+		layer = &(network->layer[l]);
+		state = &(context->layer[l]);
+		layer->backend->activate[layer->activation](state->input, state->activation, state->derivative, layer->num_nodes);
+		state->activation[layer->num_nodes] = 1;
+		if (l == output_layer){
+			break;
+		}
+
+		//===Float Product Against The 16-Bit Matrix===//
+		num_columns = layer->next_layer->num_nodes;
+		for (i=0; i<=layer->num_nodes; i++){
+			activation[i] = (float)state->activation[i];
+		}
+		self->kernel(layer->num_nodes+1, num_columns, activation,
+					 self->weight_arena + (layer->weight_matrix - network->weight_arena),
+					 layer->leading_dimension, product);
+		for (i=0; i<num_columns; i++){
+			context->layer[l+1].input[i] = product[i];
+		}
+	}
+
+	return 0;
+}
+
+int measure_compression_error( neural_network_t* network,
+							   half_format_t format,
+							   double* inputs,
+							   unsigned int num_samples,
+							   compression_report_t* report )
+{
+	unsigned int s, i, num_inputs, num_outputs, num_agree;
+	size_t w;
+	double error, total;
+	neural_context_t *exact, *approximate;
+	compressed_network_t* compressed;
+
+	if (network == NULL || inputs == NULL || report == NULL || num_samples == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- measure_compression_error\n");
+		return -1;
+	}
+	compressed = create_compressed_network(network, format);
+	exact = create_neural_context(network);
+	approximate = create_neural_context(network);
+	if (compressed == NULL || exact == NULL || approximate == NULL){
+		fprintf(stderr, "Error:: Buffers Were Not Allocated! In Function -- measure_compression_error\n");
+		if (compressed != NULL) destroy_compressed_network(compressed);
+		if (exact != NULL) destroy_neural_context(exact);
+		if (approximate != NULL) destroy_neural_context(approximate);
+		return -1;
+	}
+
+	memset(report, 0, sizeof(compression_report_t));
+	report->format = format;
+	report->num_samples = num_samples;
+	report->original_bytes = network->arena_size * sizeof(double);
+	report->compressed_bytes = network->arena_size * sizeof(uint16_t);
+	for (w=0; w<network->arena_size; w++){
+		error = fabs(network->weight_arena[w] - half_to_float(compressed->weight_arena[w], format));
+		report->max_weight_error = MAX(report->max_weight_error, error);
+	}
+
+	//===Same Inputs Through Both===//
+	num_inputs = network->layer[0].num_nodes;
+	num_outputs = network->layer[network->num_hidden_layers+1].num_nodes;
+	total = 0;
+	num_agree = 0;
+	for (s=0; s<num_samples; s++){
+		feed_forward_context(network, exact, inputs + (size_t)s*num_inputs);
+		feed_forward_compressed(compressed, approximate, inputs + (size_t)s*num_inputs);
+		for (i=0; i<num_outputs; i++){
+			error = fabs(exact->output[i] - approximate->output[i]);
+			report->max_output_error = MAX(report->max_output_error, error);
+			total += error;
+		}
+		num_agree += (vector_argmax(exact->output, num_outputs) == vector_argmax(approximate->output, num_outputs));
+	}
+	report->mean_output_error = total / ((double)num_samples * num_outputs);
+	report->agreement = (double)num_agree / num_samples;
+
+	destroy_compressed_network(compressed);
+	destroy_neural_context(exact);
+	destroy_neural_context(approximate);
+
+	return 0;
+}
+
+void print_compression_report( compression_report_t* report )
+{
+	if (report == NULL){
+		fprintf(stderr, "Error:: Report Is NULL! In Function -- print_compression_report\n");
+		return;
+	}
+
+	fprintf(stdout, "Compression: %s, %lu Of %lu Bytes, Max Weight Error %g\n",
+			(report->format == HALF_FORMAT_BF16) ? "bf16" : "fp16",
+			report->compressed_bytes, report->original_bytes, report->max_weight_error);
+	fprintf(stdout, "Outputs Over %u Samples: Max Error %g, Mean Error %g, Top Output Agreement %.1lf%%\n",
+			report->num_samples, report->max_output_error, report->mean_output_error, 100.0*report->agreement);
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_compressed_weights()
+{
+	unsigned int i, j, f, h, num_nodes[4];
+	float x[13], expected[37], result[37];
+	double inputs[20*24], decision[4];
+	uint16_t matrix[13*40];
+	half_kernel_t portable;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	neural_context_t* context;
+	compressed_network_t* compressed;
+	compression_report_t report;
+
+	//===Rounding At The Edges Of fp16 And bf16===//
+	if (float_to_half(1.0f, HALF_FORMAT_FP16) != 0x3C00 || float_to_half(65504.0f, HALF_FORMAT_FP16) != 0x7BFF ||
+		float_to_half(65519.0f, HALF_FORMAT_FP16) != 0x7BFF || float_to_half(65520.0f, HALF_FORMAT_FP16) != 0x7C00 ||
+		float_to_half(ldexpf(1, -24), HALF_FORMAT_FP16) != 0x0001 || float_to_half(ldexpf(3, -25), HALF_FORMAT_FP16) != 0x0002 ||
+		float_to_half(ldexpf(1, -25), HALF_FORMAT_FP16) != 0x0000 || float_to_half(-2.0f, HALF_FORMAT_FP16) != 0xC000 ||
+		float_to_half(1.0f, HALF_FORMAT_BF16) != 0x3F80 || float_to_half(1.0f + ldexpf(1, -8), HALF_FORMAT_BF16) != 0x3F80 ||
+		float_to_half(1.0f + ldexpf(3, -8), HALF_FORMAT_BF16) != 0x3F82){
+		fprintf(stderr, "Error: Function float_to_half Has Failed!\n");
+	}
+
+	//===Every Finite Value Survives A Round Trip===//
+	for (f=0; f<NUM_HALF_FORMATS; f++){
+		for (h=0; h<65536; h++){
+			if ((f == HALF_FORMAT_FP16 && (h & 0x7C00) == 0x7C00) || (f == HALF_FORMAT_BF16 && (h & 0x7F80) == 0x7F80)){
+				continue;
+			}
+			if (float_to_half(half_to_float(h, f), f) != h){
+				fprintf(stderr, "Error: Function half_to_float Does Not Round Trip 0x%04X!\n", h);
+				break;
+			}
+		}
+	}
+
+	//===Selected Kernels Match The Portable Ones, Including Column Remainders===//
+	for (i=0; i<13; i++){
+		x[i] = sinf(0.7f*i);
+	}
+	for (f=0; f<NUM_HALF_FORMATS; f++){
+		for (i=0; i<13*40; i++){
+			matrix[i] = float_to_half(cosf(0.3f*i), f);
+		}
+		portable = (f == HALF_FORMAT_BF16) ? portable_bf16_kernel : portable_fp16_kernel;
+		portable(13, 37, x, matrix, 40, expected);
+		select_half_kernel(f)(13, 37, x, matrix, 40, result);
+		for (j=0; j<37; j++){
+			if (fabsf(expected[j] - result[j]) > 1e-4f){
+				fprintf(stderr, "Error: Half Kernel %u Does Not Match The Portable Kernel!\n", f);
+				break;
+			}
+		}
+	}
+
+	//===Compressed Outputs Stay Close To Double===//
+	num_nodes[0] = 24; num_nodes[1] = 40; num_nodes[2] = 17; num_nodes[3] = 4;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.1);
+	parameters->activation[1] = ACTIVATION_RELU;
+	parameters->activation[3] = ACTIVATION_SOFTMAX;
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	network = create_neural_network(parameters);
+	for (i=0; i<20*24; i++){
+		inputs[i] = sin(0.11*i*i);
+	}
+	for (f=0; f<NUM_HALF_FORMATS; f++){
+		if (measure_compression_error(network, f, inputs, 20, &report) != 0 || report.compressed_bytes*4 != report.original_bytes){
+			fprintf(stderr, "Error: Function measure_compression_error Has Failed!\n");
+			continue;
+		}
+		if (report.max_output_error > ((f == HALF_FORMAT_BF16) ? 5e-3 : 1e-3)){
+			fprintf(stderr, "Error: Function feed_forward_compressed Is Off By %g!\n", report.max_output_error);
+		}
+	}
+
+	//===Training Makes The Copy Stale Until compress_weights===//
+	compressed = create_compressed_network(network, HALF_FORMAT_BF16);
+	context = create_neural_context(network);
+	decision[0] = 1; decision[1] = 0; decision[2] = 0; decision[3] = 0;
+	iterate_network(network, inputs, decision);
+	if (feed_forward_compressed(compressed, context, inputs) == 0){
+		fprintf(stderr, "Error: Function feed_forward_compressed Used Stale Weights!\n");
+	}
+	compress_weights(compressed);
+	if (feed_forward_compressed(compressed, context, inputs) != 0){
+		fprintf(stderr, "Error: Function compress_weights Did Not Refresh The Copy!\n");
+	}
+	destroy_neural_context(context);
+	destroy_compressed_network(compressed);
+
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
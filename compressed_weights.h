@@ -0,0 +1,230 @@
+#ifndef COMPRESSED_WEIGHTS_H
+#define COMPRESSED_WEIGHTS_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @enum half_format_t
+*   @brief This enumeration selects the 16-bit format compressed weights are stored in.
+*
+*	HALF_FORMAT_BF16 keeps float's exponent range with an 8-bit significand; HALF_FORMAT_FP16 is
+*	IEEE binary16, with an 11-bit significand but a largest value of 65504.
+*/
+//================================================================================================//
+typedef enum half_format_e{
+	HALF_FORMAT_BF16,
+	HALF_FORMAT_FP16,
+	NUM_HALF_FORMATS
+} half_format_t;
+
+//===y = x * A For A Row Major 16-Bit A: rows, columns, x, a, lda, y===//
+typedef void (*half_kernel_t)(int, int, float*, uint16_t*, int, float*);
+
+
+//================================================================================================//
+/** @struct compressed_network_t
+*   @brief This structure comprises a 16-bit copy of a network's weights for inference.
+*
+*	weight_arena has the network's arena layout, so a layer's matrix sits at the same offset as
+*	its double one. The kernel widens weights to float in registers (with F16C and AVX2 when the
+*	CPU has them) and accumulates in float; activations run in double on the context. The copy
+*	is taken at creation and by compress_weights; weight_version records which weights it holds.
+*/
+//================================================================================================//
+typedef struct compressed_network_s compressed_network_t;
+typedef struct compressed_network_s{
+	neural_network_t* network;
+	uint16_t* weight_arena;
+	half_kernel_t kernel;
+	half_format_t format;
+	uint64_t weight_version;
+} compressed_network_t;
+
+
+//================================================================================================//
+/** @struct compression_report_t
+*   @brief This structure comprises the accuracy of compressed inference against double.
+*
+*	Output errors are absolute differences between the two networks' outputs; agreement is the
+*	fraction of samples whose largest output is the same unit.
+*/
+//================================================================================================//
+typedef struct compression_report_s compression_report_t;
+typedef struct compression_report_s{
+	half_format_t format;
+	unsigned int num_samples;
+	double max_weight_error;
+	double max_output_error;
+	double mean_output_error;
+	double agreement;
+	size_t compressed_bytes;
+	size_t original_bytes;
+} compression_report_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function converts a float to the nearest bf16 or fp16 value, ties to even.
+*
+* fp16 values beyond 65504 become infinity; NaN stays NaN.
+*
+* If errors occur, the function exits.
+*
+* @param[in] float value
+* @param[in] half_format_t format
+*
+* @return uint16_t half
+*/
+//================================================================================================//
+uint16_t float_to_half( float value,
+						half_format_t format );
+
+
+//================================================================================================//
+/**
+* @brief This function widens a bf16 or fp16 value to float exactly.
+*
+* If errors occur, the function exits.
+*
+* @param[in] uint16_t half
+* @param[in] half_format_t format
+*
+* @return float value
+*/
+//================================================================================================//
+float half_to_float( uint16_t half,
+					 half_format_t format );
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a compressed_network_t object holding a 16-bit weight copy.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] half_format_t format
+*
+* @return compressed_network_t* self
+*/
+//================================================================================================//
+compressed_network_t* create_compressed_network( neural_network_t* network,
+												 half_format_t format );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a compressed_network_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] compressed_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_compressed_network( compressed_network_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function compresses the network's current weights again, after training.
+*
+* Must not run while another thread feeds through the same object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] compressed_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void compress_weights( compressed_network_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds an input through the compressed weights using a context.
+*
+* Threads may share one compressed network, each with its own context. The result is left in
+* context->output. Once the network's weights change the copy is refused until compress_weights
+* runs again.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compressed_network_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* input
+*
+* @return int status (0 on success, -1 on error or stale weights)
+*/
+//================================================================================================//
+int feed_forward_compressed( compressed_network_t* self,
+							 neural_context_t* context,
+							 double* input );
+
+
+//================================================================================================//
+/**
+* @brief This function measures how much a 16-bit format changes a network's outputs.
+*
+* Each of num_samples input rows is fed through the network in double and through a
+* compressed copy, and the differences are summarized.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] half_format_t format
+* @param[in] double* inputs
+* @param[in] unsigned int num_samples
+* @param[out] compression_report_t* report
+*
+* @return int status (0 on success, -1 on error)
+*/
+//================================================================================================//
+int measure_compression_error( neural_network_t* network,
+							   half_format_t format,
+							   double* inputs,
+							   unsigned int num_samples,
+							   compression_report_t* report );
+
+
+//================================================================================================//
+/**
+* @brief This function prints a compression_report_t.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compression_report_t* report
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_compression_report( compression_report_t* report );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the conversions, the kernels and compressed inference.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_compressed_weights();
+
+
+
+#endif //COMPRESSED_WEIGHTS_H//
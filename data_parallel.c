@@ -0,0 +1,426 @@
+#include "data_parallel.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//====================================Segment Functions===========================================//
+//================================================================================================//
+
+static data_parallel_segment_t* create_data_parallel_segment( neural_network_t* network,
+															  unsigned int num_workers,
+															  size_t* bytes )
+{
+	int fd;
+	char name[64];
+	size_t header_size, slot_size;
+	data_parallel_segment_t* self;
+	pthread_barrierattr_t attributes;
+
+	header_size = round_up(sizeof(data_parallel_segment_t), WEIGHT_ALIGNMENT);
+	slot_size = round_up(network->arena_size, SIMD_WIDTH);
+	*bytes = header_size + (num_workers+1) * slot_size * sizeof(double);
+
+	//===Name Is Unlinked At Once; The Mapping Is Inherited By fork===//
+	snprintf(name, sizeof(name), "/neurons_data_parallel_%d", (int)getpid());
+	fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0){
+		fprintf(stderr, "Error:: Could Not Open Shared Memory '%s'! In Function -- create_data_parallel_segment\n", name);
+		return NULL;
+	}
+	shm_unlink(name);
+	if (ftruncate(fd, *bytes) != 0){
+		fprintf(stderr, "Error:: Could Not Size Shared Memory! In Function -- create_data_parallel_segment\n");
+		close(fd);
+		return NULL;
+	}
+	self = mmap(NULL, *bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (self == MAP_FAILED){
+		fprintf(stderr, "Error:: Could Not Map Shared Memory! In Function -- create_data_parallel_segment\n");
+		return NULL;
+	}
+
+	//===Set Local Data===//
+	self->num_workers = num_workers;
+	self->slot_size = slot_size;
+	self->chunk_size = round_up((slot_size + num_workers - 1)/num_workers, SIMD_WIDTH);
+	self->slot = (double*)((char*)self + header_size);
+	self->reduced = self->slot + num_workers*slot_size;
+	memset(self->loss, 0, sizeof(self->loss));
+
+	//===Barrier Shared Between Processes===//
+	pthread_barrierattr_init(&attributes);
+	pthread_barrierattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	if (pthread_barrier_init(&(self->barrier), &attributes, num_workers) != 0){
+		fprintf(stderr, "Error:: Could Not Create Barrier! In Function -- create_data_parallel_segment\n");
+		pthread_barrierattr_destroy(&attributes);
+		munmap(self, *bytes);
+		return NULL;
+	}
+	pthread_barrierattr_destroy(&attributes);
+
+	return self;
+}
+
+static void destroy_data_parallel_segment( data_parallel_segment_t* self,
+										   size_t bytes,
+										   int workers_finished )
+{
+	//===Killed Workers Still Count As Waiting, And Destroying Would Wait For Them===//
+	if (workers_finished){
+		pthread_barrier_destroy(&(self->barrier));
+	}
+	munmap(self, bytes);
+	return;
+}
+
+//================================================================================================//
+//=====================================Worker Functions===========================================//
+//================================================================================================//
+
+static void all_reduce_gradients( data_parallel_segment_t* self,
+								  unsigned int worker )
+{
+	size_t i, start, end;
+	unsigned int w;
+	double* slot;
+
+	//===Reduce-Scatter: Each Worker Sums Its Own Chunk Across All Slots===//
+	pthread_barrier_wait(&(self->barrier));
+	start = MIN(worker * self->chunk_size, self->slot_size);
+	end = MIN(start + self->chunk_size, self->slot_size);
+	for (i=start; i<end; i++){
+		self->reduced[i] = self->slot[i];
+	}
+	for (w=1; w<self->num_workers; w++){
+		slot = self->slot + w*self->slot_size;
+		for (i=start; i<end; i++){
+			self->reduced[i] += slot[i];
+		}
+	}
+
+	//===All-Gather: Every Worker Then Reads The Whole Reduced Gradient===//
+	pthread_barrier_wait(&(self->barrier));
+
+	return;
+}
+
+static void run_data_parallel_worker( neural_network_t* network,
+									  data_parallel_segment_t* segment,
+									  unsigned int worker,
+									  double* inputs,
+									  double* labels,
+									  unsigned int shard_size,
+									  unsigned int batch_size,
+									  unsigned int num_steps,
+									  unsigned int num_epochs )
+{
+	unsigned int e, s, b, index, num_inputs, num_outputs;
+	double *slot, update_weight;
+	compute_backend_t* backend;
+
+	num_inputs = network->layer[0].num_nodes;
+	num_outputs = network->layer[network->num_hidden_layers+1].num_nodes;
+	slot = segment->slot + worker*segment->slot_size;
+	backend = network->backend;
+	update_weight = -network->learning_rate / (segment->num_workers * batch_size);
+
+	for (e=0; e<num_epochs; e++){
+		segment->loss[worker] = 0;
+		for (s=0; s<num_steps; s++){
+
+			//===Sum Local Gradients Into This Worker's Slot===//
+			memset(slot, 0, network->arena_size * sizeof(double));
+			for (b=0; b<batch_size; b++){
+				index = worker*shard_size + s*batch_size + b;
+				feed_forward(network, inputs + (size_t)index*num_inputs);
+				back_propagate(network, labels + (size_t)index*num_outputs);
+				compute_weight_gradients(network);
+				backend->axpy(network->arena_size, 1.0, network->update_arena, slot);
+				segment->loss[worker] += network->loss;
+			}
+
+			all_reduce_gradients(segment, worker);
+			apply_weight_gradients(network, segment->reduced, update_weight);
+		}
+	}
+
+	//===Every Copy Is Identical; Worker 0 Hands Its Weights Back===//
+	pthread_barrier_wait(&(segment->barrier));
+	if (worker == 0){
+		memcpy(segment->reduced, network->weight_arena, network->arena_size * sizeof(double));
+	}
+
+	return;
+}
+
+//================================================================================================//
+//=====================================Training Functions=========================================//
+//================================================================================================//
+
+static void stop_data_parallel_workers( pid_t* workers,
+										unsigned int num_workers )
+{
+	unsigned int w;
+
+	for (w=0; w<num_workers; w++){
+		if (workers[w] > 0){
+			kill(workers[w], SIGKILL);
+			waitpid(workers[w], NULL, 0);
+			workers[w] = 0;
+		}
+	}
+
+	return;
+}
+
+static int wait_data_parallel_workers( pid_t* workers,
+									   unsigned int num_workers )
+{
+	int status;
+	unsigned int w, num_running;
+	pid_t pid;
+	struct timespec interval;
+
+	//===Poll, So One Dead Worker Cannot Leave The Rest Waiting At The Barrier===//
+	interval.tv_sec = 0;
+	interval.tv_nsec = DATA_PARALLEL_POLL_NANOSECONDS;
+	num_running = num_workers;
+	while (num_running > 0){
+		for (w=0; w<num_workers; w++){
+			if (workers[w] <= 0 || (pid = waitpid(workers[w], &status, WNOHANG)) == 0){
+				continue;
+			}
+			workers[w] = 0;
+			num_running--;
+			if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+				fprintf(stderr, "Error:: Worker %u Has Failed! In Function -- train_data_parallel\n", w);
+				stop_data_parallel_workers(workers, num_workers);
+				return -1;
+			}
+		}
+		if (num_running > 0){
+			nanosleep(&interval, NULL);
+		}
+	}
+
+	return 0;
+}
+
+int train_data_parallel( neural_network_t* self,
+						 double* inputs,
+						 double* labels,
+						 unsigned int num_samples,
+						 unsigned int num_workers,
+						 unsigned int batch_size,
+						 unsigned int num_epochs,
+						 data_parallel_report_t* report )
+{
+	int result;
+	unsigned int w, l, shard_size, num_steps;
+	size_t bytes;
+	double loss;
+	pid_t workers[MAX_DATA_PARALLEL_WORKERS];
+	struct timespec start, stop;
+	data_parallel_segment_t* segment;
+
+	//===Check Parameters===//
+	if (self == NULL || inputs == NULL || labels == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- train_data_parallel\n");
+		return -1;
+	}
+	if (num_workers == 0 || num_workers > MAX_DATA_PARALLEL_WORKERS || batch_size == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- train_data_parallel\n");
+		return -1;
+	}
+	shard_size = num_samples / num_workers;
+	num_steps = shard_size / batch_size;
+	if (num_steps == 0){
+		fprintf(stderr, "Error:: Too Few Samples For One Step! In Function -- train_data_parallel\n");
+		return -1;
+	}
+
+	segment = create_data_parallel_segment(self, num_workers, &bytes);
+	if (segment == NULL){
+		return -1;
+	}
+
+	//===Launch Workers===//
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	fflush(stdout);
+	fflush(stderr);
+	for (w=0; w<num_workers; w++){
+		workers[w] = fork();
+		if (workers[w] == 0){
+			run_data_parallel_worker(self, segment, w, inputs, labels, shard_size,
+									 batch_size, num_steps, num_epochs);
+			_exit(0);
+		}
+		if (workers[w] < 0){
+			//===Workers Already Started Would Wait Forever At The Barrier===//
+			fprintf(stderr, "Error:: Could Not Fork Worker %u! In Function -- train_data_parallel\n", w);
+			stop_data_parallel_workers(workers, w);
+			destroy_data_parallel_segment(segment, bytes, 0);
+			return -1;
+		}
+	}
+
+	//===Wait For Every Worker===//
+	result = wait_data_parallel_workers(workers, num_workers);
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	//===Take The Trained Weights===//
+	if (result == 0){
+		memcpy(self->weight_arena, segment->reduced, self->arena_size * sizeof(double));
+		mark_weights_changed(self);
+		for (l=0; l<self->num_hidden_layers+2; l++){
+			if (self->layer[l].sparse_weights != NULL){
+				refresh_sparse_weights(&(self->layer[l]));
+			}
+		}
+	}
+
+	if (report != NULL){
+		loss = 0;
+		for (w=0; w<num_workers; w++){
+			loss += segment->loss[w];
+		}
+		report->num_workers = num_workers;
+		report->num_steps = num_steps * num_epochs;
+		report->samples_per_step = num_workers * batch_size;
+		report->num_dropped = num_samples - num_steps * report->samples_per_step;
+		report->parallel_seconds = (stop.tv_sec - start.tv_sec) + 1e-9*(stop.tv_nsec - start.tv_nsec);
+		report->samples_per_second = (double)report->num_steps * report->samples_per_step / report->parallel_seconds;
+		report->mean_loss = loss / (num_steps * report->samples_per_step);
+	}
+	destroy_data_parallel_segment(segment, bytes, (result == 0));
+
+	return result;
+}
+
+int measure_data_parallel_scaling( neural_network_t* self,
+								   double* inputs,
+								   double* labels,
+								   unsigned int num_samples,
+								   unsigned int num_workers,
+								   unsigned int batch_size,
+								   unsigned int num_epochs,
+								   data_parallel_report_t* report )
+{
+	double* initial;
+	data_parallel_report_t serial;
+
+	if (self == NULL || report == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- measure_data_parallel_scaling\n");
+		return -1;
+	}
+	initial = malloc(self->arena_size * sizeof(double));
+	if (initial == NULL){
+		fprintf(stderr, "Error:: Initial Weights Were Not Saved! In Function -- measure_data_parallel_scaling\n");
+		return -1;
+	}
+	memcpy(initial, self->weight_arena, self->arena_size * sizeof(double));
+
+	//===One Worker Sees As Many Samples Per Step As All Of Them===//
+	if (train_data_parallel(self, inputs, labels, num_samples, 1, num_workers*batch_size, num_epochs, &serial) != 0){
+		free(initial);
+		return -1;
+	}
+	memcpy(self->weight_arena, initial, self->arena_size * sizeof(double));
+	free(initial);
+	if (train_data_parallel(self, inputs, labels, num_samples, num_workers, batch_size, num_epochs, report) != 0){
+		return -1;
+	}
+
+	report->serial_seconds = serial.parallel_seconds;
+	report->speedup = report->samples_per_second / serial.samples_per_second;
+	report->efficiency = report->speedup / num_workers;
+
+	return 0;
+}
+
+void print_data_parallel_report( data_parallel_report_t* report )
+{
+	fprintf(stdout, "Workers: %u  Steps: %u  Samples/Step: %u  Dropped/Epoch: %u\n", report->num_workers,
+			report->num_steps, report->samples_per_step, report->num_dropped);
+	fprintf(stdout, "Serial: %.4fs  Parallel: %.4fs  Samples/s: %.1f\n", report->serial_seconds,
+			report->parallel_seconds, report->samples_per_second);
+	fprintf(stdout, "Speedup: %.3f  Efficiency: %.1f%%  Loss: %.6f\n", report->speedup,
+			100.0*report->efficiency, report->mean_loss);
+	return;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+void test_data_parallel()
+{
+	unsigned int i, e, s, w, b, index, num_nodes[4];
+	double inputs[16*3], labels[16], *gradient;
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *serial;
+	data_parallel_report_t report;
+
+	//===Two Identical Networks===//
+	num_nodes[0] = 3; num_nodes[1] = 6; num_nodes[2] = 4; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.5);
+	network = create_neural_network(parameters);
+	serial = create_neural_network(parameters);
+	for (i=0; i<16; i++){
+		inputs[3*i] = (i & 1); inputs[3*i+1] = (i & 2)/2; inputs[3*i+2] = 0.1*i;
+		labels[i] = (double)((i & 1) ^ ((i & 2)/2));
+	}
+
+	//===Four Workers, Batches Of Two===//
+	if (train_data_parallel(network, inputs, labels, 16, 4, 2, 3, &report) != 0){
+		fprintf(stderr, "Error: Function train_data_parallel Has Failed!\n");
+	}
+
+	//===Emulate The Same Steps In One Process===//
+	gradient = calloc(serial->arena_size, sizeof(double));
+	for (e=0; e<3; e++){
+		for (s=0; s<2; s++){
+			memset(gradient, 0, serial->arena_size * sizeof(double));
+			for (w=0; w<4; w++){
+				for (b=0; b<2; b++){
+					index = w*4 + s*2 + b;
+					feed_forward(serial, inputs + 3*index);
+					back_propagate(serial, labels + index);
+					compute_weight_gradients(serial);
+					for (i=0; i<serial->arena_size; i++){
+						gradient[i] += serial->update_arena[i];
+					}
+				}
+			}
+			apply_weight_gradients(serial, gradient, -serial->learning_rate/8);
+		}
+	}
+	for (i=0; i<serial->arena_size; i++){
+		if (fabs(serial->weight_arena[i] - network->weight_arena[i]) > 1e-12){
+			fprintf(stderr, "Error: Function train_data_parallel Does Not Match Serial Training!\n");
+			break;
+		}
+	}
+
+	//===Leftover Samples And Part-Batches Are Counted===//
+	if (report.num_dropped != 0){
+		fprintf(stderr, "Error: Function train_data_parallel Dropped Samples Of An Even Split!\n");
+	}
+	if (train_data_parallel(network, inputs, labels, 15, 2, 3, 1, &report) != 0 || report.num_dropped != 3){
+		fprintf(stderr, "Error: Function train_data_parallel Miscounted Dropped Samples!\n");
+	}
+
+	//===Scaling Report Is Filled In===//
+	if (measure_data_parallel_scaling(network, inputs, labels, 16, 2, 2, 2, &report) != 0 ||
+		report.speedup <= 0 || report.efficiency <= 0){
+		fprintf(stderr, "Error: Function measure_data_parallel_scaling Has Failed!\n");
+	}
+
+	free(gradient);
+	destroy_neural_network(network);
+	destroy_neural_network(serial);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,169 @@
+#ifndef DATA_PARALLEL_H
+#define DATA_PARALLEL_H
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_DATA_PARALLEL_WORKERS 64
+#define DATA_PARALLEL_POLL_NANOSECONDS 1000000
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct data_parallel_report_t
+*   @brief This structure comprises the timing and scaling figures of a data parallel run.
+*
+*	serial_seconds, speedup and efficiency are only filled by measure_data_parallel_scaling;
+*	efficiency is speedup divided by the number of workers. num_dropped counts the samples of
+*	each epoch that no step trained on.
+*/
+//================================================================================================//
+typedef struct data_parallel_report_s data_parallel_report_t;
+typedef struct data_parallel_report_s{
+	unsigned int num_workers;
+	unsigned int num_steps;
+	unsigned int samples_per_step;
+	unsigned int num_dropped;
+	double parallel_seconds;
+	double serial_seconds;
+	double samples_per_second;
+	double speedup;
+	double efficiency;
+	double mean_loss;
+} data_parallel_report_t;
+
+
+//================================================================================================//
+/** @struct data_parallel_segment_t
+*   @brief This structure comprises the header of the shared memory segment of a run.
+*
+*	The header is followed by one gradient slot per worker and one reduced gradient, each in
+*	the network's weight arena layout and padded to WEIGHT_ALIGNMENT.
+*/
+//================================================================================================//
+typedef struct data_parallel_segment_s data_parallel_segment_t;
+typedef struct data_parallel_segment_s{
+	pthread_barrier_t barrier;
+	double loss[MAX_DATA_PARALLEL_WORKERS];
+	unsigned int num_workers;
+	size_t slot_size;
+	size_t chunk_size;
+	double* slot;
+	double* reduced;
+} data_parallel_segment_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function trains a network with several worker processes on the same host.
+*
+* The samples are split into one contiguous shard per worker. On every step each worker sums
+* the gradients of batch_size samples of its shard, the workers all-reduce those sums through
+* a POSIX shared memory segment, and every worker applies the averaged gradient, so all copies
+* of the weights stay identical. The trained weights are copied back into the network. Every
+* worker takes the same number of whole batches, so the num_samples % num_workers samples past
+* the last shard and any part-batch at the end of a shard are never trained on; the report
+* counts them in num_dropped. If a worker dies, the others are killed and -1 is returned.
+* The workers are separate processes, so no trace events are recorded.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double* inputs
+* @param[in] double* labels
+* @param[in] unsigned int num_samples
+* @param[in] unsigned int num_workers
+* @param[in] unsigned int batch_size
+* @param[in] unsigned int num_epochs
+* @param[out] data_parallel_report_t* report (may be NULL)
+*
+* @return int status (0 on success)
+*/
+//================================================================================================//
+int train_data_parallel( neural_network_t* self,
+						 double* inputs,
+						 double* labels,
+						 unsigned int num_samples,
+						 unsigned int num_workers,
+						 unsigned int batch_size,
+						 unsigned int num_epochs,
+						 data_parallel_report_t* report );
+
+
+//================================================================================================//
+/**
+* @brief This function measures how well data parallel training scales.
+*
+* The same epochs are trained once with one worker (at num_workers times the batch size, so
+* each step sees the same number of samples) and then with num_workers workers, starting from
+* the same weights. The network keeps the weights of the parallel run.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double* inputs
+* @param[in] double* labels
+* @param[in] unsigned int num_samples
+* @param[in] unsigned int num_workers
+* @param[in] unsigned int batch_size
+* @param[in] unsigned int num_epochs
+* @param[out] data_parallel_report_t* report
+*
+* @return int status (0 on success)
+*/
+//================================================================================================//
+int measure_data_parallel_scaling( neural_network_t* self,
+								   double* inputs,
+								   double* labels,
+								   unsigned int num_samples,
+								   unsigned int num_workers,
+								   unsigned int batch_size,
+								   unsigned int num_epochs,
+								   data_parallel_report_t* report );
+
+
+//================================================================================================//
+/**
+* @brief This function prints a data_parallel_report_t to stdout.
+*
+* If errors occur, the function exits.
+*
+* @param[in] data_parallel_report_t* report
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_data_parallel_report( data_parallel_report_t* report );
+
+
+//================================================================================================//
+/**
+* @brief This function tests data parallel training against a serial emulation.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_data_parallel();
+
+
+
+#endif //DATA_PARALLEL_H//
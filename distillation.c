@@ -0,0 +1,391 @@
+#include "distillation.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//=======================================Helper Functions=========================================//
+//================================================================================================//
+
+//===Teacher Rows [begin, end) In Blocks: One Product Per Layer Per Block===//
+static void run_teacher_rows( void* argument,
+							  unsigned int begin,
+							  unsigned int end )
+{
+	unsigned int b, r, l, i, rows, width, num_layers;
+	double *activation, *next, *derivative, *row;
+	neural_layer_t* layer;
+	neural_network_t* teacher;
+	distillation_t* self;
+
+	self = (distillation_t*)argument;
+	teacher = self->teacher;
+	num_layers = teacher->num_hidden_layers+2;
+	width = 0;
+	for (l=0; l<num_layers; l++){
+		width = MAX(width, teacher->layer[l].num_nodes+1);
+	}
+
+	activation = malloc((size_t)DISTILLATION_BLOCK_ROWS * width * sizeof(double));
+	next = malloc((size_t)DISTILLATION_BLOCK_ROWS * width * sizeof(double));
+	derivative = malloc(width * sizeof(double));
+	if (activation == NULL || next == NULL || derivative == NULL){
+		fprintf(stderr, "Error:: Block Buffers Were Not Allocated! In Function -- run_teacher_rows\n");
+		atomic_store(&(self->teacher_failed), 1);
+		free(activation); free(next); free(derivative);
+		return;
+	}
+
+	for (b=begin; b<end; b+=DISTILLATION_BLOCK_ROWS){
+		rows = MIN(DISTILLATION_BLOCK_ROWS, end - b);
+		memcpy(next, self->inputs + (size_t)b*self->num_inputs, (size_t)rows * self->num_inputs * sizeof(double));
+
+		for (l=0; l<num_layers; l++){
+			layer = &(teacher->layer[l]);
+
+			//===Soften The Logits===//
+			if (layer->next_layer == NULL && self->temperature != 1 &&
+				(layer->activation == ACTIVATION_SOFTMAX || layer->activation == ACTIVATION_SIGMOID)){
+				for (i=0; i<rows*layer->num_nodes; i++){
+					next[i] /= self->temperature;
+				}
+			}
+
+			//===Activate Each Row, With Its Bias Column===//
+			for (r=0; r<rows; r++){
+				row = activation + (size_t)r*(layer->num_nodes+1);
+				layer->backend->activate[layer->activation](next + (size_t)r*layer->num_nodes, row, derivative, layer->num_nodes);
+				row[layer->num_nodes] = 1;
+			}
+			if (layer->next_layer == NULL){
+				for (r=0; r<rows; r++){
+					memcpy(self->soft_targets + (size_t)(b+r)*self->num_outputs,
+						   activation + (size_t)r*(layer->num_nodes+1), self->num_outputs * sizeof(double));
+				}
+				break;
+			}
+
+			if (layer->use_sparse_weights){
+				csr_matrix_matrix_multiply(activation, rows, layer->sparse_weights, next);
+				continue;
+			}
+			layer->operation_backend[LAYER_OPERATION_FORWARD]->gemm(rows, layer->next_layer->num_nodes, layer->num_nodes+1,
+																	1.0, activation, layer->num_nodes+1,
+																	layer->weight_matrix, layer->leading_dimension,
+																	0.0, next, layer->next_layer->num_nodes);
+		}
+	}
+
+	free(activation);
+	free(next);
+	free(derivative);
+
+	return;
+}
+
+//================================================================================================//
+//====================================Distillation Functions======================================//
+//================================================================================================//
+
+distillation_t* create_distillation( neural_network_t* teacher,
+									 neural_network_t* student,
+									 thread_pool_t* pool,
+									 double temperature,
+									 double label_weight )
+{
+	distillation_t* self;
+
+	//===Check Parameters===//
+	if (teacher == NULL || student == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- create_distillation\n");
+		return NULL;
+	}
+	if (teacher->layer[0].num_nodes != student->layer[0].num_nodes ||
+		teacher->layer[teacher->num_hidden_layers+1].num_nodes != student->layer[student->num_hidden_layers+1].num_nodes){
+		fprintf(stderr, "Error:: Networks Have Different Inputs Or Outputs! In Function -- create_distillation\n");
+		return NULL;
+	}
+	if (!(temperature > 0) || label_weight < 0 || label_weight > 1){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- create_distillation\n");
+		return NULL;
+	}
+
+	self = malloc(sizeof(distillation_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Distillation Was Not Allocated! In Function -- create_distillation\n");
+		return NULL;
+	}
+	memset(self, 0, sizeof(distillation_t));
+	self->teacher = teacher;
+	self->student = student;
+	self->pool = (pool != NULL) ? pool : get_thread_pool();
+	self->temperature = temperature;
+	self->label_weight = label_weight;
+	self->num_inputs = teacher->layer[0].num_nodes;
+	self->num_outputs = teacher->layer[teacher->num_hidden_layers+1].num_nodes;
+	atomic_init(&(self->teacher_failed), 0);
+	initialize_thread_random_stream(student, 0, &(self->stream));
+
+	return self;
+}
+
+void destroy_distillation( distillation_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Distillation Is NULL! In Function -- destroy_distillation\n");
+		return;
+	}
+	free(self->soft_targets);
+	free(self);
+	return;
+}
+
+int refresh_teacher_targets( distillation_t* self,
+							 double* inputs,
+							 unsigned int num_samples )
+{
+	uint64_t version;
+	double* soft_targets;
+
+	if (self == NULL || inputs == NULL || num_samples == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- refresh_teacher_targets\n");
+		return -1;
+	}
+
+	version = get_weight_version(self->teacher);
+	if (self->valid && self->inputs == inputs && self->num_samples == num_samples && self->teacher_version == version){
+		return 0;
+	}
+
+	//===Resize The Cache===//
+	if (self->num_samples != num_samples || self->soft_targets == NULL){
+		soft_targets = realloc(self->soft_targets, (size_t)num_samples * self->num_outputs * sizeof(double));
+		if (soft_targets == NULL){
+			fprintf(stderr, "Error:: Soft Targets Were Not Allocated! In Function -- refresh_teacher_targets\n");
+			self->valid = 0;
+			return -1;
+		}
+		self->soft_targets = soft_targets;
+	}
+	self->inputs = inputs;
+	self->num_samples = num_samples;
+
+	atomic_store(&(self->teacher_failed), 0);
+	parallel_for(self->pool, 0, num_samples, DISTILLATION_BLOCK_ROWS, run_teacher_rows, self);
+	if (atomic_load(&(self->teacher_failed))){
+		fprintf(stderr, "Error:: Teacher Outputs Were Not Computed! In Function -- refresh_teacher_targets\n");
+		self->valid = 0;
+		return -1;
+	}
+	self->teacher_version = version;
+	self->num_teacher_passes++;
+	self->valid = 1;
+
+	return 1;
+}
+
+void invalidate_teacher_targets( distillation_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Distillation Is NULL! In Function -- invalidate_teacher_targets\n");
+		return;
+	}
+	self->valid = 0;
+	return;
+}
+
+double train_distillation( distillation_t* self,
+						   double* inputs,
+						   double* labels,
+						   unsigned int num_samples,
+						   unsigned int num_epochs )
+{
+	unsigned int e, s, i, *order;
+	double *target, *soft, *label, total_loss;
+
+	if (self == NULL || inputs == NULL || num_samples == 0 || (labels == NULL && self->label_weight > 0)){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- train_distillation\n");
+		return -1;
+	}
+
+	order = malloc(num_samples * sizeof(unsigned int));
+	target = malloc(self->num_outputs * sizeof(double));
+	if (order == NULL || target == NULL){
+		fprintf(stderr, "Error:: Buffers Were Not Allocated! In Function -- train_distillation\n");
+		free(order); free(target);
+		return -1;
+	}
+	for (s=0; s<num_samples; s++){
+		order[s] = s;
+	}
+
+	total_loss = 0;
+	for (e=0; e<num_epochs; e++){
+		if (refresh_teacher_targets(self, inputs, num_samples) < 0){
+			free(order); free(target);
+			return -1;
+		}
+		shuffle_indices(&(self->stream), order, num_samples);
+
+		total_loss = 0;
+		for (s=0; s<num_samples; s++){
+			soft = self->soft_targets + (size_t)order[s]*self->num_outputs;
+			if (self->label_weight > 0){
+				label = labels + (size_t)order[s]*self->num_outputs;
+				for (i=0; i<self->num_outputs; i++){
+					target[i] = (1 - self->label_weight) * soft[i] + self->label_weight * label[i];
+				}
+			}
+			else{
+				memcpy(target, soft, self->num_outputs * sizeof(double));
+			}
+			iterate_network(self->student, inputs + (size_t)order[s]*self->num_inputs, target);
+			total_loss += self->student->loss;
+		}
+	}
+
+	free(order);
+	free(target);
+
+	return (num_epochs > 0) ? total_loss / num_samples : 0;
+}
+
+double measure_distillation_agreement( distillation_t* self,
+									   double* inputs,
+									   unsigned int num_samples )
+{
+	unsigned int s, num_agree;
+	neural_context_t *teacher_context, *student_context;
+
+	if (self == NULL || inputs == NULL || num_samples == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- measure_distillation_agreement\n");
+		return -1;
+	}
+	teacher_context = create_neural_context(self->teacher);
+	student_context = create_neural_context(self->student);
+	if (teacher_context == NULL || student_context == NULL){
+		fprintf(stderr, "Error:: Contexts Were Not Allocated! In Function -- measure_distillation_agreement\n");
+		if (teacher_context != NULL) destroy_neural_context(teacher_context);
+		if (student_context != NULL) destroy_neural_context(student_context);
+		return -1;
+	}
+
+	num_agree = 0;
+	for (s=0; s<num_samples; s++){
+		feed_forward_context(self->teacher, teacher_context, inputs + (size_t)s*self->num_inputs);
+		feed_forward_context(self->student, student_context, inputs + (size_t)s*self->num_inputs);
+		if (self->num_outputs == 1){
+			num_agree += (teacher_context->output[0] >= 0.5) == (student_context->output[0] >= 0.5);
+		}
+		else{
+			num_agree += vector_argmax(teacher_context->output, self->num_outputs) ==
+						 vector_argmax(student_context->output, self->num_outputs);
+		}
+	}
+
+	destroy_neural_context(teacher_context);
+	destroy_neural_context(student_context);
+
+	return (double)num_agree / num_samples;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_distillation()
+{
+	unsigned int i, s, n, num_nodes[4];
+	double inputs[300*3], labels[300], before, after;
+	neural_network_parameters_t *teacher_parameters, *student_parameters;
+	neural_network_t *teacher, *student;
+	distillation_t* distillation;
+
+	//===A Curved Boundary The Teacher Learns First===//
+	for (s=0; s<300; s++){
+		for (i=0; i<3; i++){
+			inputs[s*3 + i] = sin(0.53*s*(i+1) + 0.7*i);
+		}
+		labels[s] = (inputs[s*3]*inputs[s*3] + inputs[s*3 + 1] - 0.5*inputs[s*3 + 2] > 0.3);
+	}
+	num_nodes[0] = 3; num_nodes[1] = 32; num_nodes[2] = 16; num_nodes[3] = 1;
+	teacher_parameters = create_neural_network_parameters(2, num_nodes, 0.2);
+	teacher_parameters->activation[1] = ACTIVATION_TANH;
+	teacher = create_neural_network(teacher_parameters);
+	for (n=0; n<100; n++){
+		for (s=0; s<300; s++){
+			iterate_network(teacher, inputs + s*3, labels + s);
+		}
+	}
+
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	student_parameters = create_neural_network_parameters(2, num_nodes, 0.2);
+	student_parameters->activation[1] = ACTIVATION_TANH;
+	student_parameters->seed = teacher_parameters->seed + 1;
+	student = create_neural_network(student_parameters);
+
+	distillation = create_distillation(teacher, student, NULL, 1, 0);
+	if (distillation == NULL){
+		fprintf(stderr, "Error: Function create_distillation Has Failed!\n");
+		destroy_neural_network(teacher);
+		destroy_neural_network(student);
+		free(teacher_parameters);
+		free(student_parameters);
+		return;
+	}
+
+	//===Batched Teacher Outputs Match feed_forward===//
+	refresh_teacher_targets(distillation, inputs, 300);
+	for (s=0; s<300; s++){
+		feed_forward(teacher, inputs + s*3);
+		if (fabs(teacher->output[0] - distillation->soft_targets[s]) > 1e-12){
+			fprintf(stderr, "Error: Function refresh_teacher_targets Does Not Match feed_forward!\n");
+			break;
+		}
+	}
+
+	//===The Cache Survives Epochs Until The Teacher Changes===//
+	before = measure_distillation_agreement(distillation, inputs, 300);
+	distillation->temperature = 2;
+	distillation->label_weight = 0.25;
+	invalidate_teacher_targets(distillation);
+	train_distillation(distillation, inputs, labels, 300, 3);
+	if (distillation->num_teacher_passes != 2){
+		fprintf(stderr, "Error: Function train_distillation Recomputed Cached Teacher Outputs!\n");
+	}
+	mark_weights_changed(teacher);
+	train_distillation(distillation, inputs, labels, 300, 200);
+	if (distillation->num_teacher_passes != 3){
+		fprintf(stderr, "Error: Function train_distillation Kept Stale Teacher Outputs!\n");
+	}
+
+	//===The Small Student Ends Up Agreeing With The Teacher===//
+	after = measure_distillation_agreement(distillation, inputs, 300);
+	if (after < 0.9 || after <= before){
+		fprintf(stderr, "Error: Function train_distillation Only Reached %lf Agreement (From %lf)!\n", after, before);
+	}
+
+	//===A Pruned Teacher Runs The Batched CSR Kernel===//
+	prune_network_to_sparsity(teacher, 0.5);
+	select_weight_kernels(teacher);
+	for (i=0; i<teacher->num_hidden_layers+1; i++){
+		teacher->layer[i].use_sparse_weights = 1;
+	}
+	distillation->temperature = 1;
+	invalidate_teacher_targets(distillation);
+	refresh_teacher_targets(distillation, inputs, 300);
+	for (s=0; s<300; s++){
+		feed_forward(teacher, inputs + s*3);
+		if (fabs(teacher->output[0] - distillation->soft_targets[s]) > 1e-12){
+			fprintf(stderr, "Error: Function refresh_teacher_targets Does Not Match A Sparse feed_forward!\n");
+			break;
+		}
+	}
+
+	destroy_distillation(distillation);
+	destroy_neural_network(teacher);
+	destroy_neural_network(student);
+	free(teacher_parameters);
+	free(student_parameters);
+
+	return;
+}
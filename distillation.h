@@ -0,0 +1,190 @@
+#ifndef DISTILLATION_H
+#define DISTILLATION_H
+
+#include "thread_pool.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define DISTILLATION_BLOCK_ROWS 32
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct distillation_t
+*   @brief This structure comprises a student network trained on a teacher network's outputs.
+*
+*	soft_targets caches the teacher's outputs for every training row, computed in blocks of
+*	DISTILLATION_BLOCK_ROWS with one matrix-matrix product per layer, spread over the thread
+*	pool. Softmax and sigmoid teacher outputs are softened by dividing their logits by
+*	temperature. The cache is checked at the start of every epoch and only recomputed when the
+*	inputs or the teacher's weight_version change. The student trains on
+*	(1 - label_weight) * soft + label_weight * label. As a deliberate simplification the student
+*	is not softened: it trains at temperature 1 against the softened targets, so it learns the
+*	teacher's ranking of classes with the teacher's softened confidence. teacher_failed is set
+*	by any block whose buffers could not be allocated.
+*/
+//================================================================================================//
+typedef struct distillation_s distillation_t;
+typedef struct distillation_s{
+	neural_network_t* teacher;
+	neural_network_t* student;
+	thread_pool_t* pool;
+	random_stream_t stream;
+	double temperature;
+	double label_weight;
+	double* soft_targets;
+	double* inputs;
+	unsigned int num_samples;
+	unsigned int num_inputs;
+	unsigned int num_outputs;
+	unsigned int num_teacher_passes;
+	uint64_t teacher_version;
+	atomic_int teacher_failed;
+	int valid;
+} distillation_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a distillation_t object for a teacher and a smaller student.
+*
+* Both networks need the same numbers of inputs and outputs; neither is owned. A NULL pool
+* uses the shared pool.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* teacher
+* @param[in,out] neural_network_t* student
+* @param[in] thread_pool_t* pool
+* @param[in] double temperature
+* @param[in] double label_weight
+*
+* @return distillation_t* self
+*/
+//================================================================================================//
+distillation_t* create_distillation( neural_network_t* teacher,
+									 neural_network_t* student,
+									 thread_pool_t* pool,
+									 double temperature,
+									 double label_weight );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a distillation_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] distillation_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_distillation( distillation_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function runs the teacher over the inputs unless the cached outputs are current.
+*
+* If any block fails, the cache is left invalid and the pass is not counted.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] distillation_t* self
+* @param[in] double* inputs
+* @param[in] unsigned int num_samples
+*
+* @return int status (1 if recomputed, 0 if cached, -1 on error)
+*/
+//================================================================================================//
+int refresh_teacher_targets( distillation_t* self,
+							 double* inputs,
+							 unsigned int num_samples );
+
+
+//================================================================================================//
+/**
+* @brief This function discards the cached teacher outputs, after inputs were changed in place.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] distillation_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void invalidate_teacher_targets( distillation_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function trains the student for num_epochs shuffled epochs over the inputs.
+*
+* labels may be NULL when label_weight is 0.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] distillation_t* self
+* @param[in] double* inputs
+* @param[in] double* labels
+* @param[in] unsigned int num_samples
+* @param[in] unsigned int num_epochs
+*
+* @return double mean_loss (of the student on its targets over the last epoch, -1 on error)
+*/
+//================================================================================================//
+double train_distillation( distillation_t* self,
+						   double* inputs,
+						   double* labels,
+						   unsigned int num_samples,
+						   unsigned int num_epochs );
+
+
+//================================================================================================//
+/**
+* @brief This function returns how often the student picks the same output as the teacher.
+*
+* Outputs agree when their largest units match, or for one output when both sit on the same
+* side of one half. The teacher is compared at temperature 1.
+*
+* If errors occur, the function exits.
+*
+* @param[in] distillation_t* self
+* @param[in] double* inputs
+* @param[in] unsigned int num_samples
+*
+* @return double agreement (-1 on error)
+*/
+//================================================================================================//
+double measure_distillation_agreement( distillation_t* self,
+									   double* inputs,
+									   unsigned int num_samples );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the batched teacher pass, the target cache and distillation.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_distillation();
+
+
+
+#endif //DISTILLATION_H//
@@ -15,15 +15,16 @@ void print_vector( double* vector,
 	return;
 }
 
-void print_matrix( double* matrix,
-				   int num_rows,
-				   int num_cols )
+void print_strided_matrix( double* matrix,
+						   int num_rows,
+						   int num_cols,
+						   int leading_dimension )
 {
 	int i, j;
 	fprintf(stdout, "\n");
 	for (i=0; i<num_rows; i++){
 		for (j=0; j<num_cols; j++){
-			fprintf(stdout, "%+lf ", matrix[j + i*num_cols]);
+			fprintf(stdout, "%+lf ", matrix[j + i*leading_dimension]);
 		}
 		fprintf(stdout, "\n");
 	}
@@ -32,11 +33,21 @@ void print_matrix( double* matrix,
 	return;
 }
 
-void vector_matrix_multiply( double* vector,
+void print_matrix( double* matrix,
+				   int num_rows,
+				   int num_cols )
+{
+	print_strided_matrix(matrix, num_rows, num_cols, num_cols);
+	return;
+}
+
+void vector_matrix_multiply( compute_backend_t* backend,
+							 double* vector,
 							 int vector_size,
 							 double* matrix,
 							 int matrix_rows,
 							 int matrix_columns,
+							 int leading_dimension,
 							 double* result )
 {
 
@@ -45,11 +56,10 @@ void vector_matrix_multiply( double* vector,
 		return;
 	}
 
-	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 
-				1, matrix_columns, vector_size, 
-				1.0, vector, vector_size, 
-				matrix, matrix_columns, 
-				0.0, result, matrix_columns);
+	backend->gemm(1, matrix_columns, vector_size,
+				  1.0, vector, vector_size,
+				  matrix, leading_dimension,
+				  0.0, result, matrix_columns);
 	
 	return;
 }
@@ -73,11 +83,13 @@ void test_vector_matrix_multiply()
 	matrix[15] = 16; matrix[16] = 17; matrix[17] = 18; matrix[18] = 19; matrix[19] = 20;
 
 
-	vector_matrix_multiply( vector,
+	vector_matrix_multiply( get_compute_backend(COMPUTE_BACKEND_AUTO),
+							vector,
 							4,
 							matrix,
 							4,
 							5,
+							5,
 							result);
 
 	if ( (int)result[0] != 110 ||
@@ -94,11 +106,13 @@ void test_vector_matrix_multiply()
 	return;
 }
 
-void matrix_vector_multiply( double* vector,
+void matrix_vector_multiply( compute_backend_t* backend,
+							 double* vector,
 							 int vector_size,
 							 double* matrix,
 							 int matrix_rows,
 							 int matrix_columns,
+							 int leading_dimension,
 							 double* result )
 {
 
@@ -109,23 +123,9 @@ void matrix_vector_multiply( double* vector,
 	}
 
 
- //zgemv (transa, 
-  //       m,     //cblas -- number of rows in A //acml -- number of columns
-  //       n,     //cblas -- number of columns in A// acml -- number of rows
-  //       alpha, //A constant
-  //       a,     //A itself
-  //       lda,   //leading dimension of A cblas -- columns of A // acml -- rows of A
-  //       x,     //vector x itself
-  //       incx,  //spacing between elements of x
-  //       beta,  //Another constant set it to zero
-  //       y,     //result vector
-  //       incy); //spacing between results
- 
-	cblas_dgemv(CblasRowMajor,
-		         CblasNoTrans, matrix_rows, matrix_columns,
-		         1.0, matrix, matrix_columns,
-		         vector, 1, 0.0,
-		         result, 1);
+	backend->gemv(matrix_rows, matrix_columns,
+				  1.0, matrix, leading_dimension,
+				  vector, 0.0, result);
 
 	return;
 }
@@ -148,11 +148,13 @@ void test_matrix_vector_multiply()
 	matrix[3] = 0; matrix[4] = -3; matrix[5] = 1;  
 
 
-	matrix_vector_multiply( vector,
+	matrix_vector_multiply( get_compute_backend(COMPUTE_BACKEND_AUTO),
+							vector,
 							3,
 							matrix,
 							2,
 							3,
+							3,
 							result );
 
 
@@ -167,12 +169,14 @@ void test_matrix_vector_multiply()
 	return;
 }
 
-void matrix_matrix_multiply( double* matrix1,
+void matrix_matrix_multiply( compute_backend_t* backend,
+							 double* matrix1,
 							 int matrix1_rows,
 							 int matrix1_columns,
 							 double* matrix2,
 							 int matrix2_rows,
 							 int matrix2_columns,
+							 int result_leading_dimension,
 							 double* result )
 {
 
@@ -181,11 +185,10 @@ void matrix_matrix_multiply( double* matrix1,
 		return;
 	}
 
-	cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 
-				matrix1_rows, matrix2_columns, matrix1_columns, 
-				1.0, matrix1, matrix1_columns, 
-				matrix2, matrix2_columns, 
-				0.0, result, matrix2_columns);
+	backend->gemm(matrix1_rows, matrix2_columns, matrix1_columns,
+				  1.0, matrix1, matrix1_columns,
+				  matrix2, matrix2_columns,
+				  0.0, result, result_leading_dimension);
 	
 	return;
 }
@@ -208,7 +211,7 @@ void test_matrix_matrix_multiply()
 	matrix2[0] = 5; matrix2[1] = 6; matrix2[2] = 7;
 
 	//===Run Multiply===//
-	matrix_matrix_multiply(matrix1, 4, 1, matrix2, 1, 3, result);
+	matrix_matrix_multiply(get_compute_backend(COMPUTE_BACKEND_AUTO), matrix1, 4, 1, matrix2, 1, 3, 3, result);
 	
 	//===Test Result===//
 	if ( (int)result[0] != 5 || (int)result[1] != 6 || (int)result[2] != 7 ||
@@ -223,19 +226,53 @@ void test_matrix_matrix_multiply()
 }
 
 
-void matrix_update( double* matrix,
+void matrix_update( compute_backend_t* backend,
+					double* matrix,
 					int matrix_rows,
-					int matrix_columns,
+					int leading_dimension,
 					double* update,
 					double update_weight )
 {
 
-	int i, j;
-	for (i=0; i<matrix_rows; i++){
-		for (j=0; j<matrix_columns; j++){
-			matrix[j + i*matrix_columns] += update_weight * update[j + i*matrix_columns];
-		}
+	//===Update Padding Too So The Loop Has No Row Remainders===//
+	backend->axpy(matrix_rows * leading_dimension, update_weight, update, matrix);
+
+	return;
+}
+
+void matrix_mask( double* matrix,
+				  int matrix_rows,
+				  int leading_dimension,
+				  double* mask )
+{
+
+	int i, size;
+
+	size = matrix_rows * leading_dimension;
+	for (i=0; i<size; i++){
+		matrix[i] *= mask[i];
 	}
 
 	return;
 }
+
+size_t round_up( size_t value,
+				 size_t multiple )
+{
+	return ((value + multiple - 1)/multiple) * multiple;
+}
+
+unsigned int vector_argmax( double* vector,
+							unsigned int length )
+{
+	unsigned int i, largest;
+
+	largest = 0;
+	for (i=1; i<length; i++){
+		if (vector[i] > vector[largest]){
+			largest = i;
+		}
+	}
+
+	return largest;
+}
@@ -36,27 +36,51 @@ void print_matrix( double* matrix,
 				   int num_cols );
 
 
+//================================================================================================//
+/**
+* @brief This function prints a row major matrix whose rows are leading_dimension apart.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* matrix
+* @param[in] int num_rows
+* @param[in] int num_cols
+* @param[in] int leading_dimension
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_strided_matrix( double* matrix,
+						   int num_rows,
+						   int num_cols,
+						   int leading_dimension );
+
+
 //================================================================================================//
 /**
 * @brief This function multiplies a vector by a matrix.
 *
 * If errors occur, the function exits.
 *
+* @param[in] compute_backend_t* backend
 * @param[in] double* vector
 * @param[in] int vector_size
 * @param[in] double* matrix
 * @param[in] int matrix_rows
 * @param[in] int matrix_columns
+* @param[in] int leading_dimension
 * @param[in,out] double* result
 *
 * @return NONE
 */
 //================================================================================================//
-void vector_matrix_multiply( double* vector,
+void vector_matrix_multiply( compute_backend_t* backend,
+							 double* vector,
 							 int vector_size,
 							 double* matrix,
 							 int matrix_rows,
 							 int matrix_columns,
+							 int leading_dimension,
 							 double* result );
 
 
@@ -74,4 +98,139 @@ void test_vector_matrix_multiply();
 
 
 
+//================================================================================================//
+/**
+* @brief This function multiplies a matrix by a vector.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compute_backend_t* backend
+* @param[in] double* vector
+* @param[in] int vector_size
+* @param[in] double* matrix
+* @param[in] int matrix_rows
+* @param[in] int matrix_columns
+* @param[in] int leading_dimension
+* @param[in,out] double* result
+*
+* @return NONE
+*/
+//================================================================================================//
+void matrix_vector_multiply( compute_backend_t* backend,
+							 double* vector,
+							 int vector_size,
+							 double* matrix,
+							 int matrix_rows,
+							 int matrix_columns,
+							 int leading_dimension,
+							 double* result );
+
+
+//================================================================================================//
+/**
+* @brief This function multiplies two packed matrices into a strided result.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compute_backend_t* backend
+* @param[in] double* matrix1
+* @param[in] int matrix1_rows
+* @param[in] int matrix1_columns
+* @param[in] double* matrix2
+* @param[in] int matrix2_rows
+* @param[in] int matrix2_columns
+* @param[in] int result_leading_dimension
+* @param[in,out] double* result
+*
+* @return NONE
+*/
+//================================================================================================//
+void matrix_matrix_multiply( compute_backend_t* backend,
+							 double* matrix1,
+							 int matrix1_rows,
+							 int matrix1_columns,
+							 double* matrix2,
+							 int matrix2_rows,
+							 int matrix2_columns,
+							 int result_leading_dimension,
+							 double* result );
+
+
+//================================================================================================//
+/**
+* @brief This function adds update_weight times an update to a strided matrix.
+*
+* If errors occur, the function exits.
+*
+* @param[in] compute_backend_t* backend
+* @param[in,out] double* matrix
+* @param[in] int matrix_rows
+* @param[in] int leading_dimension
+* @param[in] double* update
+* @param[in] double update_weight
+*
+* @return NONE
+*/
+//================================================================================================//
+void matrix_update( compute_backend_t* backend,
+					double* matrix,
+					int matrix_rows,
+					int leading_dimension,
+					double* update,
+					double update_weight );
+
+
+//================================================================================================//
+/**
+* @brief This function multiplies a strided matrix elementwise by a mask of the same layout.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] double* matrix
+* @param[in] int matrix_rows
+* @param[in] int leading_dimension
+* @param[in] double* mask
+*
+* @return NONE
+*/
+//================================================================================================//
+void matrix_mask( double* matrix,
+				  int matrix_rows,
+				  int leading_dimension,
+				  double* mask );
+
+
+//================================================================================================//
+/**
+* @brief This function rounds a value up to a multiple, such as WEIGHT_ALIGNMENT bytes.
+*
+* If errors occur, the function exits.
+*
+* @param[in] size_t value
+* @param[in] size_t multiple
+*
+* @return size_t rounded
+*/
+//================================================================================================//
+size_t round_up( size_t value,
+				 size_t multiple );
+
+
+//================================================================================================//
+/**
+* @brief This function returns the index of the largest entry of a vector, the first on ties.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* vector
+* @param[in] unsigned int length
+*
+* @return unsigned int index
+*/
+//================================================================================================//
+unsigned int vector_argmax( double* vector,
+							unsigned int length );
+
+
+
 #endif //HELPER_H//
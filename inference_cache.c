@@ -0,0 +1,457 @@
+#include "inference_cache.h"
+#include "thread_pool.h"
+
+//================================================================================================//
+//========================================Key Functions===========================================//
+//================================================================================================//
+
+static inline int64_t feature_key( inference_cache_t* self,
+								   double feature )
+{
+	int64_t key;
+
+	if (self->quantization_step > 0){
+		return llround(feature / self->quantization_step);
+	}
+	memcpy(&key, &feature, sizeof(int64_t));
+	return key;
+}
+
+//===Multiply-Rotate Per Feature, Then The SplitMix64 Finalizer For The Set Index===//
+static uint64_t hash_input( inference_cache_t* self,
+							double* input )
+{
+	unsigned int i;
+	uint64_t hash;
+
+	hash = self->num_inputs;
+	for (i=0; i<self->num_inputs; i++){
+		hash ^= (uint64_t)feature_key(self, input[i]) * 0x9E3779B97F4A7C15ULL;
+		hash = ((hash << 27) | (hash >> 37)) * 0xBF58476D1CE4E5B9ULL;
+	}
+	hash ^= hash >> 30;
+	hash *= 0xBF58476D1CE4E5B9ULL;
+	hash ^= hash >> 27;
+	hash *= 0x94D049BB133111EBULL;
+	hash ^= hash >> 31;
+
+	return hash;
+}
+
+static int key_matches( inference_cache_t* self,
+						size_t entry,
+						uint64_t hash,
+						double* input )
+{
+	unsigned int i;
+	int64_t* key;
+
+	if (!self->occupied[entry] || self->hashes[entry] != hash){
+		return 0;
+	}
+	key = self->keys + entry*self->num_inputs;
+	for (i=0; i<self->num_inputs; i++){
+		if (key[i] != feature_key(self, input[i])){
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+//===Caller Holds The Set's Shard Lock===//
+static size_t find_entry( inference_cache_t* self,
+						  size_t set,
+						  uint64_t hash,
+						  double* input )
+{
+	size_t way, entry;
+
+	for (way=0; way<INFERENCE_CACHE_WAYS; way++){
+		entry = set*INFERENCE_CACHE_WAYS + way;
+		if (key_matches(self, entry, hash, input)){
+			return entry;
+		}
+	}
+
+	return self->num_entries;
+}
+
+//===Free Or Stale Ways First, Otherwise Sweep The Hand Past Referenced Ways===//
+static size_t choose_victim( inference_cache_t* self,
+							 size_t set,
+							 uint64_t version,
+							 inference_cache_shard_t* shard )
+{
+	size_t way, entry;
+
+	for (way=0; way<INFERENCE_CACHE_WAYS; way++){
+		entry = set*INFERENCE_CACHE_WAYS + way;
+		if (!self->occupied[entry]){
+			return entry;
+		}
+		if (self->versions[entry] != version){
+			shard->invalidations++;
+			return entry;
+		}
+	}
+
+	while (1){
+		entry = set*INFERENCE_CACHE_WAYS + self->hands[set];
+		self->hands[set] = (self->hands[set] + 1) % INFERENCE_CACHE_WAYS;
+		if (!self->referenced[entry]){
+			shard->evictions++;
+			return entry;
+		}
+		self->referenced[entry] = 0;
+	}
+}
+
+//================================================================================================//
+//========================================Cache Functions=========================================//
+//================================================================================================//
+
+inference_cache_t* create_inference_cache( neural_network_t* network,
+										   size_t memory_budget,
+										   double quantization_step )
+{
+	unsigned int s;
+	size_t entry_size;
+	inference_cache_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- create_inference_cache\n");
+		return NULL;
+	}
+	if (quantization_step < 0 || isnan(quantization_step)){
+		fprintf(stderr, "Error:: Quantization Step Is Invalid! In Function -- create_inference_cache\n");
+		return NULL;
+	}
+
+	self = malloc(sizeof(inference_cache_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Cache Was Not Allocated! In Function -- create_inference_cache\n");
+		return NULL;
+	}
+	self->network = network;
+	self->quantization_step = quantization_step;
+	self->num_inputs = network->layer[0].num_nodes;
+	self->num_outputs = network->layer[network->num_hidden_layers+1].num_nodes;
+
+	//===Whole Sets Of Key, Output And Bookkeeping That Fit The Budget===//
+	entry_size = self->num_inputs*sizeof(int64_t) + self->num_outputs*sizeof(double)
+			   + 2*sizeof(uint64_t) + 2*sizeof(unsigned char);
+	self->num_sets = memory_budget / (INFERENCE_CACHE_WAYS*entry_size + sizeof(unsigned char));
+	self->num_entries = self->num_sets * INFERENCE_CACHE_WAYS;
+	self->memory_used = self->num_entries*entry_size + self->num_sets*sizeof(unsigned char);
+	if (self->num_sets == 0){
+		fprintf(stderr, "Error:: Memory Budget Is Below One Set! In Function -- create_inference_cache\n");
+		free(self);
+		return NULL;
+	}
+
+	self->keys = malloc(self->num_entries * self->num_inputs * sizeof(int64_t));
+	self->outputs = malloc(self->num_entries * self->num_outputs * sizeof(double));
+	self->hashes = malloc(self->num_entries * sizeof(uint64_t));
+	self->versions = malloc(self->num_entries * sizeof(uint64_t));
+	self->referenced = calloc(self->num_entries, sizeof(unsigned char));
+	self->occupied = calloc(self->num_entries, sizeof(unsigned char));
+	self->hands = calloc(self->num_sets, sizeof(unsigned char));
+	if (self->keys == NULL || self->outputs == NULL || self->hashes == NULL || self->versions == NULL
+		|| self->referenced == NULL || self->occupied == NULL || self->hands == NULL){
+		fprintf(stderr, "Error:: Cache Entries Were Not Allocated! In Function -- create_inference_cache\n");
+		free(self->keys); free(self->outputs); free(self->hashes); free(self->versions);
+		free(self->referenced); free(self->occupied); free(self->hands);
+		free(self);
+		return NULL;
+	}
+
+	for (s=0; s<INFERENCE_CACHE_SHARDS; s++){
+		pthread_mutex_init(&(self->shard[s].lock), NULL);
+		self->shard[s].hits = 0;
+		self->shard[s].misses = 0;
+		self->shard[s].evictions = 0;
+		self->shard[s].invalidations = 0;
+	}
+
+	return self;
+}
+
+void destroy_inference_cache( inference_cache_t* self )
+{
+	unsigned int s;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Cache Is NULL! In Function -- destroy_inference_cache\n");
+		return;
+	}
+	for (s=0; s<INFERENCE_CACHE_SHARDS; s++){
+		pthread_mutex_destroy(&(self->shard[s].lock));
+	}
+	free(self->keys);
+	free(self->outputs);
+	free(self->hashes);
+	free(self->versions);
+	free(self->referenced);
+	free(self->occupied);
+	free(self->hands);
+	free(self);
+
+	return;
+}
+
+int cached_feed_forward( inference_cache_t* self,
+						 neural_context_t* context,
+						 double* input,
+						 double* output )
+{
+	unsigned int i;
+	size_t set, entry;
+	uint64_t hash, version;
+	inference_cache_shard_t* shard;
+
+	if (self == NULL || context == NULL || input == NULL || output == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- cached_feed_forward\n");
+		return -1;
+	}
+	version = get_weight_version(self->network);
+	hash = hash_input(self, input);
+	set = hash % self->num_sets;
+	shard = &(self->shard[set % INFERENCE_CACHE_SHARDS]);
+
+	//===Hit: Entries From Older Weights Count As Absent===//
+	pthread_mutex_lock(&(shard->lock));
+	entry = find_entry(self, set, hash, input);
+	if (entry < self->num_entries && self->versions[entry] == version){
+		memcpy(output, self->outputs + entry*self->num_outputs, self->num_outputs * sizeof(double));
+		self->referenced[entry] = 1;
+		shard->hits++;
+		pthread_mutex_unlock(&(shard->lock));
+		return 1;
+	}
+	if (entry < self->num_entries){
+		self->occupied[entry] = 0;
+		shard->invalidations++;
+	}
+	shard->misses++;
+	pthread_mutex_unlock(&(shard->lock));
+
+	//===Miss: Evaluate Unlocked, On The Quantized Input So The Entry Fits Every Input It Covers===//
+	if (self->quantization_step > 0){
+		for (i=0; i<self->num_inputs; i++){
+			context->input[i] = feature_key(self, input[i]) * self->quantization_step;
+		}
+		feed_forward_context(self->network, context, context->input);
+	}
+	else{
+		feed_forward_context(self->network, context, input);
+	}
+	memcpy(output, context->output, self->num_outputs * sizeof(double));
+
+	//===Insert Unless Another Thread Already Did===//
+	pthread_mutex_lock(&(shard->lock));
+	entry = find_entry(self, set, hash, input);
+	if (entry == self->num_entries){
+		entry = choose_victim(self, set, version, shard);
+		for (i=0; i<self->num_inputs; i++){
+			self->keys[entry*self->num_inputs + i] = feature_key(self, input[i]);
+		}
+		self->hashes[entry] = hash;
+		self->occupied[entry] = 1;
+	}
+	memcpy(self->outputs + entry*self->num_outputs, output, self->num_outputs * sizeof(double));
+	self->versions[entry] = version;
+	self->referenced[entry] = 0;
+	pthread_mutex_unlock(&(shard->lock));
+
+	return 0;
+}
+
+void get_inference_cache_stats( inference_cache_t* self,
+								inference_cache_stats_t* stats )
+{
+	unsigned int s;
+
+	if (self == NULL || stats == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- get_inference_cache_stats\n");
+		return;
+	}
+
+	memset(stats, 0, sizeof(inference_cache_stats_t));
+	for (s=0; s<INFERENCE_CACHE_SHARDS; s++){
+		pthread_mutex_lock(&(self->shard[s].lock));
+		stats->hits += self->shard[s].hits;
+		stats->misses += self->shard[s].misses;
+		stats->evictions += self->shard[s].evictions;
+		stats->invalidations += self->shard[s].invalidations;
+		pthread_mutex_unlock(&(self->shard[s].lock));
+	}
+	stats->num_entries = self->num_entries;
+	stats->memory_used = self->memory_used;
+
+	return;
+}
+
+void print_inference_cache_report( inference_cache_t* self )
+{
+	double hit_rate;
+	inference_cache_stats_t stats;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Cache Is NULL! In Function -- print_inference_cache_report\n");
+		return;
+	}
+
+	get_inference_cache_stats(self, &stats);
+	hit_rate = (stats.hits + stats.misses > 0) ? (double)stats.hits / (stats.hits + stats.misses) : 0;
+	fprintf(stdout, "Inference Cache: %lu Entries, %lu Bytes, %lu Hits, %lu Misses, Hit Rate %.1lf%%, %lu Evictions, %lu Invalidations\n",
+			stats.num_entries, stats.memory_used, stats.hits, stats.misses, 100.0*hit_rate,
+			stats.evictions, stats.invalidations);
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+typedef struct test_cache_lookups_s{
+	inference_cache_t* cache;
+	double* inputs;
+	double* outputs;
+} test_cache_lookups_t;
+
+static void run_test_lookups( void* argument,
+							  unsigned int begin,
+							  unsigned int end )
+{
+	unsigned int i;
+	neural_context_t* context;
+	test_cache_lookups_t* lookups;
+
+	lookups = (test_cache_lookups_t*)argument;
+	context = create_neural_context(lookups->cache->network);
+	for (i=begin; i<end; i++){
+		cached_feed_forward(lookups->cache, context, lookups->inputs + (i%6)*4, lookups->outputs + i*3);
+	}
+	destroy_neural_context(context);
+
+	return;
+}
+
+void test_inference_cache()
+{
+	unsigned int i, j, num_nodes[3];
+	double inputs[6*4], noisy[4], label[3], output[3], outputs[64*3];
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	neural_context_t* context;
+	inference_cache_t* cache;
+	inference_cache_stats_t stats;
+	test_cache_lookups_t lookups;
+	thread_pool_t* pool;
+
+	num_nodes[0] = 4; num_nodes[1] = 9; num_nodes[2] = 3;
+	parameters = create_neural_network_parameters(1, num_nodes, 0.1);
+	parameters->activation[2] = ACTIVATION_SOFTMAX;
+	network = create_neural_network(parameters);
+	context = create_neural_context(network);
+	for (i=0; i<6*4; i++){
+		inputs[i] = 0.01*round(100*sin(0.9*i));
+	}
+
+	//===Quantized Keys: Jitter Below Half A Step Still Hits===//
+	cache = create_inference_cache(network, 1 << 16, 0.01);
+	if (cache == NULL){
+		fprintf(stderr, "Error: Function create_inference_cache Has Failed!\n");
+		destroy_neural_context(context);
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	for (i=0; i<36; i++){
+		for (j=0; j<4; j++){
+			noisy[j] = inputs[(i%6)*4 + j] + ((i < 6) ? 0 : 0.004*cos(i + j));
+		}
+		cached_feed_forward(cache, context, noisy, output);
+		feed_forward(network, inputs + (i%6)*4);
+		for (j=0; j<3; j++){
+			if (fabs(output[j] - network->output[j]) > 1e-12){
+				fprintf(stderr, "Error: Function cached_feed_forward Does Not Match feed_forward!\n");
+				i = 36;
+				break;
+			}
+		}
+	}
+	get_inference_cache_stats(cache, &stats);
+	if (stats.misses != 6 || stats.hits != 30){
+		fprintf(stderr, "Error: Function cached_feed_forward Has %lu Hits And %lu Misses!\n", stats.hits, stats.misses);
+	}
+
+	//===A Weight Update Makes Every Entry Stale===//
+	memset(label, 0, sizeof(label));
+	label[1] = 1;
+	iterate_network(network, inputs, label);
+	if (cached_feed_forward(cache, context, inputs, output) != 0){
+		fprintf(stderr, "Error: Function cached_feed_forward Returned An Entry From Old Weights!\n");
+	}
+	feed_forward(network, inputs);
+	for (j=0; j<3; j++){
+		if (fabs(output[j] - network->output[j]) > 1e-12){
+			fprintf(stderr, "Error: Function cached_feed_forward Does Not Match Updated Weights!\n");
+			break;
+		}
+	}
+	get_inference_cache_stats(cache, &stats);
+	if (stats.invalidations != 1){
+		fprintf(stderr, "Error: Function cached_feed_forward Has %lu Invalidations!\n", stats.invalidations);
+	}
+
+	//===Concurrent Lookups From Four Threads===//
+	lookups.cache = cache;
+	lookups.inputs = inputs;
+	lookups.outputs = outputs;
+	pool = create_thread_pool(3, 0);
+	parallel_for(pool, 0, 64, 16, run_test_lookups, &lookups);
+	for (i=0; i<64; i++){
+		feed_forward(network, inputs + (i%6)*4);
+		for (j=0; j<3; j++){
+			if (fabs(outputs[i*3 + j] - network->output[j]) > 1e-12){
+				fprintf(stderr, "Error: Function cached_feed_forward Does Not Match Under Concurrency!\n");
+				i = 64;
+				break;
+			}
+		}
+	}
+	destroy_thread_pool(pool);
+	destroy_inference_cache(cache);
+
+	//===One Exact Set: Twelve Keys Through Eight Ways Evict Four===//
+	cache = create_inference_cache(network, INFERENCE_CACHE_WAYS*(4*8 + 3*8 + 18) + 1, 0);
+	if (cache == NULL || cache->num_entries != INFERENCE_CACHE_WAYS){
+		fprintf(stderr, "Error: Function create_inference_cache Did Not Respect The Budget!\n");
+		if (cache != NULL){
+			destroy_inference_cache(cache);
+		}
+		destroy_neural_context(context);
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	for (i=0; i<12; i++){
+		noisy[0] = i; noisy[1] = noisy[2] = noisy[3] = 0;
+		cached_feed_forward(cache, context, noisy, output);
+	}
+	get_inference_cache_stats(cache, &stats);
+	if (stats.evictions != 4 || stats.misses != 12){
+		fprintf(stderr, "Error: Function cached_feed_forward Has %lu Evictions!\n", stats.evictions);
+	}
+
+	destroy_inference_cache(cache);
+	destroy_neural_context(context);
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,195 @@
+#ifndef INFERENCE_CACHE_H
+#define INFERENCE_CACHE_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define INFERENCE_CACHE_WAYS 8
+#define INFERENCE_CACHE_SHARDS 64
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct inference_cache_shard_t
+*   @brief This structure comprises the lock and counters guarding one share of the cache sets.
+*
+*	Padded to whole cache lines, so threads working on different shards do not share one.
+*/
+//================================================================================================//
+typedef struct inference_cache_shard_s inference_cache_shard_t;
+typedef struct inference_cache_shard_s{
+	pthread_mutex_t lock;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	uint64_t invalidations;
+	char padding[2*WEIGHT_ALIGNMENT - sizeof(pthread_mutex_t) - 4*sizeof(uint64_t)];
+} inference_cache_shard_t;
+
+
+//================================================================================================//
+/** @struct inference_cache_stats_t
+*   @brief This structure comprises the counters of an inference cache, summed over its shards.
+*
+*	invalidations counts entries found to predate the network's current weights.
+*/
+//================================================================================================//
+typedef struct inference_cache_stats_s inference_cache_stats_t;
+typedef struct inference_cache_stats_s{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	uint64_t invalidations;
+	size_t num_entries;
+	size_t memory_used;
+} inference_cache_stats_t;
+
+
+//================================================================================================//
+/** @struct inference_cache_t
+*   @brief This structure comprises a fixed size memo of network outputs keyed by input vector.
+*
+*	An input is turned into a key of num_inputs integers: the bits of each feature, or with a
+*	quantization step the feature divided by the step and rounded. The key's hash picks a set of
+*	INFERENCE_CACHE_WAYS entries, and a set's entries are replaced by the CLOCK rule: the hand
+*	skips, and clears, entries referenced since it last passed. Each entry remembers the weight
+*	version it was computed under and is treated as absent once the network's version moves on.
+*	Sets are spread over INFERENCE_CACHE_SHARDS locks.
+*/
+//================================================================================================//
+typedef struct inference_cache_s inference_cache_t;
+typedef struct inference_cache_s{
+	inference_cache_shard_t shard[INFERENCE_CACHE_SHARDS];
+	neural_network_t* network;
+	int64_t* keys;
+	double* outputs;
+	uint64_t* hashes;
+	uint64_t* versions;
+	unsigned char* referenced;
+	unsigned char* occupied;
+	unsigned char* hands;
+	double quantization_step;
+	size_t num_sets;
+	size_t num_entries;
+	size_t memory_used;
+	unsigned int num_inputs;
+	unsigned int num_outputs;
+} inference_cache_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates an inference_cache_t object within a memory budget in bytes.
+*
+* A quantization_step of 0 keys on the exact input bits. Otherwise inputs that round to the same
+* multiples of the step share an entry, and a miss evaluates the network on those multiples, so
+* every input mapping to an entry gets the same output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] size_t memory_budget
+* @param[in] double quantization_step
+*
+* @return inference_cache_t* self
+*/
+//================================================================================================//
+inference_cache_t* create_inference_cache( neural_network_t* network,
+										   size_t memory_budget,
+										   double quantization_step );
+
+
+//================================================================================================//
+/**
+* @brief This function frees an inference_cache_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_cache_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_inference_cache( inference_cache_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function looks an input up in the cache, evaluating the network on a miss.
+*
+* Any number of threads may call it at once, each with its own context; the network is only
+* evaluated outside the cache's locks. The output is copied to output.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_cache_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* input
+* @param[out] double* output
+*
+* @return int status (1 on a hit, 0 on a miss, -1 on error)
+*/
+//================================================================================================//
+int cached_feed_forward( inference_cache_t* self,
+						 neural_context_t* context,
+						 double* input,
+						 double* output );
+
+
+//================================================================================================//
+/**
+* @brief This function sums the counters of an inference_cache_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_cache_t* self
+* @param[out] inference_cache_stats_t* stats
+*
+* @return NONE
+*/
+//================================================================================================//
+void get_inference_cache_stats( inference_cache_t* self,
+								inference_cache_stats_t* stats );
+
+
+//================================================================================================//
+/**
+* @brief This function prints the counters of an inference_cache_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_cache_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_inference_cache_report( inference_cache_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests hits, quantized keys, eviction, invalidation and concurrent lookups.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_inference_cache();
+
+
+
+#endif //INFERENCE_CACHE_H//
@@ -0,0 +1,447 @@
+#include "inference_queue.h"
+#include <poll.h>
+#include "helper.h"
+
+//================================================================================================//
+//======================================Ring Functions============================================//
+//================================================================================================//
+
+static int initialize_slot_ring( slot_ring_t* self,
+								 unsigned int capacity )
+{
+	unsigned int i;
+
+	self->cell = malloc(capacity * sizeof(slot_ring_cell_t));
+	if (self->cell == NULL){
+		fprintf(stderr, "Error:: Ring Was Not Allocated! In Function -- initialize_slot_ring\n");
+		return -1;
+	}
+	self->mask = capacity - 1;
+	for (i=0; i<capacity; i++){
+		atomic_init(&(self->cell[i].sequence), i);
+	}
+	atomic_init(&(self->enqueue_position), 0);
+	atomic_init(&(self->dequeue_position), 0);
+
+	return 0;
+}
+
+static int slot_ring_push( slot_ring_t* self,
+						   unsigned int slot )
+{
+	size_t position, sequence;
+	slot_ring_cell_t* cell;
+
+	position = atomic_load_explicit(&(self->enqueue_position), memory_order_relaxed);
+	while (1){
+		cell = &(self->cell[position & self->mask]);
+		sequence = atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+		if (sequence == position){
+			if (atomic_compare_exchange_weak_explicit(&(self->enqueue_position), &position, position + 1,
+													  memory_order_relaxed, memory_order_relaxed)){
+				break;
+			}
+		}
+		else if ((ptrdiff_t)(sequence - position) < 0){
+			return -1;
+		}
+		else{
+			position = atomic_load_explicit(&(self->enqueue_position), memory_order_relaxed);
+		}
+	}
+
+	//===Release Publishes The Slot And Everything Written Into It===//
+	cell->slot = slot;
+	atomic_store_explicit(&(cell->sequence), position + 1, memory_order_release);
+
+	return 0;
+}
+
+static int slot_ring_pop( slot_ring_t* self,
+						  unsigned int* slot )
+{
+	size_t position, sequence;
+	slot_ring_cell_t* cell;
+
+	position = atomic_load_explicit(&(self->dequeue_position), memory_order_relaxed);
+	while (1){
+		cell = &(self->cell[position & self->mask]);
+		sequence = atomic_load_explicit(&(cell->sequence), memory_order_acquire);
+		if (sequence == position + 1){
+			if (atomic_compare_exchange_weak_explicit(&(self->dequeue_position), &position, position + 1,
+													  memory_order_relaxed, memory_order_relaxed)){
+				break;
+			}
+		}
+		else if ((ptrdiff_t)(sequence - (position + 1)) < 0){
+			return -1;
+		}
+		else{
+			position = atomic_load_explicit(&(self->dequeue_position), memory_order_relaxed);
+		}
+	}
+
+	*slot = cell->slot;
+	atomic_store_explicit(&(cell->sequence), position + self->mask + 1, memory_order_release);
+
+	return 0;
+}
+
+//================================================================================================//
+//===================================Dispatcher Functions=========================================//
+//================================================================================================//
+
+static void evaluate_requests( void* argument,
+							   unsigned int begin,
+							   unsigned int end )
+{
+	unsigned int i, slot;
+	inference_queue_t* self;
+
+	self = (inference_queue_t*)argument;
+	for (i=begin; i<end; i++){
+		slot = self->batch[i];
+		feed_forward_context(self->network, self->contexts[i], self->inputs + (size_t)slot*self->num_inputs);
+		memcpy(self->outputs + (size_t)slot*self->num_outputs, self->contexts[i]->output, self->num_outputs * sizeof(double));
+	}
+
+	return;
+}
+
+//===A Counted Request May Still Be Being Published By Its Producer===//
+static int take_request( inference_queue_t* self,
+						 unsigned int* slot )
+{
+	while (slot_ring_pop(&(self->requests), slot) != 0){
+		if (atomic_load(&(self->shutdown))){
+			return -1;
+		}
+		sched_yield();
+	}
+	return 0;
+}
+
+static void* run_inference_dispatcher( void* argument )
+{
+	unsigned int i;
+	uint64_t count;
+	inference_queue_t* self;
+
+	self = (inference_queue_t*)argument;
+	while (1){
+		while (sem_wait(&(self->pending)) != 0);
+		if (atomic_load(&(self->shutdown)) || take_request(self, &(self->batch[0])) != 0){
+			break;
+		}
+
+		//===Batch Whatever Else Is Already Queued===//
+		self->batch_size = 1;
+		while (self->batch_size < self->max_batch && sem_trywait(&(self->pending)) == 0){
+			if (take_request(self, &(self->batch[self->batch_size])) != 0){
+				return NULL;
+			}
+			self->batch_size++;
+		}
+
+		parallel_for(self->pool, 0, self->batch_size, 1, evaluate_requests, self);
+
+		//===Deliver===//
+		for (i=0; i<self->batch_size; i++){
+			if (self->callback != NULL){
+				self->callback(self->tags[self->batch[i]], self->outputs + (size_t)self->batch[i]*self->num_outputs,
+							   self->num_outputs, self->user_data);
+				slot_ring_push(&(self->free_slots), self->batch[i]);
+			}
+			else{
+				slot_ring_push(&(self->completions), self->batch[i]);
+			}
+		}
+		if (self->callback == NULL){
+			count = self->batch_size;
+			if (write(self->event_fd, &count, sizeof(count)) != sizeof(count)){
+				fprintf(stderr, "Error:: Completion Was Not Signalled! In Function -- run_inference_dispatcher\n");
+			}
+		}
+	}
+
+	return NULL;
+}
+
+//================================================================================================//
+//======================================Queue Functions===========================================//
+//================================================================================================//
+
+inference_queue_t* create_inference_queue( neural_network_t* network,
+										   thread_pool_t* pool,
+										   unsigned int capacity,
+										   unsigned int max_batch,
+										   inference_callback_t callback,
+										   void* user_data )
+{
+	unsigned int i, size;
+	inference_queue_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- create_inference_queue\n");
+		return NULL;
+	}
+	if (capacity == 0 || max_batch == 0 || max_batch > MAX_INFERENCE_BATCH){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- create_inference_queue\n");
+		return NULL;
+	}
+
+	self = aligned_alloc(WEIGHT_ALIGNMENT, round_up(sizeof(inference_queue_t), WEIGHT_ALIGNMENT));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Queue Was Not Allocated! In Function -- create_inference_queue\n");
+		return NULL;
+	}
+	memset(self, 0, sizeof(inference_queue_t));
+
+	//===Set Local Data===//
+	size = 1;
+	while (size < capacity){
+		size <<= 1;
+	}
+	self->network = network;
+	self->pool = (pool != NULL) ? pool : get_thread_pool();
+	self->capacity = size;
+	self->max_batch = max_batch;
+	self->callback = callback;
+	self->user_data = user_data;
+	self->num_inputs = network->layer[0].num_nodes;
+	self->num_outputs = network->layer[network->num_hidden_layers+1].num_nodes;
+	atomic_init(&(self->shutdown), 0);
+
+	//===Slots, Rings And Contexts===//
+	self->inputs = malloc((size_t)size * self->num_inputs * sizeof(double));
+	self->outputs = malloc((size_t)size * self->num_outputs * sizeof(double));
+	self->tags = malloc(size * sizeof(uint64_t));
+	self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (self->inputs == NULL || self->outputs == NULL || self->tags == NULL || self->event_fd < 0 ||
+		initialize_slot_ring(&(self->free_slots), size) != 0 ||
+		initialize_slot_ring(&(self->requests), size) != 0 ||
+		initialize_slot_ring(&(self->completions), size) != 0){
+		fprintf(stderr, "Error:: Inference Queue Buffers Were Not Allocated! In Function -- create_inference_queue\n");
+		destroy_inference_queue(self);
+		return NULL;
+	}
+	for (i=0; i<size; i++){
+		slot_ring_push(&(self->free_slots), i);
+	}
+	for (i=0; i<max_batch; i++){
+		self->contexts[i] = create_neural_context(network);
+		if (self->contexts[i] == NULL){
+			fprintf(stderr, "Error:: Context Was Not Created! In Function -- create_inference_queue\n");
+			destroy_inference_queue(self);
+			return NULL;
+		}
+	}
+
+	//===Start Dispatcher===//
+	sem_init(&(self->pending), 0, 0);
+	if (pthread_create(&(self->dispatcher), NULL, run_inference_dispatcher, self) != 0){
+		fprintf(stderr, "Error:: Dispatcher Thread Was Not Created! In Function -- create_inference_queue\n");
+		sem_destroy(&(self->pending));
+		destroy_inference_queue(self);
+		return NULL;
+	}
+	self->dispatcher_started = 1;
+
+	return self;
+}
+
+void destroy_inference_queue( inference_queue_t* self )
+{
+	unsigned int i;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Queue Is NULL! In Function -- destroy_inference_queue\n");
+		return;
+	}
+
+	if (self->dispatcher_started){
+		atomic_store(&(self->shutdown), 1);
+		sem_post(&(self->pending));
+		pthread_join(self->dispatcher, NULL);
+		sem_destroy(&(self->pending));
+	}
+
+	for (i=0; i<self->max_batch; i++){
+		if (self->contexts[i] != NULL){
+			destroy_neural_context(self->contexts[i]);
+		}
+	}
+	if (self->event_fd >= 0){
+		close(self->event_fd);
+	}
+	free(self->free_slots.cell);
+	free(self->requests.cell);
+	free(self->completions.cell);
+	free(self->inputs);
+	free(self->outputs);
+	free(self->tags);
+	free(self);
+
+	return;
+}
+
+int nn_submit( inference_queue_t* self,
+			   double* input,
+			   uint64_t tag )
+{
+	unsigned int slot;
+
+	if (self == NULL || input == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- nn_submit\n");
+		return -1;
+	}
+
+	//===Backpressure: No Free Slot, No Request===//
+	if (slot_ring_pop(&(self->free_slots), &slot) != 0){
+		return INFERENCE_QUEUE_FULL;
+	}
+	memcpy(self->inputs + (size_t)slot*self->num_inputs, input, self->num_inputs * sizeof(double));
+	self->tags[slot] = tag;
+
+	//===Slots Bound The Rings, So This Push Cannot Fail===//
+	slot_ring_push(&(self->requests), slot);
+	sem_post(&(self->pending));
+
+	return 0;
+}
+
+int nn_poll( inference_queue_t* self,
+			 uint64_t* tag,
+			 double* output )
+{
+	unsigned int slot;
+
+	if (self == NULL || tag == NULL || output == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- nn_poll\n");
+		return 0;
+	}
+	if (slot_ring_pop(&(self->completions), &slot) != 0){
+		return 0;
+	}
+	*tag = self->tags[slot];
+	memcpy(output, self->outputs + (size_t)slot*self->num_outputs, self->num_outputs * sizeof(double));
+	slot_ring_push(&(self->free_slots), slot);
+
+	return 1;
+}
+
+int nn_completion_fd( inference_queue_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Inference Queue Is NULL! In Function -- nn_completion_fd\n");
+		return -1;
+	}
+	return self->event_fd;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+typedef struct test_completion_s{
+	double output[32][2];
+	atomic_uint num_completed;
+} test_completion_t;
+
+static void test_inference_callback( uint64_t tag,
+									 double* output,
+									 unsigned int num_outputs,
+									 void* user_data )
+{
+	test_completion_t* test;
+
+	test = (test_completion_t*)user_data;
+	memcpy(test->output[tag], output, num_outputs * sizeof(double));
+	atomic_fetch_add(&(test->num_completed), 1);
+	return;
+}
+
+void test_inference_queue()
+{
+	unsigned int i, j, n, num_nodes[3];
+	uint64_t tag, count;
+	double inputs[32][3], output[2];
+	struct pollfd descriptor;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	inference_queue_t* queue;
+	test_completion_t completion;
+
+	num_nodes[0] = 3; num_nodes[1] = 7; num_nodes[2] = 2;
+	parameters = create_neural_network_parameters(1, num_nodes, 0.1);
+	network = create_neural_network(parameters);
+	for (i=0; i<32; i++){
+		for (j=0; j<3; j++){
+			inputs[i][j] = cos(0.3*i + j);
+		}
+	}
+
+	//===Eight Slots: The Ninth Request Waits For A Poll===//
+	queue = create_inference_queue(network, NULL, 8, 4, NULL, NULL);
+	if (queue == NULL){
+		fprintf(stderr, "Error: Function create_inference_queue Has Failed!\n");
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	for (i=0; i<8; i++){
+		if (nn_submit(queue, inputs[i], i) != 0){
+			fprintf(stderr, "Error: Function nn_submit Has Failed!\n");
+		}
+	}
+	if (nn_submit(queue, inputs[8], 8) != INFERENCE_QUEUE_FULL){
+		fprintf(stderr, "Error: Function nn_submit Does Not Apply Backpressure!\n");
+	}
+
+	//===Event Loop: Wait On The fd, Then Drain===//
+	n = 0;
+	descriptor.fd = nn_completion_fd(queue);
+	descriptor.events = POLLIN;
+	while (n < 8 && poll(&descriptor, 1, 5000) > 0){
+		if (read(descriptor.fd, &count, sizeof(count)) != sizeof(count)){
+			continue;
+		}
+		while (nn_poll(queue, &tag, output)){
+			feed_forward(network, inputs[tag]);
+			if (tag >= 8 || fabs(output[0] - network->output[0]) > 1e-12 || fabs(output[1] - network->output[1]) > 1e-12){
+				fprintf(stderr, "Error: Function nn_poll Does Not Match feed_forward!\n");
+			}
+			n++;
+		}
+	}
+	if (n != 8){
+		fprintf(stderr, "Error: Function nn_poll Has Lost Requests!\n");
+	}
+	destroy_inference_queue(queue);
+
+	//===Callback Completion With Retries On Backpressure===//
+	atomic_init(&(completion.num_completed), 0);
+	queue = create_inference_queue(network, NULL, 4, 4, test_inference_callback, &completion);
+	for (i=0; i<32; i++){
+		while (nn_submit(queue, inputs[i], i) == INFERENCE_QUEUE_FULL){
+			sched_yield();
+		}
+	}
+	for (n=0; n<100000 && atomic_load(&(completion.num_completed)) < 32; n++){
+		sched_yield();
+	}
+	for (i=0; i<32; i++){
+		feed_forward(network, inputs[i]);
+		if (fabs(completion.output[i][0] - network->output[0]) > 1e-12){
+			fprintf(stderr, "Error: Function create_inference_queue Callback Does Not Match feed_forward!\n");
+			break;
+		}
+	}
+	destroy_inference_queue(queue);
+
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
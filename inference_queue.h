@@ -0,0 +1,206 @@
+#ifndef INFERENCE_QUEUE_H
+#define INFERENCE_QUEUE_H
+
+#include <stddef.h>
+#include <sys/eventfd.h>
+#include <semaphore.h>
+#include "thread_pool.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_INFERENCE_BATCH 256
+#define INFERENCE_QUEUE_FULL 1
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+typedef void (*inference_callback_t)(uint64_t, double*, unsigned int, void*);
+
+
+//================================================================================================//
+/** @struct slot_ring_t
+*   @brief This structure comprises a bounded lock-free queue of request slot indices.
+*
+*	Each cell carries a sequence number that says whether it is ready to be written or read, so
+*	any number of producers and consumers may use it. The capacity is a power of two.
+*/
+//================================================================================================//
+typedef struct slot_ring_cell_s slot_ring_cell_t;
+typedef struct slot_ring_cell_s{
+	atomic_size_t sequence;
+	unsigned int slot;
+} slot_ring_cell_t;
+
+typedef struct slot_ring_s slot_ring_t;
+typedef struct slot_ring_s{
+	atomic_size_t enqueue_position;
+	char enqueue_padding[WEIGHT_ALIGNMENT - sizeof(size_t)];
+	atomic_size_t dequeue_position;
+	char dequeue_padding[WEIGHT_ALIGNMENT - sizeof(size_t)];
+	slot_ring_cell_t* cell;
+	size_t mask;
+} slot_ring_t;
+
+
+//================================================================================================//
+/** @struct inference_queue_t
+*   @brief This structure comprises an asynchronous inference front end for one network.
+*
+*	Requests live in capacity preallocated slots, which bounds the queue depth. A submitted slot
+*	goes on the request ring, whose only consumer is the dispatcher thread. The dispatcher takes
+*	up to max_batch requests at a time, evaluates them on the thread pool, and either calls the
+*	callback and frees the slots, or puts them on the completion ring and signals event_fd.
+*/
+//================================================================================================//
+typedef struct inference_queue_s inference_queue_t;
+typedef struct inference_queue_s{
+	slot_ring_t free_slots;
+	slot_ring_t requests;
+	slot_ring_t completions;
+	sem_t pending;
+	pthread_t dispatcher;
+	neural_network_t* network;
+	thread_pool_t* pool;
+	neural_context_t* contexts[MAX_INFERENCE_BATCH];
+	unsigned int batch[MAX_INFERENCE_BATCH];
+	unsigned int batch_size;
+	double* inputs;
+	double* outputs;
+	uint64_t* tags;
+	inference_callback_t callback;
+	void* user_data;
+	int event_fd;
+	int dispatcher_started;
+	unsigned int capacity;
+	unsigned int max_batch;
+	unsigned int num_inputs;
+	unsigned int num_outputs;
+	atomic_int shutdown;
+} inference_queue_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates an inference_queue_t object and starts its dispatcher.
+*
+* capacity is rounded up to a power of two. With a callback, completions are delivered by
+* calling it on the dispatcher thread; the output pointer is only valid during the call.
+* Otherwise they are collected with nn_poll once nn_completion_fd is readable. A NULL pool uses
+* the shared thread pool. The network must not be trained while the queue is running.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] thread_pool_t* pool
+* @param[in] unsigned int capacity
+* @param[in] unsigned int max_batch
+* @param[in] inference_callback_t callback (may be NULL)
+* @param[in] void* user_data
+*
+* @return inference_queue_t* self
+*/
+//================================================================================================//
+inference_queue_t* create_inference_queue( neural_network_t* network,
+										   thread_pool_t* pool,
+										   unsigned int capacity,
+										   unsigned int max_batch,
+										   inference_callback_t callback,
+										   void* user_data );
+
+
+//================================================================================================//
+/**
+* @brief This function stops the dispatcher and frees an inference_queue_t object.
+*
+* Requests not yet completed are dropped.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_queue_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_inference_queue( inference_queue_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function queues one input for inference without blocking.
+*
+* Any thread may submit. The input is copied. When all slots are in use the request is refused
+* with INFERENCE_QUEUE_FULL; poll completions (or let callbacks run) and submit again.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_queue_t* self
+* @param[in] double* input
+* @param[in] uint64_t tag
+*
+* @return int status (0 queued, INFERENCE_QUEUE_FULL, -1 on error)
+*/
+//================================================================================================//
+int nn_submit( inference_queue_t* self,
+			   double* input,
+			   uint64_t tag );
+
+
+//================================================================================================//
+/**
+* @brief This function takes one completed request without blocking.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] inference_queue_t* self
+* @param[out] uint64_t* tag
+* @param[out] double* output
+*
+* @return int num_completed (1 if a request was taken, 0 if none is ready)
+*/
+//================================================================================================//
+int nn_poll( inference_queue_t* self,
+			 uint64_t* tag,
+			 double* output );
+
+
+//================================================================================================//
+/**
+* @brief This function returns the eventfd that becomes readable when completions are ready.
+*
+* Reading it clears the count; then call nn_poll until it returns 0.
+*
+* If errors occur, the function exits.
+*
+* @param[in] inference_queue_t* self
+*
+* @return int fd
+*/
+//================================================================================================//
+int nn_completion_fd( inference_queue_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests submit and poll, backpressure and callback completion.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_inference_queue();
+
+
+
+#endif //INFERENCE_QUEUE_H//
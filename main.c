@@ -7,13 +7,49 @@
 #include <float.h>
 #include "neural_network.h"
 #include "helper.h"
+#include "random.h"
+#include "weight_publisher.h"
+#include "checkpoint.h"
+#include "sparse.h"
+#include "backend.h"
+#include "autotune.h"
+#include "data_parallel.h"
+#include "pipeline.h"
+#include "thread_pool.h"
+#include "model_parallel.h"
+#include "inference_queue.h"
+#include "inference_cache.h"
+#include "mixed_precision.h"
+#include "compressed_weights.h"
+#include "cascade.h"
+#include "distillation.h"
+#include "model_registry.h"
 
 
 int main(void)
 {
 
 	#if UNIT_TESTS	
+		test_random_stream();
+		test_compute_backends();
+		test_autotuner();
 		test_neural_network();
+		test_weight_publisher();
+		test_checkpoint_writer();
+		test_sparse_input();
+		test_pruning();
+		test_data_parallel();
+		test_pipeline();
+		test_thread_pool();
+		test_model_parallelism();
+		test_inference_queue();
+		test_inference_cache();
+		test_mixed_precision();
+		test_compressed_weights();
+		test_cascade();
+		test_distillation();
+		test_model_registry();
+		test_tracing();
 	#else
 
 		unsigned int num_nodes[MAX_LAYERS];
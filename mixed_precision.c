@@ -0,0 +1,397 @@
+#include "mixed_precision.h"
+#include "model_parallel.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//=======================================Helper Functions=========================================//
+//================================================================================================//
+
+//===Bit Test, Since -Ofast Assumes isfinite Is Always True===//
+static inline int float_is_finite( float value )
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(uint32_t));
+	return (bits & 0x7F800000) != 0x7F800000;
+}
+
+//================================================================================================//
+//=====================================Precision Functions========================================//
+//================================================================================================//
+
+int set_mixed_precision( neural_network_t* network,
+						 int enable,
+						 unsigned int cast_interval,
+						 double loss_scale,
+						 int dynamic_loss_scale )
+{
+	unsigned int l;
+	size_t state_size, max_nodes;
+	float* state;
+	mixed_precision_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- set_mixed_precision\n");
+		return -1;
+	}
+	if (loss_scale < 0 || isnan(loss_scale)){
+		fprintf(stderr, "Error:: Loss Scale Is Invalid! In Function -- set_mixed_precision\n");
+		return -1;
+	}
+	if (enable && network->model_parallel != NULL){
+		fprintf(stderr, "Error:: Network Is Model Parallel! In Function -- set_mixed_precision\n");
+		return -1;
+	}
+
+	//===Replace Any Existing Copies===//
+	if (network->mixed_precision != NULL){
+		destroy_mixed_precision(network->mixed_precision);
+		network->mixed_precision = NULL;
+	}
+	if (!enable){
+		return 0;
+	}
+
+	self = malloc(sizeof(mixed_precision_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Mixed Precision Was Not Allocated! In Function -- set_mixed_precision\n");
+		return -1;
+	}
+	self->network = network;
+	self->cast_interval = (cast_interval == 0) ? 1 : cast_interval;
+	self->loss_scale = (loss_scale == 0) ? 1.0 : loss_scale;
+	self->dynamic_loss_scale = dynamic_loss_scale;
+	self->steps_since_cast = 0;
+	self->clean_steps = 0;
+	self->num_skipped = 0;
+
+	//===Float Activations (With Bias Slot) And Deltas Of Every Layer, Then One Product Row===//
+	state_size = 0;
+	max_nodes = 0;
+	for (l=0; l<network->num_hidden_layers+2; l++){
+		state_size += 2*(size_t)network->layer[l].num_nodes + 1;
+		max_nodes = MAX(max_nodes, network->layer[l].num_nodes);
+	}
+	state_size += max_nodes;
+
+	self->weight_arena = aligned_alloc(WEIGHT_ALIGNMENT, round_up(network->arena_size * sizeof(float), WEIGHT_ALIGNMENT));
+	self->gradient_arena = aligned_alloc(WEIGHT_ALIGNMENT, round_up(network->arena_size * sizeof(float), WEIGHT_ALIGNMENT));
+	self->state_arena = aligned_alloc(WEIGHT_ALIGNMENT, round_up(state_size * sizeof(float), WEIGHT_ALIGNMENT));
+	if (self->weight_arena == NULL || self->gradient_arena == NULL || self->state_arena == NULL){
+		fprintf(stderr, "Error:: Float Arenas Were Not Allocated! In Function -- set_mixed_precision\n");
+		free(self->weight_arena);
+		free(self->gradient_arena);
+		free(self->state_arena);
+		free(self);
+		return -1;
+	}
+	memset(self->gradient_arena, 0, network->arena_size * sizeof(float));
+	memset(self->state_arena, 0, state_size * sizeof(float));
+
+	state = self->state_arena;
+	for (l=0; l<network->num_hidden_layers+2; l++){
+		self->activation[l] = state;
+		state += network->layer[l].num_nodes + 1;
+		self->delta[l] = state;
+		state += network->layer[l].num_nodes;
+	}
+	self->product = state;
+
+	cast_mixed_precision_weights(self);
+	network->mixed_precision = self;
+
+	return 0;
+}
+
+void cast_mixed_precision_weights( mixed_precision_t* self )
+{
+	size_t i;
+	double* weights;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Mixed Precision Is NULL! In Function -- cast_mixed_precision_weights\n");
+		return;
+	}
+
+	weights = self->network->weight_arena;
+	for (i=0; i<self->network->arena_size; i++){
+		self->weight_arena[i] = (float)weights[i];
+	}
+	self->known_version = get_weight_version(self->network);
+	self->steps_since_cast = 0;
+
+	return;
+}
+
+void mixed_precision_feed_forward( mixed_precision_t* self,
+								   neural_context_t* context )
+{
+	unsigned int l, i, output_layer, num_columns;
+	neural_layer_t* layer;
+	layer_state_t* state;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- mixed_precision_feed_forward\n");
+		return;
+	}
+	network = self->network;
+	output_layer = network->num_hidden_layers+1;
+
+	//===Weights Changed Behind The Float Copies===//
+	if (get_weight_version(network) != self->known_version){
+		cast_mixed_precision_weights(self);
+	}
+
+	for (l=0; l<=output_layer; l++){
+		layer = &(network->layer[l]);
+		state = &(context->layer[l]);
+
+		//===Activations In Double===//
+		layer->backend->activate[layer->activation](state->input, state->activation, state->derivative, layer->num_nodes);
+		state->activation[layer->num_nodes] = 1;
+		if (l == output_layer){
+			break;
+		}
+
+		//===Product In Float, Widened Into The Next Layer's Input===//
+		num_columns = layer->next_layer->num_nodes;
+		for (i=0; i<=layer->num_nodes; i++){
+			self->activation[l][i] = (float)state->activation[i];
+		}
+		layer->operation_backend[LAYER_OPERATION_FORWARD]->sgemm(1, num_columns, layer->num_nodes+1, 1.0f,
+																  self->activation[l], layer->num_nodes+1,
+																  self->weight_arena + (layer->weight_matrix - network->weight_arena),
+																  layer->leading_dimension, 0, self->product, num_columns);
+		for (i=0; i<num_columns; i++){
+			context->layer[l+1].input[i] = self->product[i];
+		}
+	}
+
+	return;
+}
+
+void mixed_precision_back_propagate( mixed_precision_t* self,
+									 neural_context_t* context )
+{
+	unsigned int l, i, output_layer;
+	float scale;
+	neural_layer_t *layer, *previous;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- mixed_precision_back_propagate\n");
+		return;
+	}
+	network = self->network;
+	output_layer = network->num_hidden_layers+1;
+
+	//===Scale The Error Up Before It Meets Float Products===//
+	scale = (float)self->loss_scale;
+	for (i=0; i<network->layer[output_layer].num_nodes; i++){
+		self->delta[output_layer][i] = scale * (float)context->layer[output_layer].delta[i];
+	}
+
+	//===The Input Layer Needs No Delta===//
+	for (l=output_layer; l>1; l--){
+		layer = &(network->layer[l]);
+		previous = layer->previous_layer;
+		previous->operation_backend[LAYER_OPERATION_BACKWARD]->sgemv(previous->num_nodes, layer->num_nodes, 1.0f,
+																	 self->weight_arena + (previous->weight_matrix - network->weight_arena),
+																	 previous->leading_dimension, self->delta[l], 0, self->delta[l-1]);
+		for (i=0; i<previous->num_nodes; i++){
+			self->delta[l-1][i] *= (float)context->layer[l-1].derivative[i];
+		}
+
+		//===Unscaled Double Copy For Tracing And Anything Else Reading The Context===//
+		for (i=0; i<previous->num_nodes; i++){
+			context->layer[l-1].delta[i] = (double)self->delta[l-1][i] / scale;
+		}
+	}
+
+	return;
+}
+
+int mixed_precision_update_weights( mixed_precision_t* self,
+									neural_context_t* context )
+{
+	unsigned int l;
+	size_t i, size;
+	double step, *weights;
+	float* gradient;
+	neural_layer_t* layer;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- mixed_precision_update_weights\n");
+		return -1;
+	}
+	network = self->network;
+
+	//===Float Gradients, Checked For Overflow Before Any Weight Moves===//
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		layer = &(network->layer[l]);
+		gradient = self->gradient_arena + (layer->weight_matrix - network->weight_arena);
+		layer->operation_backend[LAYER_OPERATION_UPDATE]->sgemm(layer->num_nodes+1, layer->next_layer->num_nodes, 1, 1.0f,
+																 self->activation[l], 1, self->delta[l+1],
+																 layer->next_layer->num_nodes, 0, gradient,
+																 layer->leading_dimension);
+		size = (size_t)(layer->num_nodes+1) * layer->leading_dimension;
+		for (i=0; i<size; i++){
+			if (!float_is_finite(gradient[i])){
+				self->num_skipped++;
+				self->clean_steps = 0;
+				if (self->dynamic_loss_scale){
+					self->loss_scale *= 0.5;
+				}
+				return 1;
+			}
+		}
+	}
+
+	//===Accumulate Into The Double Master Weights===//
+	step = -network->learning_rate / self->loss_scale;
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		layer = &(network->layer[l]);
+		weights = layer->weight_matrix;
+		gradient = self->gradient_arena + (layer->weight_matrix - network->weight_arena);
+		size = (size_t)(layer->num_nodes+1) * layer->leading_dimension;
+		for (i=0; i<size; i++){
+			weights[i] += step * gradient[i];
+		}
+		if (layer->weight_mask != NULL){
+			matrix_mask(layer->weight_matrix, layer->num_nodes+1, layer->leading_dimension, layer->weight_mask);
+			if (layer->sparse_weights != NULL){
+				refresh_sparse_weights(layer);
+			}
+		}
+	}
+	mark_weights_changed(network);
+	self->known_version = get_weight_version(network);
+
+	//===Cast Down Periodically; Grow The Scale After A Clean Window===//
+	self->steps_since_cast++;
+	if (self->steps_since_cast >= self->cast_interval){
+		cast_mixed_precision_weights(self);
+	}
+	if (self->dynamic_loss_scale){
+		self->clean_steps++;
+		if (self->clean_steps >= MIXED_PRECISION_SCALE_WINDOW){
+			self->loss_scale *= 2;
+			self->clean_steps = 0;
+		}
+	}
+
+	return 0;
+}
+
+void destroy_mixed_precision( mixed_precision_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Mixed Precision Is NULL! In Function -- destroy_mixed_precision\n");
+		return;
+	}
+	free(self->weight_arena);
+	free(self->gradient_arena);
+	free(self->state_arena);
+	free(self);
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_mixed_precision()
+{
+	unsigned int i, j, l, n, num_nodes[4];
+	double input[6], label[3], difference;
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *reference;
+
+	num_nodes[0] = 6; num_nodes[1] = 20; num_nodes[2] = 11; num_nodes[3] = 3;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->activation[1] = ACTIVATION_TANH;
+	parameters->activation[3] = ACTIVATION_SOFTMAX;
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	network = create_neural_network(parameters);
+	reference = create_neural_network(parameters);
+	if (set_mixed_precision(network, 1, 0, 1024, 1) != 0){
+		fprintf(stderr, "Error: Function set_mixed_precision Has Failed!\n");
+		destroy_neural_network(network);
+		destroy_neural_network(reference);
+		free(parameters);
+		return;
+	}
+
+	//===Same Start, Same Data: Float Products Stay Close To Double Training===//
+	for (n=0; n<300; n++){
+		for (i=0; i<6; i++){
+			input[i] = sin(0.37*n + 1.3*i);
+		}
+		memset(label, 0, sizeof(label));
+		label[n%3] = 1;
+		iterate_network(network, input, label);
+		iterate_network(reference, input, label);
+	}
+	difference = 0;
+	for (i=0; i<reference->arena_size; i++){
+		difference = MAX(difference, fabs(reference->weight_arena[i] - network->weight_arena[i]));
+	}
+	if (difference > 1e-4 || network->mixed_precision->num_skipped != 0){
+		fprintf(stderr, "Error: Function mixed_precision_update_weights Drifted By %g!\n", difference);
+	}
+	feed_forward(network, input);
+	feed_forward(reference, input);
+	for (j=0; j<3; j++){
+		if (fabs(network->output[j] - reference->output[j]) > 1e-4){
+			fprintf(stderr, "Error: Function mixed_precision_feed_forward Does Not Match feed_forward!\n");
+			break;
+		}
+	}
+
+	//===Hidden Deltas Reach The Context Unscaled===//
+	back_propagate(network, label);
+	back_propagate(reference, label);
+	for (l=1; l<3; l++){
+		for (j=0; j<num_nodes[l]; j++){
+			if (fabs(network->context->layer[l].delta[j] - reference->context->layer[l].delta[j]) > 1e-5){
+				fprintf(stderr, "Error: Function mixed_precision_back_propagate Did Not Widen Layer %u Deltas!\n", l);
+				l = 3;
+				break;
+			}
+		}
+	}
+
+	//===A Scale Beyond Float Range Is Skipped And Halved Until Updates Go Through===//
+	set_mixed_precision(network, 1, 4, 1e39, 1);
+	memcpy(reference->weight_arena, network->weight_arena, network->arena_size * sizeof(double));
+	iterate_network(network, input, label);
+	if (network->mixed_precision->num_skipped == 0 || network->mixed_precision->loss_scale >= 1e39){
+		fprintf(stderr, "Error: Function mixed_precision_update_weights Did Not Skip An Overflow!\n");
+	}
+	for (i=0; i<reference->arena_size; i++){
+		if (reference->weight_arena[i] != network->weight_arena[i]){
+			fprintf(stderr, "Error: Function mixed_precision_update_weights Applied An Overflowing Update!\n");
+			break;
+		}
+	}
+	for (n=0; n<200 && network->mixed_precision->num_skipped == (uint64_t)n+1; n++){
+		iterate_network(network, input, label);
+	}
+	if (n == 200){
+		fprintf(stderr, "Error: Function mixed_precision_update_weights Never Recovered!\n");
+	}
+
+	//===Disabling Restores Double Passes===//
+	if (set_mixed_precision(network, 0, 0, 0, 0) != 0 || network->mixed_precision != NULL){
+		fprintf(stderr, "Error: Function set_mixed_precision Did Not Restore Double Passes!\n");
+	}
+
+	destroy_neural_network(network);
+	destroy_neural_network(reference);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,175 @@
+#ifndef MIXED_PRECISION_H
+#define MIXED_PRECISION_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MIXED_PRECISION_SCALE_WINDOW 2000
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct mixed_precision_t
+*   @brief This structure comprises the float copies a network trains with in mixed precision.
+*
+*	weight_arena holds float casts of the network's weights in the same layout, so a layer's
+*	float matrix sits at the same offset as its double one. Products run in float on those
+*	copies; activation kernels and the output error stay in double on the context. Gradients
+*	are computed in float, scaled by loss_scale, and accumulated into the double weights, which
+*	are cast down again every cast_interval updates. With dynamic_loss_scale set, an update whose
+*	gradient overflows is skipped and halves the scale, and every MIXED_PRECISION_SCALE_WINDOW
+*	clean updates double it. known_version is the weight version the float copies follow; any
+*	other change of the weights forces a fresh cast.
+*/
+//================================================================================================//
+typedef struct mixed_precision_s mixed_precision_t;
+typedef struct mixed_precision_s{
+	neural_network_t* network;
+	float* weight_arena;
+	float* gradient_arena;
+	float* state_arena;
+	float* activation[MAX_LAYERS];
+	float* delta[MAX_LAYERS];
+	float* product;
+	double loss_scale;
+	int dynamic_loss_scale;
+	unsigned int cast_interval;
+	unsigned int steps_since_cast;
+	unsigned int clean_steps;
+	uint64_t num_skipped;
+	uint64_t known_version;
+} mixed_precision_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function makes a network train and infer in mixed precision, or back in double.
+*
+* feed_forward, back_propagate and update_weights then run their products in float. A
+* cast_interval of 0 means 1. A loss_scale of 0 means no scaling. A network that is split with
+* set_model_parallelism cannot also be mixed. Passing enable as 0 restores double passes.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* network
+* @param[in] int enable
+* @param[in] unsigned int cast_interval
+* @param[in] double loss_scale
+* @param[in] int dynamic_loss_scale
+*
+* @return int status (0 on success, -1 on error)
+*/
+//================================================================================================//
+int set_mixed_precision( neural_network_t* network,
+						 int enable,
+						 unsigned int cast_interval,
+						 double loss_scale,
+						 int dynamic_loss_scale );
+
+
+//================================================================================================//
+/**
+* @brief This function casts the double weights down into the float copies.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] mixed_precision_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void cast_mixed_precision_weights( mixed_precision_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function runs the forward pass in mixed precision; context->input must be set.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] mixed_precision_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void mixed_precision_feed_forward( mixed_precision_t* self,
+								   neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function propagates the output error back through the float weights.
+*
+* The output layer's delta must already hold the error. Hidden deltas are kept in float,
+* multiplied by the loss scale; the context's hidden delta buffers are not written.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] mixed_precision_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void mixed_precision_back_propagate( mixed_precision_t* self,
+									 neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function accumulates the float gradients into the double weights.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] mixed_precision_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return int status (0 if applied, 1 if skipped for overflow)
+*/
+//================================================================================================//
+int mixed_precision_update_weights( mixed_precision_t* self,
+									neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a mixed_precision_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] mixed_precision_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_mixed_precision( mixed_precision_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests mixed precision against double training, and loss scaling.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_mixed_precision();
+
+
+
+#endif //MIXED_PRECISION_H//
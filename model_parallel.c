@@ -0,0 +1,364 @@
+#include "model_parallel.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//======================================Slice Functions===========================================//
+//================================================================================================//
+
+//===Whole SIMD_WIDTH Slices Keep Threads Off Each Other's Cache Lines===//
+static void partition_range( unsigned int* start,
+							 unsigned int size,
+							 unsigned int num_threads,
+							 int split )
+{
+	unsigned int t, chunk;
+
+	chunk = size;
+	if (split){
+		chunk = (size + num_threads - 1)/num_threads;
+		chunk = round_up(chunk, SIMD_WIDTH);
+	}
+	for (t=0; t<=num_threads; t++){
+		start[t] = MIN(t*chunk, size);
+	}
+
+	return;
+}
+
+static void feed_forward_slices( void* argument,
+								 unsigned int begin,
+								 unsigned int end )
+{
+	unsigned int s, first, last;
+	model_parallel_t* self;
+	neural_layer_t *layer, *next;
+	layer_state_t *state, *next_state;
+
+	self = (model_parallel_t*)argument;
+	layer = &(self->network->layer[self->layer]);
+	next = layer->next_layer;
+	state = &(self->context->layer[self->layer]);
+	next_state = &(self->context->layer[self->layer+1]);
+
+	for (s=begin; s<end; s++){
+
+		//===This Slice's Columns Of The Next Layer's Input===//
+		if (layer->use_sparse_weights){
+			first = 0;
+			last = (s == 0) ? next->num_nodes : 0;
+			if (last > first){
+				csr_vector_matrix_multiply(state->activation, layer->sparse_weights, next_state->input);
+			}
+		}
+		else{
+			first = self->column_start[self->layer][s];
+			last = self->column_start[self->layer][s+1];
+			if (last > first){
+				vector_matrix_multiply(layer->operation_backend[LAYER_OPERATION_FORWARD], state->activation, layer->num_nodes+1,
+									   layer->weight_matrix + first, layer->num_nodes+1, last - first,
+									   layer->leading_dimension, next_state->input + first);
+			}
+		}
+
+		//===Elementwise Activations Stay In The Slice; Softmax Waits For The Whole Output===//
+		if (last > first && next->activation != ACTIVATION_SOFTMAX){
+			next->backend->activate[next->activation](next_state->input + first, next_state->activation + first,
+													  next_state->derivative + first, last - first);
+		}
+	}
+
+	return;
+}
+
+static void back_propagate_slices( void* argument,
+								   unsigned int begin,
+								   unsigned int end )
+{
+	unsigned int s, i, first, last;
+	model_parallel_t* self;
+	neural_layer_t *layer, *previous;
+	layer_state_t *state, *previous_state;
+
+	self = (model_parallel_t*)argument;
+	layer = &(self->network->layer[self->layer]);
+	previous = layer->previous_layer;
+	state = &(self->context->layer[self->layer]);
+	previous_state = &(self->context->layer[self->layer-1]);
+
+	//===This Slice's Rows Of The Previous Layer's Delta===//
+	for (s=begin; s<end; s++){
+		first = self->row_start[self->layer-1][s];
+		last = self->row_start[self->layer-1][s+1];
+		if (last > first){
+			matrix_vector_multiply(previous->operation_backend[LAYER_OPERATION_BACKWARD], state->delta, layer->num_nodes,
+								   previous->weight_matrix + (size_t)first*previous->leading_dimension, last - first,
+								   layer->num_nodes, previous->leading_dimension, previous_state->delta + first);
+			for (i=first; i<last; i++){
+				previous_state->delta[i] *= previous_state->derivative[i];
+			}
+		}
+	}
+
+	return;
+}
+
+static void update_weight_slices( void* argument,
+								  unsigned int begin,
+								  unsigned int end )
+{
+	unsigned int s, l, r, c, first, last;
+	double *weights, *update, *mask;
+	model_parallel_t* self;
+	neural_layer_t* layer;
+
+	self = (model_parallel_t*)argument;
+	for (s=begin; s<end; s++){
+		for (l=0; l<self->network->num_hidden_layers+1; l++){
+			layer = &(self->network->layer[l]);
+			first = self->column_start[l][s];
+			last = self->column_start[l][s+1];
+			if (last <= first){
+				continue;
+			}
+
+			//===Gradient Columns, Then The Same Columns Of Every Weight Row===//
+			matrix_matrix_multiply(layer->operation_backend[LAYER_OPERATION_UPDATE], self->context->layer[l].activation,
+								   layer->num_nodes+1, 1, self->context->layer[l+1].delta + first, 1, last - first,
+								   layer->leading_dimension, layer->weight_update + first);
+			for (r=0; r<layer->num_nodes+1; r++){
+				weights = layer->weight_matrix + (size_t)r*layer->leading_dimension + first;
+				update = layer->weight_update + (size_t)r*layer->leading_dimension + first;
+				layer->operation_backend[LAYER_OPERATION_UPDATE]->axpy(last - first, -(*layer->learning_rate), update, weights);
+				if (layer->weight_mask != NULL){
+					mask = layer->weight_mask + (size_t)r*layer->leading_dimension + first;
+					for (c=0; c<last-first; c++){
+						weights[c] *= mask[c];
+					}
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+//================================================================================================//
+//======================================Model Functions===========================================//
+//================================================================================================//
+
+int set_model_parallelism( neural_network_t* network,
+						   thread_pool_t* pool,
+						   unsigned int num_slices,
+						   unsigned int min_columns )
+{
+	unsigned int l, num_rows, num_columns;
+	model_parallel_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- set_model_parallelism\n");
+		return -1;
+	}
+	if (num_slices > MAX_MODEL_PARALLEL_SLICES){
+		fprintf(stderr, "Error:: Too Many Slices! In Function -- set_model_parallelism\n");
+		return -1;
+	}
+	if (num_slices > 1 && network->mixed_precision != NULL){
+		fprintf(stderr, "Error:: Network Is Mixed Precision! In Function -- set_model_parallelism\n");
+		return -1;
+	}
+
+	//===Replace Any Existing Split===//
+	if (network->model_parallel != NULL){
+		destroy_model_parallel(network->model_parallel);
+		network->model_parallel = NULL;
+	}
+	if (num_slices <= 1){
+		return 0;
+	}
+
+	self = malloc(sizeof(model_parallel_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Split Was Not Allocated! In Function -- set_model_parallelism\n");
+		return -1;
+	}
+	self->pool = (pool != NULL) ? pool : get_thread_pool();
+	self->network = network;
+	self->context = network->context;
+	self->layer = 0;
+	self->num_slices = num_slices;
+	self->min_columns = (min_columns == 0) ? MODEL_PARALLEL_MIN_COLUMNS : min_columns;
+
+	//===Split Wide Matrices: Columns Going Forward, Rows Going Backward===//
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		num_rows = network->layer[l].num_nodes;
+		num_columns = network->layer[l+1].num_nodes;
+		partition_range(self->column_start[l], num_columns, num_slices, num_columns >= self->min_columns);
+		partition_range(self->row_start[l], num_rows, num_slices, num_rows >= self->min_columns);
+	}
+	network->model_parallel = self;
+
+	return 0;
+}
+
+void model_parallel_feed_forward( model_parallel_t* self,
+								  neural_context_t* context )
+{
+	unsigned int l, output_layer;
+	neural_layer_t* layer;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- model_parallel_feed_forward\n");
+		return;
+	}
+	network = self->network;
+	output_layer = network->num_hidden_layers+1;
+
+	//===Input Activation And Bias Units Before The Slices Run===//
+	layer = &(network->layer[0]);
+	layer->backend->activate[layer->activation](context->layer[0].input, context->layer[0].activation,
+												context->layer[0].derivative, layer->num_nodes);
+	for (l=0; l<=output_layer; l++){
+		context->layer[l].activation[network->layer[l].num_nodes] = 1;
+	}
+
+	//===One Fork-Join Per Layer===//
+	self->context = context;
+	for (l=0; l<output_layer; l++){
+		self->layer = l;
+		parallel_for(self->pool, 0, self->num_slices, 1, feed_forward_slices, self);
+	}
+
+	layer = &(network->layer[output_layer]);
+	if (layer->activation == ACTIVATION_SOFTMAX){
+		layer->backend->activate[layer->activation](context->layer[output_layer].input, context->layer[output_layer].activation,
+													context->layer[output_layer].derivative, layer->num_nodes);
+	}
+
+	return;
+}
+
+void model_parallel_back_propagate( model_parallel_t* self,
+									neural_context_t* context )
+{
+	unsigned int l;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- model_parallel_back_propagate\n");
+		return;
+	}
+
+	//===The Input Layer Needs No Delta===//
+	self->context = context;
+	for (l=self->network->num_hidden_layers+1; l>1; l--){
+		self->layer = l;
+		parallel_for(self->pool, 0, self->num_slices, 1, back_propagate_slices, self);
+	}
+
+	return;
+}
+
+void model_parallel_update_weights( model_parallel_t* self,
+									neural_context_t* context )
+{
+	unsigned int l;
+	neural_network_t* network;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- model_parallel_update_weights\n");
+		return;
+	}
+	self->context = context;
+	parallel_for(self->pool, 0, self->num_slices, 1, update_weight_slices, self);
+	mark_weights_changed(self->network);
+
+	//===Sparse Copies Of Pruned Layers Follow The Masked Weights===//
+	network = self->network;
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		if (network->layer[l].weight_mask != NULL && network->layer[l].sparse_weights != NULL){
+			refresh_sparse_weights(&(network->layer[l]));
+		}
+	}
+
+	return;
+}
+
+void destroy_model_parallel( model_parallel_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Split Is NULL! In Function -- destroy_model_parallel\n");
+		return;
+	}
+	free(self);
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_model_parallelism()
+{
+	unsigned int i, j, n, num_nodes[5];
+	double input[5], label[4];
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *serial;
+	thread_pool_t* pool;
+
+	//===Layers Wide Enough To Split At 64 Columns, With A Softmax Output===//
+	num_nodes[0] = 5; num_nodes[1] = 300; num_nodes[2] = 70; num_nodes[3] = 260; num_nodes[4] = 4;
+	parameters = create_neural_network_parameters(3, num_nodes, 0.1);
+	parameters->activation[2] = ACTIVATION_TANH;
+	parameters->activation[4] = ACTIVATION_SOFTMAX;
+	network = create_neural_network(parameters);
+	serial = create_neural_network(parameters);
+	pool = create_thread_pool(2, 0);
+	if (pool == NULL || set_model_parallelism(network, pool, 3, 64) != 0){
+		fprintf(stderr, "Error: Function set_model_parallelism Has Failed!\n");
+		if (pool != NULL){
+			destroy_thread_pool(pool);
+		}
+		destroy_neural_network(network);
+		destroy_neural_network(serial);
+		free(parameters);
+		return;
+	}
+
+	//===Train Both The Same Way===//
+	for (n=0; n<24; n++){
+		for (i=0; i<5; i++){
+			input[i] = sin(0.7*n + i);
+		}
+		memset(label, 0, sizeof(label));
+		label[n%4] = 1;
+		iterate_network(network, input, label);
+		iterate_network(serial, input, label);
+		for (j=0; j<4; j++){
+			if (fabs(network->output[j] - serial->output[j]) > 1e-10){
+				fprintf(stderr, "Error: Function model_parallel_feed_forward Does Not Match feed_forward!\n");
+				n = 24;
+				break;
+			}
+		}
+	}
+	for (i=0; i<serial->arena_size; i++){
+		if (fabs(serial->weight_arena[i] - network->weight_arena[i]) > 1e-10){
+			fprintf(stderr, "Error: Function model_parallel_update_weights Does Not Match update_weights!\n");
+			break;
+		}
+	}
+
+	//===One Slice Restores Serial Passes===//
+	if (set_model_parallelism(network, NULL, 1, 0) != 0 || network->model_parallel != NULL){
+		fprintf(stderr, "Error: Function set_model_parallelism Did Not Restore Serial Passes!\n");
+	}
+
+	destroy_neural_network(network);
+	destroy_neural_network(serial);
+	destroy_thread_pool(pool);
+	free(parameters);
+
+	return;
+}
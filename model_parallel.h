@@ -0,0 +1,150 @@
+#ifndef MODEL_PARALLEL_H
+#define MODEL_PARALLEL_H
+
+#include "thread_pool.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_MODEL_PARALLEL_SLICES 64
+#define MODEL_PARALLEL_MIN_COLUMNS 512
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct model_parallel_t
+*   @brief This structure comprises the split of a network's wide weight matrices into slices.
+*
+*	Slice s covers columns column_start[l][s] to column_start[l][s+1] of weight matrix l for the
+*	forward and update products, and rows row_start[l][s] to row_start[l][s+1] for the backward
+*	product, so no partial sums are ever combined. Slices are whole multiples of SIMD_WIDTH, so
+*	they never write the same cache line. A matrix narrower than min_columns (or rows) is one
+*	slice. Each layer is one parallel_for over the slices on the thread pool, whose join is the
+*	layer's barrier.
+*/
+//================================================================================================//
+typedef struct model_parallel_s model_parallel_t;
+typedef struct model_parallel_s{
+	thread_pool_t* pool;
+	neural_network_t* network;
+	neural_context_t* context;
+	unsigned int layer;
+	unsigned int num_slices;
+	unsigned int min_columns;
+	unsigned int column_start[MAX_LAYERS][MAX_MODEL_PARALLEL_SLICES+1];
+	unsigned int row_start[MAX_LAYERS][MAX_MODEL_PARALLEL_SLICES+1];
+} model_parallel_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function splits a network's wide layers into num_slices slices run on a thread pool.
+*
+* feed_forward, back_propagate and update_weights then run the slices in parallel. Weight
+* matrices with at least min_columns columns (rows for the backward product) are split; 0 uses
+* MODEL_PARALLEL_MIN_COLUMNS. A NULL pool uses the shared thread pool. One slice (or zero)
+* restores serial passes.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* network
+* @param[in] thread_pool_t* pool
+* @param[in] unsigned int num_slices
+* @param[in] unsigned int min_columns
+*
+* @return int status (0 on success)
+*/
+//================================================================================================//
+int set_model_parallelism( neural_network_t* network,
+						   thread_pool_t* pool,
+						   unsigned int num_slices,
+						   unsigned int min_columns );
+
+
+//================================================================================================//
+/**
+* @brief This function runs a forward pass over the slices; the input must already be in the context.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_parallel_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void model_parallel_feed_forward( model_parallel_t* self,
+								  neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function back propagates the context's output error over the slices.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_parallel_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void model_parallel_back_propagate( model_parallel_t* self,
+									neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function applies the context's weight updates over the slices.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_parallel_t* self
+* @param[in] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void model_parallel_update_weights( model_parallel_t* self,
+									neural_context_t* context );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a model_parallel_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_parallel_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_model_parallel( model_parallel_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests model parallel training against serial training.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_model_parallelism();
+
+
+
+#endif //MODEL_PARALLEL_H//
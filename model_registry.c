@@ -0,0 +1,590 @@
+#include "model_registry.h"
+#include "backend.h"
+#include "helper.h"
+
+//================================================================================================//
+//=======================================Helper Functions=========================================//
+//================================================================================================//
+
+static int copy_registry_name( const char* name,
+							   char* copy )
+{
+	if (name == NULL || name[0] != '/' || strchr(name+1, '/') != NULL ||
+		strlen(name) >= MODEL_REGISTRY_NAME_LENGTH){
+		return -1;
+	}
+	strcpy(copy, name);
+	return 0;
+}
+
+static void make_segment_name( const char* name,
+							   uint64_t version,
+							   char* segment_name )
+{
+	snprintf(segment_name, MODEL_SEGMENT_NAME_LENGTH, "%.63s.%lu", name, (unsigned long)version);
+	return;
+}
+
+//===Rebuild The Layer Array Over A Mapped Segment===//
+static void point_layers_into_segment( model_reader_t* self )
+{
+	unsigned int i;
+	double* arena;
+	compute_backend_t* backend;
+	model_segment_header_t* segment;
+
+	segment = self->segment;
+	arena = (double*)((char*)segment + segment->arena_offset);
+	backend = get_compute_backend((compute_backend_type_t)segment->backend);
+	if (backend == NULL){
+		backend = get_compute_backend(COMPUTE_BACKEND_AUTO);
+	}
+
+	memset(self->layer, 0, sizeof(self->layer));
+	self->num_layers = segment->num_layers;
+	for (i=0; i<self->num_layers; i++){
+		self->layer[i].weight_matrix = arena + segment->weight_offset[i];
+		self->layer[i].previous_layer = (i > 0) ? &(self->layer[i-1]) : NULL;
+		self->layer[i].next_layer = (i < self->num_layers-1) ? &(self->layer[i+1]) : NULL;
+		self->layer[i].backend = backend;
+		self->layer[i].operation_backend[LAYER_OPERATION_FORWARD] = backend;
+		self->layer[i].operation_backend[LAYER_OPERATION_BACKWARD] = backend;
+		self->layer[i].operation_backend[LAYER_OPERATION_UPDATE] = backend;
+		self->layer[i].activation = (activation_function_t)segment->activation[i];
+		self->layer[i].index = i;
+		self->layer[i].num_nodes = segment->num_nodes[i];
+		self->layer[i].leading_dimension = segment->leading_dimension[i];
+	}
+
+	return;
+}
+
+//===Layer Passes Trust These Fields, So A Corrupt Header Must Not Get Past Mapping===//
+static int check_segment_layout( model_segment_header_t* segment )
+{
+	unsigned int i, columns;
+	uint64_t rows;
+
+	if (segment->num_layers < 2 || segment->num_layers > MAX_LAYERS){
+		return -1;
+	}
+	for (i=0; i<segment->num_layers; i++){
+		if (segment->num_nodes[i] == 0 || segment->num_nodes[i] > MAX_LAYER_NODES ||
+			segment->activation[i] >= NUM_ACTIVATIONS){
+			return -1;
+		}
+	}
+
+	//===Rows Are Packed Or Padded Like Context Buffers, And Lie Inside The Arena===//
+	for (i=0; i<segment->num_layers-1; i++){
+		columns = segment->num_nodes[i+1];
+		if (segment->leading_dimension[i] != columns && segment->leading_dimension[i] != round_up(columns, SIMD_WIDTH)){
+			return -1;
+		}
+		rows = segment->num_nodes[i] + 1;
+		if (segment->weight_offset[i] > segment->arena_size ||
+			rows * segment->leading_dimension[i] > segment->arena_size - segment->weight_offset[i]){
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+//===The Name Of A Superseded Version May Vanish Before It Is Opened; Then Read The Version Again===//
+static int map_current_segment( model_reader_t* self )
+{
+	int fd;
+	unsigned int attempt;
+	uint64_t version;
+	char segment_name[MODEL_SEGMENT_NAME_LENGTH];
+	struct stat status;
+	model_segment_header_t* segment;
+
+	for (attempt=0; attempt<MODEL_REGISTRY_OPEN_RETRIES; attempt++){
+		version = atomic_load_explicit(&(self->control->version), memory_order_acquire);
+		if (version == 0){
+			fprintf(stderr, "Error:: Nothing Has Been Published! In Function -- map_current_segment\n");
+			return -1;
+		}
+		if (version == self->version){
+			return 0;
+		}
+
+		make_segment_name(self->name, version, segment_name);
+		fd = shm_open(segment_name, O_RDONLY, 0);
+		if (fd < 0){
+			if (errno == ENOENT){
+				continue;
+			}
+			fprintf(stderr, "Error:: Could Not Open Segment '%s'! In Function -- map_current_segment\n", segment_name);
+			return -1;
+		}
+		if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(model_segment_header_t)){
+			fprintf(stderr, "Error:: Segment '%s' Is Truncated! In Function -- map_current_segment\n", segment_name);
+			close(fd);
+			return -1;
+		}
+		segment = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (segment == MAP_FAILED){
+			fprintf(stderr, "Error:: Could Not Map Segment '%s'! In Function -- map_current_segment\n", segment_name);
+			return -1;
+		}
+		if (segment->magic != MODEL_REGISTRY_MAGIC || segment->version != version || check_segment_layout(segment) != 0 ||
+			segment->arena_offset > (uint64_t)status.st_size ||
+			segment->arena_size > ((uint64_t)status.st_size - segment->arena_offset) / sizeof(double)){
+			fprintf(stderr, "Error:: Segment '%s' Is Not A Model! In Function -- map_current_segment\n", segment_name);
+			munmap(segment, status.st_size);
+			return -1;
+		}
+
+		//===Switch, Then Drop The Old Mapping===//
+		if (self->segment != NULL){
+			munmap(self->segment, self->segment_bytes);
+			self->num_switches++;
+		}
+		self->segment = segment;
+		self->segment_bytes = status.st_size;
+		self->version = version;
+		point_layers_into_segment(self);
+		return 1;
+	}
+
+	fprintf(stderr, "Error:: Versions Changed Faster Than They Could Be Opened! In Function -- map_current_segment\n");
+	return -1;
+}
+
+static model_registry_control_t* map_registry_control( const char* name,
+													   int writable )
+{
+	int fd;
+	model_registry_control_t* control;
+
+	fd = writable ? shm_open(name, O_CREAT | O_RDWR, 0644) : shm_open(name, O_RDONLY, 0);
+	if (fd < 0){
+		fprintf(stderr, "Error:: Could Not Open Registry '%s'! In Function -- map_registry_control\n", name);
+		return NULL;
+	}
+	if (writable && ftruncate(fd, sizeof(model_registry_control_t)) != 0){
+		fprintf(stderr, "Error:: Could Not Size Registry '%s'! In Function -- map_registry_control\n", name);
+		close(fd);
+		return NULL;
+	}
+	control = mmap(NULL, sizeof(model_registry_control_t), writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (control == MAP_FAILED){
+		fprintf(stderr, "Error:: Could Not Map Registry '%s'! In Function -- map_registry_control\n", name);
+		return NULL;
+	}
+
+	return control;
+}
+
+//================================================================================================//
+//=====================================Publisher Functions========================================//
+//================================================================================================//
+
+model_registry_t* create_model_registry( const char* name )
+{
+	model_registry_t* self;
+
+	self = malloc(sizeof(model_registry_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Registry Was Not Allocated! In Function -- create_model_registry\n");
+		return NULL;
+	}
+	if (copy_registry_name(name, self->name) != 0){
+		fprintf(stderr, "Error:: Registry Name Is Invalid! In Function -- create_model_registry\n");
+		free(self);
+		return NULL;
+	}
+	self->control = map_registry_control(self->name, 1);
+	if (self->control == NULL){
+		free(self);
+		return NULL;
+	}
+
+	//===A Fresh Object Is Zero Filled===//
+	if (self->control->magic != MODEL_REGISTRY_MAGIC){
+		atomic_store(&(self->control->version), 0);
+		self->control->magic = MODEL_REGISTRY_MAGIC;
+	}
+	self->version = atomic_load(&(self->control->version));
+
+	return self;
+}
+
+void destroy_model_registry( model_registry_t* self,
+							 int unlink_names )
+{
+	char segment_name[MODEL_SEGMENT_NAME_LENGTH];
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Registry Is NULL! In Function -- destroy_model_registry\n");
+		return;
+	}
+	if (unlink_names){
+		if (self->version > 0){
+			make_segment_name(self->name, self->version, segment_name);
+			shm_unlink(segment_name);
+		}
+		shm_unlink(self->name);
+	}
+	munmap(self->control, sizeof(model_registry_control_t));
+	free(self);
+	return;
+}
+
+uint64_t publish_model( model_registry_t* self,
+						neural_network_t* network )
+{
+	int fd;
+	unsigned int i;
+	uint64_t version;
+	size_t bytes, arena_offset;
+	char segment_name[MODEL_SEGMENT_NAME_LENGTH];
+	model_segment_header_t* segment;
+
+	if (self == NULL || network == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- publish_model\n");
+		return 0;
+	}
+
+	//===Create The Next Version's Segment===//
+	version = self->version + 1;
+	make_segment_name(self->name, version, segment_name);
+	arena_offset = round_up(sizeof(model_segment_header_t), WEIGHT_ALIGNMENT);
+	bytes = arena_offset + network->arena_size * sizeof(double);
+	shm_unlink(segment_name);
+	fd = shm_open(segment_name, O_CREAT | O_EXCL | O_RDWR, 0444);
+	if (fd < 0){
+		fprintf(stderr, "Error:: Could Not Create Segment '%s'! In Function -- publish_model\n", segment_name);
+		return 0;
+	}
+	if (ftruncate(fd, bytes) != 0){
+		fprintf(stderr, "Error:: Could Not Size Segment '%s'! In Function -- publish_model\n", segment_name);
+		close(fd);
+		shm_unlink(segment_name);
+		return 0;
+	}
+	segment = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (segment == MAP_FAILED){
+		fprintf(stderr, "Error:: Could Not Map Segment '%s'! In Function -- publish_model\n", segment_name);
+		shm_unlink(segment_name);
+		return 0;
+	}
+
+	//===Write Topology And Weights===//
+	memset(segment, 0, arena_offset);
+	segment->magic = MODEL_REGISTRY_MAGIC;
+	segment->version = version;
+	segment->arena_offset = arena_offset;
+	segment->arena_size = network->arena_size;
+	segment->num_layers = network->num_hidden_layers+2;
+	segment->backend = network->backend->type;
+	for (i=0; i<segment->num_layers; i++){
+		segment->weight_offset[i] = network->layer[i].weight_matrix - network->weight_arena;
+		segment->num_nodes[i] = network->layer[i].num_nodes;
+		segment->leading_dimension[i] = network->layer[i].leading_dimension;
+		segment->activation[i] = network->layer[i].activation;
+	}
+	memcpy((char*)segment + arena_offset, network->weight_arena, network->arena_size * sizeof(double));
+	munmap(segment, bytes);
+
+	//===Flip, Then Retire The Old Name; Mapped Workers Keep Its Memory Until They Switch===//
+	atomic_store_explicit(&(self->control->version), version, memory_order_release);
+	if (self->version > 0){
+		make_segment_name(self->name, self->version, segment_name);
+		shm_unlink(segment_name);
+	}
+	self->version = version;
+
+	return version;
+}
+
+//================================================================================================//
+//======================================Reader Functions==========================================//
+//================================================================================================//
+
+model_reader_t* attach_model_reader( const char* name )
+{
+	model_reader_t* self;
+
+	self = malloc(sizeof(model_reader_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Reader Was Not Allocated! In Function -- attach_model_reader\n");
+		return NULL;
+	}
+	memset(self, 0, sizeof(model_reader_t));
+	if (copy_registry_name(name, self->name) != 0){
+		fprintf(stderr, "Error:: Registry Name Is Invalid! In Function -- attach_model_reader\n");
+		free(self);
+		return NULL;
+	}
+	self->control = map_registry_control(self->name, 0);
+	if (self->control == NULL){
+		free(self);
+		return NULL;
+	}
+	if (map_current_segment(self) != 1){
+		munmap(self->control, sizeof(model_registry_control_t));
+		free(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+void detach_model_reader( model_reader_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Reader Is NULL! In Function -- detach_model_reader\n");
+		return;
+	}
+	munmap(self->segment, self->segment_bytes);
+	munmap(self->control, sizeof(model_registry_control_t));
+	free(self);
+	return;
+}
+
+int refresh_model_reader( model_reader_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Reader Is NULL! In Function -- refresh_model_reader\n");
+		return -1;
+	}
+	if (atomic_load_explicit(&(self->control->version), memory_order_acquire) == self->version){
+		return 0;
+	}
+	return map_current_segment(self);
+}
+
+neural_context_t* create_model_context( model_reader_t* self )
+{
+	unsigned int i;
+	neural_network_t shape;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Model Reader Is NULL! In Function -- create_model_context\n");
+		return NULL;
+	}
+
+	//===Contexts Only Need The Layer Sizes===//
+	memset(&shape, 0, sizeof(neural_network_t));
+	shape.num_hidden_layers = self->num_layers-2;
+	for (i=0; i<self->num_layers; i++){
+		shape.layer[i].num_nodes = self->layer[i].num_nodes;
+	}
+
+	return create_neural_context(&shape);
+}
+
+void feed_forward_model( model_reader_t* self,
+						 neural_context_t* context,
+						 double* input )
+{
+	unsigned int i;
+
+	if (self == NULL || context == NULL || input == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- feed_forward_model\n");
+		return;
+	}
+	if (context->num_layers != self->num_layers){
+		fprintf(stderr, "Error:: Context Does Not Match The Model! In Function -- feed_forward_model\n");
+		return;
+	}
+	for (i=0; i<self->num_layers; i++){
+		if (context->layer[i].num_nodes != self->layer[i].num_nodes){
+			fprintf(stderr, "Error:: Context Does Not Match The Model! In Function -- feed_forward_model\n");
+			return;
+		}
+	}
+
+	//===Set Input===//
+	memcpy(context->input, input, self->layer[0].num_nodes * sizeof(double));
+
+	//===Feed Through Layers===//
+	for (i=0; i<self->num_layers; i++){
+		feed_layer_forward(&(self->layer[i]), context);
+	}
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+//===Worker Process: On Each Token, Switch If Needed And Send Back One Output===//
+static int run_test_model_worker( const char* name,
+								  int tokens,
+								  int results,
+								  double* input )
+{
+	char token;
+	double output;
+	model_reader_t* reader;
+	neural_context_t* context;
+
+	reader = attach_model_reader(name);
+	if (reader == NULL){
+		return 1;
+	}
+	context = create_model_context(reader);
+	if (context == NULL){
+		detach_model_reader(reader);
+		return 1;
+	}
+	while (read(tokens, &token, 1) == 1){
+		if (refresh_model_reader(reader) < 0){
+			break;
+		}
+		feed_forward_model(reader, context, input);
+		output = context->output[0];
+		if (write(results, &output, sizeof(double)) != sizeof(double)){
+			break;
+		}
+	}
+	destroy_neural_context(context);
+	detach_model_reader(reader);
+
+	return 0;
+}
+
+void test_model_registry()
+{
+	int status, tokens[2], results[2];
+	unsigned int i, v, num_nodes[3];
+	pid_t worker;
+	char name[MODEL_REGISTRY_NAME_LENGTH], segment_name[MODEL_SEGMENT_NAME_LENGTH];
+	double input[4], output;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	model_registry_t* registry;
+	uint64_t offset;
+	model_reader_t *reader, *corrupt;
+	model_segment_header_t* header;
+	neural_context_t* context;
+
+	num_nodes[0] = 4; num_nodes[1] = 9; num_nodes[2] = 1;
+	parameters = create_neural_network_parameters(1, num_nodes, 0.1);
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	network = create_neural_network(parameters);
+	for (i=0; i<4; i++){
+		input[i] = 0.3*i - 0.4;
+	}
+
+	snprintf(name, sizeof(name), "/neurons_model_registry_%d", (int)getpid());
+	registry = create_model_registry(name);
+	if (registry == NULL || publish_model(registry, network) != 1){
+		fprintf(stderr, "Error: Function publish_model Has Failed!\n");
+		if (registry != NULL){
+			destroy_model_registry(registry, 1);
+		}
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	if (pipe(tokens) != 0 || pipe(results) != 0){
+		fprintf(stderr, "Error: Function test_model_registry Could Not Create Pipes!\n");
+		destroy_model_registry(registry, 1);
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	fflush(stdout);
+	fflush(stderr);
+	worker = fork();
+	if (worker == 0){
+		close(tokens[1]);
+		close(results[0]);
+		_exit(run_test_model_worker(name, tokens[0], results[1], input));
+	}
+	close(tokens[0]);
+	close(results[1]);
+
+	//===Another Process Sees Each Version, Including After A Hot Swap===//
+	for (v=1; v<=3 && worker > 0; v++){
+		if (v > 1){
+			for (i=0; i<network->arena_size; i++){
+				network->weight_arena[i] *= -0.5;
+			}
+			mark_weights_changed(network);
+			publish_model(registry, network);
+		}
+		feed_forward(network, input);
+		if (write(tokens[1], "x", 1) != 1 || read(results[0], &output, sizeof(double)) != sizeof(double) ||
+			output != network->output[0]){
+			fprintf(stderr, "Error: Function refresh_model_reader Did Not Serve Version %u!\n", v);
+			break;
+		}
+	}
+	close(tokens[1]);
+	close(results[0]);
+	if (worker < 0 || waitpid(worker, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0){
+		fprintf(stderr, "Error: Function attach_model_reader Failed In The Worker!\n");
+	}
+
+	//===A Reader Keeps Its Mapping After The Name Is Retired===//
+	reader = attach_model_reader(name);
+	context = (reader != NULL) ? create_model_context(reader) : NULL;
+	if (reader == NULL || context == NULL){
+		fprintf(stderr, "Error: Function attach_model_reader Has Failed!\n");
+		if (reader != NULL){
+			detach_model_reader(reader);
+		}
+		destroy_model_registry(registry, 1);
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	feed_forward(network, input);
+	output = network->output[0];
+	publish_model(registry, network);
+	make_segment_name(name, 3, segment_name);
+	status = shm_open(segment_name, O_RDONLY, 0);
+	if (status >= 0){
+		fprintf(stderr, "Error: Function publish_model Did Not Retire The Old Segment!\n");
+		close(status);
+	}
+	feed_forward_model(reader, context, input);
+	if (context->output[0] != output || refresh_model_reader(reader) != 1 || refresh_model_reader(reader) != 0 ||
+		reader->version != 4 || reader->num_switches != 1){
+		fprintf(stderr, "Error: Function refresh_model_reader Has Failed!\n");
+	}
+
+	//===Headers That Would Send A Pass Outside Its Buffers Are Refused===//
+	make_segment_name(name, 4, segment_name);
+	status = shm_open(segment_name, O_RDWR, 0);
+	header = (status >= 0) ? mmap(NULL, sizeof(model_segment_header_t), PROT_READ | PROT_WRITE, MAP_SHARED, status, 0) : MAP_FAILED;
+	if (status >= 0){
+		close(status);
+	}
+	if (header == MAP_FAILED){
+		fprintf(stderr, "Error: Function test_model_registry Could Not Map The Current Segment!\n");
+	}
+	else{
+		header->leading_dimension[0] += 1;
+		corrupt = attach_model_reader(name);
+		header->leading_dimension[0] -= 1;
+		offset = header->weight_offset[1];
+		header->weight_offset[1] = header->arena_size;
+		corrupt = (corrupt != NULL) ? corrupt : attach_model_reader(name);
+		header->weight_offset[1] = offset;
+		if (corrupt != NULL){
+			fprintf(stderr, "Error: Function attach_model_reader Accepted A Corrupt Header!\n");
+			detach_model_reader(corrupt);
+		}
+		munmap(header, sizeof(model_segment_header_t));
+	}
+
+	destroy_neural_context(context);
+	detach_model_reader(reader);
+	destroy_model_registry(registry, 1);
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,257 @@
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MODEL_REGISTRY_MAGIC 0x4E4555524F4E5352ULL
+#define MODEL_REGISTRY_NAME_LENGTH 64
+#define MODEL_SEGMENT_NAME_LENGTH (MODEL_REGISTRY_NAME_LENGTH + 24)
+#define MODEL_REGISTRY_OPEN_RETRIES 64
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct model_registry_control_t
+*   @brief This structure comprises the shared control segment of a model registry.
+*
+*	It lives in the POSIX shared memory object named after the registry and holds only the
+*	version of the current model, which the publisher flips atomically once the new segment is
+*	complete.
+*/
+//================================================================================================//
+typedef struct model_registry_control_s model_registry_control_t;
+typedef struct model_registry_control_s{
+	uint64_t magic;
+	_Atomic uint64_t version;
+} model_registry_control_t;
+
+
+//================================================================================================//
+/** @struct model_segment_header_t
+*   @brief This structure comprises the header of one published model version.
+*
+*	Version v of registry "/name" is the shared memory object "/name.v": this header, then the
+*	weight arena at arena_offset, in the publishing network's layout. Segments are created
+*	read-only and never modified after the version flip.
+*/
+//================================================================================================//
+typedef struct model_segment_header_s model_segment_header_t;
+typedef struct model_segment_header_s{
+	uint64_t magic;
+	uint64_t version;
+	uint64_t arena_offset;
+	uint64_t arena_size;
+	uint64_t weight_offset[MAX_LAYERS];
+	uint32_t num_nodes[MAX_LAYERS];
+	uint32_t leading_dimension[MAX_LAYERS];
+	uint32_t activation[MAX_LAYERS];
+	uint32_t num_layers;
+	uint32_t backend;
+} model_segment_header_t;
+
+
+//================================================================================================//
+/** @struct model_registry_t
+*   @brief This structure comprises the publishing side of a shared memory model registry.
+*
+*	One process publishes; after each flip the previous segment's name is unlinked, and its
+*	memory is freed once the last worker still mapping it switches.
+*/
+//================================================================================================//
+typedef struct model_registry_s model_registry_t;
+typedef struct model_registry_s{
+	char name[MODEL_REGISTRY_NAME_LENGTH];
+	model_registry_control_t* control;
+	uint64_t version;
+} model_registry_t;
+
+
+//================================================================================================//
+/** @struct model_reader_t
+*   @brief This structure comprises one worker process's read-only view of a model registry.
+*
+*	The layer array points straight into the mapped segment, so every worker on the host shares
+*	one physical copy of the weights. It is rebuilt by refresh_model_reader when the registry's
+*	version moves on.
+*/
+//================================================================================================//
+typedef struct model_reader_s model_reader_t;
+typedef struct model_reader_s{
+	char name[MODEL_REGISTRY_NAME_LENGTH];
+	model_registry_control_t* control;
+	model_segment_header_t* segment;
+	size_t segment_bytes;
+	neural_layer_t layer[MAX_LAYERS];
+	unsigned int num_layers;
+	unsigned int num_switches;
+	uint64_t version;
+} model_reader_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function creates or reopens the control segment of a named model registry.
+*
+* The name is a POSIX shared memory name such as "/scoring_model". Reopening an existing
+* registry continues from its current version.
+*
+* If errors occur, the function exits.
+*
+* @param[in] const char* name
+*
+* @return model_registry_t* self
+*/
+//================================================================================================//
+model_registry_t* create_model_registry( const char* name );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a model_registry_t object, unlinking its names when asked.
+*
+* Workers that already mapped the current model keep using it after an unlink.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_registry_t* self
+* @param[in] int unlink_names
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_model_registry( model_registry_t* self,
+							 int unlink_names );
+
+
+//================================================================================================//
+/**
+* @brief This function publishes the network's weights as the registry's next version.
+*
+* The new segment is written completely before the version is flipped, so workers see either
+* the old model or the new one.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_registry_t* self
+* @param[in] neural_network_t* network
+*
+* @return uint64_t version (0 on error)
+*/
+//================================================================================================//
+uint64_t publish_model( model_registry_t* self,
+						neural_network_t* network );
+
+
+//================================================================================================//
+/**
+* @brief This function maps the current model of a named registry read-only.
+*
+* Fails if nothing has been published yet.
+*
+* If errors occur, the function exits.
+*
+* @param[in] const char* name
+*
+* @return model_reader_t* self
+*/
+//================================================================================================//
+model_reader_t* attach_model_reader( const char* name );
+
+
+//================================================================================================//
+/**
+* @brief This function unmaps a model_reader_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_reader_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void detach_model_reader( model_reader_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function switches a reader to the registry's current version if it changed.
+*
+* Workers call this between requests; it costs one atomic load when nothing was published.
+* Must not run while the same reader is feeding forward.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] model_reader_t* self
+*
+* @return int status (1 if switched, 0 if current, -1 on error)
+*/
+//================================================================================================//
+int refresh_model_reader( model_reader_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a neural_context_t matching the reader's current topology.
+*
+* If errors occur, the function exits.
+*
+* @param[in] model_reader_t* self
+*
+* @return neural_context_t* context
+*/
+//================================================================================================//
+neural_context_t* create_model_context( model_reader_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds an input through the reader's mapped model.
+*
+* The result is left in context->output. A context from before a topology change is rejected.
+*
+* If errors occur, the function exits.
+*
+* @param[in] model_reader_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* input
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_forward_model( model_reader_t* self,
+						 neural_context_t* context,
+						 double* input );
+
+
+//================================================================================================//
+/**
+* @brief This function tests publishing, attaching from another process and hot swapping.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_model_registry();
+
+
+
+#endif //MODEL_REGISTRY_H//
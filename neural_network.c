@@ -1,23 +1,76 @@
 #include "neural_network.h"
+#include "sparse.h"
+#include "backend.h"
+#include "autotune.h"
+#include "model_parallel.h"
+#include "mixed_precision.h"
 #include "helper.c"
 
 //================================================================================================//
-//===================================Activation Functions=========================================//
+//=====================================Softmax Functions==========================================//
 //================================================================================================//
 
-double pass_through(double x)
+void softmax_rows( double* logits,
+				   double* probabilities,
+				   unsigned int batch_size,
+				   unsigned int num_classes )
 {
-	return x;
-}
+	unsigned int b, i;
+	double maximum, sum, *row_in, *row_out;
 
-double sigmoid(double x)
-{
-	return 1/(1+exp(-x));
+	for (b=0; b<batch_size; b++){
+		row_in = logits + b*num_classes;
+		row_out = probabilities + b*num_classes;
+
+		//===Subtract Maximum So exp() Cannot Overflow===//
+		maximum = row_in[0];
+		for (i=1; i<num_classes; i++){
+			maximum = MAX(maximum, row_in[i]);
+		}
+		sum = 0;
+		for (i=0; i<num_classes; i++){
+			row_out[i] = exp(row_in[i] - maximum);
+			sum += row_out[i];
+		}
+		sum = 1.0/sum;
+		for (i=0; i<num_classes; i++){
+			row_out[i] *= sum;
+		}
+	}
+
+	return;
 }
 
-double sigmoid_derivative(double x)
+double softmax_cross_entropy( double* logits,
+							  double* labels,
+							  double* probabilities,
+							  double* gradient,
+							  unsigned int batch_size,
+							  unsigned int num_classes )
 {
-	return sigmoid(x)*(1-sigmoid(x));
+	unsigned int i, size;
+	double loss;
+
+	if (batch_size == 0 || num_classes == 0){
+		fprintf(stderr, "Error:: Input Parameter Size Is Invalid! In Function -- softmax_cross_entropy\n");
+		return 0;
+	}
+
+	softmax_rows(logits, probabilities, batch_size, num_classes);
+
+	//===Loss And Gradient In One Pass===//
+	loss = 0;
+	size = batch_size * num_classes;
+	for (i=0; i<size; i++){
+		if (labels[i] != 0){
+			loss -= labels[i] * log(MAX(probabilities[i], DBL_MIN));
+		}
+		if (gradient != NULL){
+			gradient[i] = probabilities[i] - labels[i];
+		}
+	}
+
+	return loss/batch_size;
 }
 
 //================================================================================================//
@@ -25,7 +78,9 @@ double sigmoid_derivative(double x)
 //================================================================================================//
 
 void initialize_neural_layer( neural_layer_t* self,
+							  unsigned int index,
 							  unsigned int num_nodes, 
+							  activation_function_t activation,
 							  neural_layer_t* previous_layer,
 							  neural_layer_t* next_layer )
 {
@@ -35,26 +90,35 @@ void initialize_neural_layer( neural_layer_t* self,
 		fprintf(stderr, "Error:: Input Parameter 'num_nodes' Is Invalid! In Function -- create_neural_layer\n");
 		return;
 	}
+	if (activation >= NUM_ACTIVATIONS){
+		fprintf(stderr, "Error:: Input Parameter 'activation' Is Invalid! In Function -- create_neural_layer\n");
+		return;
+	}
 	
 	//===Set Local Data===//
+	self->weight_mask = NULL;
+	self->sparse_weights = NULL;
+	self->use_sparse_weights = 0;
+	self->index = index;
 	self->num_nodes = num_nodes;
 	self->previous_layer = previous_layer;
 	self->next_layer = next_layer;
 
-	//===Set Functions===//
+	//===Input Layer Passes Data Through===//
+	self->activation = activation;
 	if (previous_layer == NULL){
-		self->activate = &(pass_through);
-		self->derivate = &(pass_through);
-	}
-	else{
-		self->activate = &(sigmoid);
-		self->derivate = &(sigmoid_derivative);
+		self->activation = ACTIVATION_IDENTITY;
 	}
+	self->backend = get_compute_backend(COMPUTE_BACKEND_PORTABLE);
+	self->operation_backend[LAYER_OPERATION_FORWARD] = self->backend;
+	self->operation_backend[LAYER_OPERATION_BACKWARD] = self->backend;
+	self->operation_backend[LAYER_OPERATION_UPDATE] = self->backend;
 
 	return;
 }
 
-void initialize_weight_matrix( neural_layer_t* self )
+void initialize_weight_matrix( neural_layer_t* self,
+							   uint64_t key )
 {
 
 	unsigned int i,j;
@@ -64,12 +128,12 @@ void initialize_weight_matrix( neural_layer_t* self )
 	for (i=0; i<self->num_nodes+1; i++){
 		if (self->next_layer != NULL){
 			for (j=0; j<self->next_layer->num_nodes; j++){
-				temp = ((double)rand()/(double)(RAND_MAX)) * 1.0;
-				self->weight_matrix[j + i*self->next_layer->num_nodes] = temp;			
+				temp = random_uniform_at(key, j + i*self->next_layer->num_nodes) * 1.0;
+				self->weight_matrix[j + i*self->leading_dimension] = temp;			
 			}
 		}
 		else{
-			temp = ((double)rand()/(double)(RAND_MAX)) * 1.0;
+			temp = random_uniform_at(key, i) * 1.0;
 			self->weight_matrix[i] = temp;			
 		}
 	}
@@ -86,7 +150,7 @@ void set_weight_matrix( neural_layer_t* self,
 	for (i=0; i<self->num_nodes+1; i++){
 		if (self->next_layer != NULL){
 			for (j=0; j<self->next_layer->num_nodes; j++){
-				self->weight_matrix[j + i*self->next_layer->num_nodes] = matrix[j + i*self->next_layer->num_nodes];			
+				self->weight_matrix[j + i*self->leading_dimension] = matrix[j + i*self->next_layer->num_nodes];			
 			}
 		}
 		else{
@@ -100,7 +164,7 @@ void set_weight_matrix( neural_layer_t* self,
 void print_weight_matrix( neural_layer_t* self )
 {
 	if (self->next_layer != NULL){
-		print_matrix(self->weight_matrix, self->num_nodes+1, self->next_layer->num_nodes);	
+		print_strided_matrix(self->weight_matrix, self->num_nodes+1, self->next_layer->num_nodes, self->leading_dimension);	
 	}
 	else{
 		print_vector(self->weight_matrix, self->num_nodes+1);	
@@ -108,7 +172,7 @@ void print_weight_matrix( neural_layer_t* self )
 	return;
 }
 
-void set_input( neural_layer_t* self,
+void set_input( layer_state_t* self,
 				double* input )
 {
 	unsigned int i;
@@ -120,13 +184,13 @@ void set_input( neural_layer_t* self,
 	return;
 }
 
-void print_input( neural_layer_t* self )
+void print_input( layer_state_t* self )
 {
 	print_vector(self->input, self->num_nodes);
 	return;
 }	
 
-void set_delta( neural_layer_t* self,
+void set_delta( layer_state_t* self,
 				double* delta )
 {
 	unsigned int i;
@@ -137,13 +201,13 @@ void set_delta( neural_layer_t* self,
 
 }
 
-void print_delta( neural_layer_t* self )
+void print_delta( layer_state_t* self )
 {
 	print_vector(self->delta, self->num_nodes);
 	return;
 }
 
-void set_derivative( neural_layer_t* self,
+void set_derivative( layer_state_t* self,
 					 double* derivative )
 {
 	unsigned int i;
@@ -154,70 +218,110 @@ void set_derivative( neural_layer_t* self,
 	return;
 }
 
-void print_derivative( neural_layer_t* self )
+void print_derivative( layer_state_t* self )
 {
 	print_vector(self->derivative, self->num_nodes);
 	return;
 }
 
-void feed_layer_forward(neural_layer_t* self)
+void feed_layer_forward( neural_layer_t* self,
+						 neural_context_t* context )
 {
-	unsigned int i;
+	layer_state_t* state;
+
+	state = &(context->layer[self->index]);
 	
 	//===Set Input Activation===//
-	for (i=0; i<self->num_nodes; i++){
-		self->activation[i] = self->activate(self->input[i]);
-		self->derivative[i] = self->derivate(self->input[i]);
-	}
-	self->activation[self->num_nodes] = 1;
+	self->backend->activate[self->activation](state->input, state->activation, state->derivative, self->num_nodes);
+	state->activation[self->num_nodes] = 1;
 
 	//===Pass To Next Layer===//
-	if (self->next_layer != NULL){ 
-		vector_matrix_multiply(self->activation, self->num_nodes+1,
-							   self->weight_matrix, self->num_nodes+1, self->next_layer->num_nodes,
-							   self->next_layer->input); 
+	if (self->use_sparse_weights){
+		csr_vector_matrix_multiply(state->activation, self->sparse_weights,
+								   context->layer[self->index+1].input);
+	}
+	else if (self->next_layer != NULL){ 
+		//===Padding Columns Are Zero And Context Buffers Are Padded Alike, So Run Whole Rows===//
+		vector_matrix_multiply(self->operation_backend[LAYER_OPERATION_FORWARD], state->activation, self->num_nodes+1,
+							   self->weight_matrix, self->num_nodes+1, self->leading_dimension,
+							   self->leading_dimension, context->layer[self->index+1].input); 
 	}
 
 	return;
 }
 
-void feed_layer_backwards(neural_layer_t* self)
+void feed_layer_backwards( neural_layer_t* self,
+						   neural_context_t* context )
 {
 
 	unsigned int i;
+	layer_state_t *state, *previous_state;
 
 	if (self->previous_layer != NULL){
-		matrix_vector_multiply( self->delta,
-								self->num_nodes,
+		state = &(context->layer[self->index]);
+		previous_state = &(context->layer[self->index-1]);
+
+		matrix_vector_multiply( self->previous_layer->operation_backend[LAYER_OPERATION_BACKWARD],
+								state->delta,
+								self->previous_layer->leading_dimension,
 								self->previous_layer->weight_matrix,
 								self->previous_layer->num_nodes,
-								self->num_nodes,
-								self->previous_layer->delta );	
+								self->previous_layer->leading_dimension,
+								self->previous_layer->leading_dimension,
+								previous_state->delta );	
 	
 		//===Make Deltas===//
 		for (i=0; i<self->previous_layer->num_nodes; i++){
-			self->previous_layer->delta[i] *= self->previous_layer->derivative[i];
+			previous_state->delta[i] *= previous_state->derivative[i];
 		}		
 	}
 
 	return;
 }
 
-void update_weight_matrix( neural_layer_t* self )
+void compute_weight_gradient( neural_layer_t* self,
+							  neural_context_t* context )
 {
 
 	if (self->next_layer != NULL){
+		matrix_matrix_multiply(self->operation_backend[LAYER_OPERATION_UPDATE], context->layer[self->index].activation, self->num_nodes+1, 1,
+							   context->layer[self->index+1].delta, 1, self->leading_dimension,
+							   self->leading_dimension, self->weight_update);
+	}
 
-		matrix_matrix_multiply(self->activation, self->num_nodes+1, 1,
-							   self->next_layer->delta, 1, self->next_layer->num_nodes,
-							   self->weight_update);
+	return;
+}
+
+void apply_weight_gradient( neural_layer_t* self,
+							double* gradient,
+							double update_weight )
+{
 
-		matrix_update(self->weight_matrix, self->num_nodes+1, self->next_layer->num_nodes,
-			  		  self->weight_update, -(*self->learning_rate));
+	if (self->next_layer != NULL){
+
+		matrix_update(self->operation_backend[LAYER_OPERATION_UPDATE], self->weight_matrix, self->num_nodes+1, self->leading_dimension,
+			  		  gradient, update_weight);
+
+		//===Pruned Weights Stay Pruned===//
+		if (self->weight_mask != NULL){
+			matrix_mask(self->weight_matrix, self->num_nodes+1, self->leading_dimension, self->weight_mask);
+			if (self->sparse_weights != NULL){
+				refresh_sparse_weights(self);
+			}
+		}
+		atomic_fetch_add_explicit(self->weight_version, 1, memory_order_release);
 
 	}
 
+	return;
+}
 
+void update_weight_matrix( neural_layer_t* self,
+						   neural_context_t* context )
+{
+	compute_weight_gradient(self, context);
+	apply_weight_gradient(self, self->weight_update, -(*self->learning_rate));
+	return;
 }
 
 //================================================================================================//
@@ -261,17 +365,89 @@ neural_network_parameters_t* create_neural_network_parameters( unsigned int num_
 		self->num_nodes[i] = num_nodes[i];
 	}	
 	self->learning_rate = learning_rate;
+	self->activation[0] = ACTIVATION_IDENTITY;
+	for(i=1; i<num_hidden_layers+2; i++){
+		self->activation[i] = ACTIVATION_SIGMOID;
+	}
+	self->weight_storage = WEIGHT_STORAGE_PACKED;
+	self->backend = COMPUTE_BACKEND_AUTO;
+	self->autotune = 0;
+	self->seed = RANDOM_DEFAULT_SEED;
 
 	return self;
 }
 
 
+static int allocate_weight_arenas( neural_network_t* self )
+{
+	unsigned int i, num_columns;
+	size_t offset, bytes;
+	size_t offsets[MAX_LAYERS];
+	neural_layer_t* layer;
+
+	//===Lay Out Every Layer===//
+	offset = 0;
+	for (i=0; i<self->num_hidden_layers+2; i++){
+		layer = &(self->layer[i]);
+
+		//===Output Weights Are A Single Column===//
+		num_columns = 1;
+		if (layer->next_layer != NULL){
+			num_columns = layer->next_layer->num_nodes;
+		}
+		layer->leading_dimension = num_columns;
+		if (self->weight_storage == WEIGHT_STORAGE_PADDED){
+			layer->leading_dimension = round_up(num_columns, SIMD_WIDTH);
+			offset = round_up(offset, SIMD_WIDTH);
+		}
+
+		offsets[i] = offset;
+		offset += (size_t)(layer->num_nodes+1) * layer->leading_dimension;
+	}
+	self->arena_size = offset;
+
+	//===Allocate Aligned Arenas===//
+	bytes = round_up(self->arena_size * sizeof(double), WEIGHT_ALIGNMENT);
+	self->weight_arena = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	self->update_arena = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	self->mask_arena = NULL;
+	if (self->weight_arena == NULL || self->update_arena == NULL){
+		free(self->weight_arena);
+		free(self->update_arena);
+		return -1;
+	}
+	memset(self->weight_arena, 0, bytes);
+	memset(self->update_arena, 0, bytes);
+
+	//===Point Layers Into Arenas===//
+	for (i=0; i<self->num_hidden_layers+2; i++){
+		self->layer[i].weight_matrix = self->weight_arena + offsets[i];
+		self->layer[i].weight_update = self->update_arena + offsets[i];
+	}
+
+	return 0;
+}
+
 neural_network_t* create_neural_network( neural_network_parameters_t* parameters )
 {
 
 	unsigned int i;
 	neural_network_t *self;
 	neural_layer_t *previous_layer, *next_layer;
+
+	//===Check Parameters===//
+	if (parameters == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'parameters' Is NULL! In Function -- create_neural_network\n");
+		return NULL;
+	}
+	for (i=0; i<parameters->num_hidden_layers+2; i++){
+		if (parameters->activation[i] >= NUM_ACTIVATIONS ||
+			(parameters->activation[i] == ACTIVATION_SOFTMAX && i != parameters->num_hidden_layers+1)){
+			fprintf(stderr, "Error:: Input Parameter 'activation[%d]' Is Invalid! In Function -- create_neural_network\n", i);
+			return NULL;
+		}
+	}
+
 	self = NULL;
 	self = malloc(sizeof(neural_network_t));
 	if (self == NULL){
@@ -279,15 +455,17 @@ neural_network_t* create_neural_network( neural_network_parameters_t* parameters
 		return self;
 	}	
 
-	//===Initialize Random Number Generator===//
- 	srand((unsigned int)time(NULL));
+	//===Seed Of The Weights And Of Every Thread's Random Stream===//
+	self->seed = parameters->seed;
 
 	//===Set Local Data===//
 	self->num_hidden_layers = parameters->num_hidden_layers;
-	self->input = self->layer[0].input;
-	self->output = self->layer[self->num_hidden_layers+1].activation;
-	self->error = self->layer[self->num_hidden_layers+1].delta;
 	self->learning_rate = parameters->learning_rate;
+	self->loss = 0;
+	self->weight_storage = parameters->weight_storage;
+	self->model_parallel = NULL;
+	self->mixed_precision = NULL;
+	atomic_init(&(self->weight_version), 0);
 
 	//===Create Layers===//
 	for (i=0; i<self->num_hidden_layers+2; i++){
@@ -305,18 +483,181 @@ neural_network_t* create_neural_network( neural_network_parameters_t* parameters
 			next_layer = &(self->layer[i+1]);
 		}
 
-		initialize_neural_layer(&(self->layer[i]), parameters->num_nodes[i], previous_layer, next_layer);
+		initialize_neural_layer(&(self->layer[i]), i, parameters->num_nodes[i], parameters->activation[i], previous_layer, next_layer);
 		self->layer[i].learning_rate = &(self->learning_rate);
+		self->layer[i].weight_version = &(self->weight_version);
+	}
+
+	//===Select Kernels===//
+	if (set_compute_backend(self, parameters->backend) != 0){
+		fprintf(stderr, "Error:: Compute Backend Was Not Set! In Function -- create_neural_network\n");
+		free(self);
+		return NULL;
+	}
+
+	//===Allocate Weights===//
+	if (allocate_weight_arenas(self) != 0){
+		fprintf(stderr, "Error:: Weight Arenas Were Not Allocated! In Function -- create_neural_network\n");
+		free(self);
+		return NULL;
 	}
 
 	for (i=0; i<self->num_hidden_layers+2; i++){
 		//===Initialize Weight Matrix===//
-		initialize_weight_matrix(&(self->layer[i]));
+		initialize_weight_matrix(&(self->layer[i]), random_derive_key(self->seed, i));
+	}
+
+	//===Create Training Context===//
+	self->context = create_neural_context(self);
+	if (self->context == NULL){
+		fprintf(stderr, "Error:: Training Context Was Not Created! In Function -- create_neural_network\n");
+		free(self->weight_arena);
+		free(self->update_arena);
+		free(self);
+		return NULL;
+	}
+	self->input = self->context->input;
+	self->output = self->context->output;
+	self->error = self->context->error;
+
+	//===Pick The Fastest Kernels For Each Layer Shape===//
+	if (parameters->autotune && autotune_network(self, 1, NULL) < 0){
+		fprintf(stderr, "Error:: Autotuning Has Failed! In Function -- create_neural_network\n");
 	}
 	
 	return self;
 }
 
+neural_context_t* create_neural_context( neural_network_t* network )
+{
+	unsigned int i, num_nodes;
+	size_t offset, bytes;
+	size_t offsets[MAX_LAYERS][4];
+	neural_context_t* self;
+
+	if (network == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'network' Is NULL! In Function -- create_neural_context\n");
+		return NULL;
+	}
+
+	self = NULL;
+	self = malloc(sizeof(neural_context_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Neural Context Was Not Allocated! In Function -- create_neural_context\n");
+		return self;
+	}
+
+	//===Lay Out Buffers===//
+	self->num_layers = network->num_hidden_layers+2;
+	offset = 0;
+	for (i=0; i<self->num_layers; i++){
+		num_nodes = network->layer[i].num_nodes;
+		offsets[i][0] = offset; offset += round_up(num_nodes, SIMD_WIDTH);
+		offsets[i][1] = offset; offset += round_up(num_nodes+1, SIMD_WIDTH);
+		offsets[i][2] = offset; offset += round_up(num_nodes+1, SIMD_WIDTH);
+		offsets[i][3] = offset; offset += round_up(num_nodes, SIMD_WIDTH);
+	}
+
+	//===Allocate One Aligned Arena===//
+	bytes = round_up(offset * sizeof(double), WEIGHT_ALIGNMENT);
+	self->arena = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	if (self->arena == NULL){
+		fprintf(stderr, "Error:: Neural Context Arena Was Not Allocated! In Function -- create_neural_context\n");
+		free(self);
+		return NULL;
+	}
+	memset(self->arena, 0, bytes);
+
+	//===Point States Into Arena===//
+	for (i=0; i<self->num_layers; i++){
+		self->layer[i].input = self->arena + offsets[i][0];
+		self->layer[i].activation = self->arena + offsets[i][1];
+		self->layer[i].derivative = self->arena + offsets[i][2];
+		self->layer[i].delta = self->arena + offsets[i][3];
+		self->layer[i].num_nodes = network->layer[i].num_nodes;
+	}
+	self->input = self->layer[0].input;
+	self->output = self->layer[self->num_layers-1].activation;
+	self->error = self->layer[self->num_layers-1].delta;
+
+	return self;
+}
+
+void destroy_neural_context( neural_context_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Neural Context Is NULL! In Function -- destroy_neural_context\n");
+		return;
+	}
+
+	free(self->arena);
+	free(self);
+
+	return;
+}
+
+void initialize_thread_random_stream( neural_network_t* self,
+									  unsigned int thread_id,
+									  random_stream_t* stream )
+{
+	if (self == NULL || stream == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- initialize_thread_random_stream\n");
+		return;
+	}
+
+	initialize_random_stream(stream, self->seed, thread_id+1);
+
+	return;
+}
+
+void destroy_neural_network( neural_network_t* self )
+{
+	unsigned int i;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Neural Network Is NULL! In Function -- destroy_neural_network\n");
+		return;
+	}
+
+	if (self->model_parallel != NULL){
+		destroy_model_parallel(self->model_parallel);
+	}
+	if (self->mixed_precision != NULL){
+		destroy_mixed_precision(self->mixed_precision);
+	}
+	destroy_neural_context(self->context);
+	for (i=0; i<self->num_hidden_layers+2; i++){
+		if (self->layer[i].sparse_weights != NULL){
+			destroy_sparse_matrix(self->layer[i].sparse_weights);
+		}
+	}
+	free(self->weight_arena);
+	free(self->update_arena);
+	free(self->mask_arena);
+	free(self);
+
+	return;
+}
+
+void mark_weights_changed( neural_network_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Neural Network Is NULL! In Function -- mark_weights_changed\n");
+		return;
+	}
+	atomic_fetch_add_explicit(&(self->weight_version), 1, memory_order_release);
+	return;
+}
+
+uint64_t get_weight_version( neural_network_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Neural Network Is NULL! In Function -- get_weight_version\n");
+		return 0;
+	}
+	return atomic_load_explicit(&(self->weight_version), memory_order_acquire);
+}
+
 void print_weight_matrices( neural_network_t* self )
 {
 	unsigned int i;
@@ -325,39 +666,222 @@ void print_weight_matrices( neural_network_t* self )
 	}
 }
 
-void feed_forward( neural_network_t* self, 
-				   double* input )
+void feed_forward_context( neural_network_t* self,
+						   neural_context_t* context,
+						   double* input )
 {
 	unsigned int i;
 
 	//===Set Input===//
 	for (i=0; i<self->layer[0].num_nodes; i++){
-		self->input[i] = input[i];
+		context->input[i] = input[i];
 	}
 
 	//===Feed Through Layers===//
 	for (i=0; i<self->num_hidden_layers+2; i++){
-		feed_layer_forward(&(self->layer[i]));
+		feed_layer_forward(&(self->layer[i]), context);
+	}
+
+	return;
+}
+
+void feed_forward( neural_network_t* self, 
+				   double* input )
+{
+	if (self->mixed_precision != NULL){
+		memcpy(self->context->input, input, self->layer[0].num_nodes * sizeof(double));
+		mixed_precision_feed_forward(self->mixed_precision, self->context);
+		return;
+	}
+	if (self->model_parallel != NULL){
+		memcpy(self->context->input, input, self->layer[0].num_nodes * sizeof(double));
+		model_parallel_feed_forward(self->model_parallel, self->context);
+		return;
+	}
+	feed_forward_context(self, self->context, input);
+	return;
+}
+
+void feed_forward_view( neural_network_t* self,
+						neural_context_t* context,
+						input_view_t* view,
+						size_t row )
+{
+	unsigned int i;
+	double* input;
+	neural_layer_t* first;
+
+	if (view == NULL || view->base == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'view' Is Invalid! In Function -- feed_forward_view\n");
+		return;
+	}
+	input = view->base + row*view->row_stride + view->feature_offset;
+
+	//===Those Passes Read context->input, So The Row Is Copied After All===//
+	if (self->mixed_precision != NULL || self->model_parallel != NULL){
+		memcpy(context->input, input, self->layer[0].num_nodes * sizeof(double));
+		if (self->mixed_precision != NULL){
+			mixed_precision_feed_forward(self->mixed_precision, context);
+		}
+		else{
+			model_parallel_feed_forward(self->model_parallel, context);
+		}
+		return;
+	}
+
+	//===First Layer Straight From The View: Bias Row, Then Accumulate input * W===//
+	first = &(self->layer[0]);
+	memcpy(context->layer[1].input, first->weight_matrix + (size_t)first->num_nodes * first->leading_dimension,
+		   first->next_layer->num_nodes * sizeof(double));
+	first->operation_backend[LAYER_OPERATION_FORWARD]->gemm(1, first->next_layer->num_nodes, first->num_nodes,
+															 1.0, input, first->num_nodes,
+															 first->weight_matrix, first->leading_dimension,
+															 1.0, context->layer[1].input, first->next_layer->num_nodes);
+
+	//===Feed Through Remaining Layers===//
+	for (i=1; i<self->num_hidden_layers+2; i++){
+		feed_layer_forward(&(self->layer[i]), context);
+	}
+
+	return;
+}
+
+int initialize_incremental_state( neural_network_t* network,
+								  neural_context_t* context,
+								  unsigned int refresh_interval,
+								  unsigned int max_changed,
+								  incremental_state_t* state )
+{
+	if (network == NULL || context == NULL || state == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- initialize_incremental_state\n");
+		return -1;
+	}
+	state->context = context;
+	state->refresh_interval = (refresh_interval == 0) ? INCREMENTAL_REFRESH_INTERVAL : refresh_interval;
+	state->max_changed = (max_changed == 0) ? MAX(network->layer[0].num_nodes/4, 1) : max_changed;
+	state->frames_since_refresh = 0;
+	state->num_refreshes = 0;
+	state->weight_version = get_weight_version(network);
+	state->valid = 0;
+
+	return 0;
+}
+
+void invalidate_incremental_state( incremental_state_t* state )
+{
+	if (state == NULL){
+		fprintf(stderr, "Error:: State Is NULL! In Function -- invalidate_incremental_state\n");
+		return;
+	}
+	state->valid = 0;
+	return;
+}
+
+void feed_forward_incremental( neural_network_t* self,
+							   incremental_state_t* state,
+							   double* input )
+{
+	unsigned int i, num_changed;
+	double change;
+	neural_layer_t* first;
+	neural_context_t* context;
+
+	if (state == NULL || state->context == NULL || input == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- feed_forward_incremental\n");
+		return;
+	}
+	context = state->context;
+	first = &(self->layer[0]);
+	if (state->weight_version != get_weight_version(self)){
+		state->weight_version = get_weight_version(self);
+		state->valid = 0;
+	}
+
+	//===Fold Changed Features Into The Cached Pre-Activation; context->input Holds The Last Frame===//
+	num_changed = 0;
+	if (state->valid && state->frames_since_refresh < state->refresh_interval){
+		for (i=0; i<first->num_nodes; i++){
+			if (input[i] == context->input[i]){
+				continue;
+			}
+			if (++num_changed > state->max_changed){
+				break;
+			}
+			change = input[i] - context->input[i];
+			context->input[i] = input[i];
+			first->operation_backend[LAYER_OPERATION_FORWARD]->axpy(first->next_layer->num_nodes, change,
+																	 first->weight_matrix + (size_t)i*first->leading_dimension,
+																	 context->layer[1].input);
+		}
+	}
+
+	//===Full Recompute When The Cache Is Stale, Old, Or Cheaper To Rebuild===//
+	if (!state->valid || state->frames_since_refresh >= state->refresh_interval || num_changed > state->max_changed){
+		memcpy(context->input, input, first->num_nodes * sizeof(double));
+		feed_layer_forward(first, context);
+		state->frames_since_refresh = 0;
+		state->num_refreshes++;
+		state->valid = 1;
+	}
+	state->frames_since_refresh++;
+
+	//===Feed Through Remaining Layers===//
+	for (i=1; i<self->num_hidden_layers+2; i++){
+		feed_layer_forward(&(self->layer[i]), context);
 	}
 
 	return;
 }
 
+double compute_output_error( neural_network_t* self,
+							 neural_context_t* context,
+							 double* true_decision )
+{
+	unsigned int i, num_outputs;
+	double temp, loss;
+
+	//===Create Error===//
+	loss = 0;
+	num_outputs = self->layer[self->num_hidden_layers+1].num_nodes;
+	if (self->layer[self->num_hidden_layers+1].activation == ACTIVATION_SOFTMAX){
+
+		//===Softmax Was Applied Going Forward; Only Loss And p - y Remain===//
+		for (i=0; i<num_outputs; i++){
+			if (true_decision[i] != 0){
+				loss -= true_decision[i] * log(MAX(context->output[i], DBL_MIN));
+			}
+			context->error[i] = context->output[i] - true_decision[i];
+		}
+	}
+	else{
+		for (i=0; i<num_outputs; i++){
+			temp = context->output[i] - true_decision[i];
+			context->error[i] = temp;
+			loss += 0.5 * temp * temp;
+		}
+	}
+
+	return loss;
+}
+
 void back_propagate( neural_network_t* self,
 					 double* true_decision )
 {
 	unsigned int i;
-	double temp;
 
-	//===Create Error===//
-	for (i=0; i<self->layer[self->num_hidden_layers+1].num_nodes; i++){
-		temp = self->layer[self->num_hidden_layers+1].activation[i] - true_decision[i];
-		self->error[i] = temp;
+	self->loss = compute_output_error(self, self->context, true_decision);
+	if (self->mixed_precision != NULL){
+		mixed_precision_back_propagate(self->mixed_precision, self->context);
+		return;
+	}
+	if (self->model_parallel != NULL){
+		model_parallel_back_propagate(self->model_parallel, self->context);
+		return;
 	}
 
-	//===Feed Backwards===//
-	for (i=self->num_hidden_layers+1; i>0; i--){
-		feed_layer_backwards(&(self->layer[i]));
+	//===Feed Backwards (The Input Layer Needs No Delta)===//
+	for (i=self->num_hidden_layers+1; i>1; i--){
+		feed_layer_backwards(&(self->layer[i]), self->context);
 	}
 
 	return;
@@ -366,78 +890,209 @@ void back_propagate( neural_network_t* self,
 void update_weights( neural_network_t* self )
 {
 	unsigned int i;
+	if (self->mixed_precision != NULL){
+		mixed_precision_update_weights(self->mixed_precision, self->context);
+		return;
+	}
+	if (self->model_parallel != NULL){
+		model_parallel_update_weights(self->model_parallel, self->context);
+		return;
+	}
 	for (i=0; i<self->num_hidden_layers+2; i++){
-		update_weight_matrix(&(self->layer[i]));
+		update_weight_matrix(&(self->layer[i]), self->context);
 	}
 
 }
 
-void iterate_network( neural_network_t* self,
-					  double* input,
-					  double* true_decision )
+void compute_weight_gradients( neural_network_t* self )
 {
-
-	//===Feed Forward===//
-	feed_forward(self, input);
-
-#if DEBUG
 	unsigned int i;
-	fprintf(stdout, "\n");
 	for (i=0; i<self->num_hidden_layers+2; i++){
-		fprintf(stdout, "Input %d:", i);
-		print_vector(self->layer[i].input, self->layer[i].num_nodes);
+		compute_weight_gradient(&(self->layer[i]), self->context);
 	}
+	return;
+}
 
-	fprintf(stdout, "\n");
+void apply_weight_gradients( neural_network_t* self,
+							 double* gradient,
+							 double update_weight )
+{
+	unsigned int i;
 	for (i=0; i<self->num_hidden_layers+2; i++){
-		fprintf(stdout, "Activation %d:", i);
-		print_vector(self->layer[i].activation, self->layer[i].num_nodes+1);
+		apply_weight_gradient(&(self->layer[i]), gradient + (self->layer[i].weight_matrix - self->weight_arena), update_weight);
 	}
-#endif
+	return;
+}
 
-	//===Back Propagation===//
-	back_propagate(self, true_decision);
+//===Trace Points: Norms Of Each Phase, Only Reached While Tracing Is On===//
+static double vector_norm( double* vector,
+						   unsigned int length )
+{
+	unsigned int i;
+	double sum;
 
-#if DEBUG
-	fprintf(stdout, "\n");
-	fprintf(stdout, "Error:");
-	print_vector(self->error, self->layer[self->num_hidden_layers+1].num_nodes);
+	sum = 0;
+	for (i=0; i<length; i++){
+		sum += vector[i] * vector[i];
+	}
+	return sqrt(sum);
+}
 
+static double strided_matrix_norm( double* matrix,
+								   unsigned int num_rows,
+								   unsigned int num_cols,
+								   unsigned int leading_dimension )
+{
+	unsigned int r;
+	double sum, norm;
 
-	fprintf(stdout, "\n");
-	for (i=0; i<self->num_hidden_layers+2; i++){
-		fprintf(stdout, "Delta %d:", i);
-		print_vector(self->layer[i].delta, self->layer[i].num_nodes);
+	sum = 0;
+	for (r=0; r<num_rows; r++){
+		norm = vector_norm(matrix + (size_t)r*leading_dimension, num_cols);
+		sum += norm * norm;
 	}
-#endif
+	return sqrt(sum);
+}
 
-	//===Update Weights===//
-	update_weights(self);	
+void trace_forward_pass( neural_network_t* self,
+						 double input_norm,
+						 unsigned int first_layer )
+{
+	unsigned int i;
 
-#if DEBUG
-	fprintf(stdout, "\n");
+	trace_begin_iteration();
+	record_trace_event(TRACE_PHASE_ITERATION, 0, input_norm, 0);
 	for (i=0; i<self->num_hidden_layers+2; i++){
-		fprintf(stdout, "Weight Update %d:", i);
-		if (i<self->num_hidden_layers+1){
-			print_matrix(self->layer[i].weight_update, self->layer[i].num_nodes, self->layer[i].next_layer->num_nodes);
-		}
-		else{
-			print_vector(self->layer[i].weight_update, self->layer[i].num_nodes);
+		if (i < first_layer){
+			record_trace_event(TRACE_PHASE_FORWARD, i, input_norm, input_norm);
+			continue;
 		}
+		record_trace_event(TRACE_PHASE_FORWARD, i, vector_norm(self->context->layer[i].activation, self->layer[i].num_nodes),
+						   vector_norm(self->context->layer[i].input, self->layer[i].num_nodes));
 	}
+	return;
+}
 
+void trace_backward_pass( neural_network_t* self )
+{
+	unsigned int i;
 
-	fprintf(stdout, "\n");
-	for (i=0; i<self->num_hidden_layers+2; i++){
-		fprintf(stdout, "Weight Matrix %d:", i);
-		if (i<self->num_hidden_layers+1){
-			print_matrix(self->layer[i].weight_matrix, self->layer[i].num_nodes, self->layer[i].next_layer->num_nodes);
+	for (i=self->num_hidden_layers+1; i>0; i--){
+		record_trace_event(TRACE_PHASE_BACKWARD, i, vector_norm(self->context->layer[i].delta, self->layer[i].num_nodes),
+						   (i == self->num_hidden_layers+1) ? self->loss : 0);
+	}
+	return;
+}
+
+void trace_weight_update( neural_network_t* self,
+						  double input_norm,
+						  unsigned int first_layer )
+{
+	unsigned int i;
+	double update_norm;
+	neural_layer_t* layer;
+
+	for (i=0; i<self->num_hidden_layers+1; i++){
+		layer = &(self->layer[i]);
+		if (i < first_layer){
+			//===The Skipped Update Is The Outer Product Of [input, 1] And The Next Delta===//
+			update_norm = sqrt(input_norm*input_norm + 1) * vector_norm(self->context->layer[i+1].delta, layer->next_layer->num_nodes);
+			record_trace_event(TRACE_PHASE_UPDATE, i, update_norm,
+							   strided_matrix_norm(layer->weight_matrix, layer->num_nodes+1, layer->next_layer->num_nodes, layer->leading_dimension));
+			continue;
 		}
-		else{
-			print_vector(self->layer[i].weight_matrix, self->layer[i].num_nodes);
+		record_trace_event(TRACE_PHASE_UPDATE, i,
+						   strided_matrix_norm(layer->weight_update, layer->num_nodes+1, layer->next_layer->num_nodes, layer->leading_dimension),
+						   strided_matrix_norm(layer->weight_matrix, layer->num_nodes+1, layer->next_layer->num_nodes, layer->leading_dimension));
+	}
+	return;
+}
+
+void iterate_network( neural_network_t* self,
+					  double* input,
+					  double* true_decision )
+{
+	int traced;
+
+	//===Read Once So An Iteration Is Traced Whole Or Not At All===//
+	traced = TRACE_ENABLED();
+
+	//===Feed Forward===//
+	feed_forward(self, input);
+	if (traced){
+		trace_forward_pass(self, vector_norm(self->context->input, self->layer[0].num_nodes), 0);
+	}
+
+	//===Back Propagation===//
+	back_propagate(self, true_decision);
+	if (traced){
+		trace_backward_pass(self);
+	}
+
+	//===Update Weights===//
+	update_weights(self);	
+	if (traced){
+		trace_weight_update(self, 0, 0);
+	}
+
+	return;
+}
+
+void iterate_network_view( neural_network_t* self,
+						   input_view_t* view,
+						   size_t row,
+						   double* true_decision )
+{
+	int traced;
+	unsigned int i;
+	double input_norm;
+	double *input, *delta;
+	neural_layer_t* first;
+
+	if (view == NULL || view->base == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'view' Is Invalid! In Function -- iterate_network_view\n");
+		return;
+	}
+	input = view->base + row*view->row_stride + view->feature_offset;
+	if (self->mixed_precision != NULL || self->model_parallel != NULL){
+		iterate_network(self, input, true_decision);
+		return;
+	}
+	traced = TRACE_ENABLED();
+	input_norm = traced ? vector_norm(input, self->layer[0].num_nodes) : 0;
+
+	//===Forward And Backward===//
+	feed_forward_view(self, self->context, view, row);
+	if (traced){
+		trace_forward_pass(self, input_norm, 1);
+	}
+	back_propagate(self, true_decision);
+	if (traced){
+		trace_backward_pass(self);
+	}
+
+	//===Dense Layers===//
+	for (i=1; i<self->num_hidden_layers+2; i++){
+		update_weight_matrix(&(self->layer[i]), self->context);
+	}
+
+	//===First Layer: Rank One Update Reading The View, Then The Bias Row===//
+	first = &(self->layer[0]);
+	delta = self->context->layer[1].delta;
+	first->operation_backend[LAYER_OPERATION_UPDATE]->ger(first->num_nodes, first->next_layer->num_nodes, -self->learning_rate,
+														   input, delta, first->weight_matrix, first->leading_dimension);
+	first->operation_backend[LAYER_OPERATION_UPDATE]->axpy(first->next_layer->num_nodes, -self->learning_rate, delta,
+															first->weight_matrix + (size_t)first->num_nodes * first->leading_dimension);
+	if (first->weight_mask != NULL){
+		matrix_mask(first->weight_matrix, first->num_nodes+1, first->leading_dimension, first->weight_mask);
+		if (first->sparse_weights != NULL){
+			refresh_sparse_weights(first);
 		}
 	}
-#endif
+	mark_weights_changed(self);
+	if (traced){
+		trace_weight_update(self, input_norm, 1);
+	}
 
 	return;
 }
@@ -497,10 +1152,10 @@ void test_feed_forward(neural_network_t* self)
 
 	//===Print Inputs===//
 	fprintf(stdout, "Inputs: \n");
-	print_vector(self->layer[0].input, self->layer[0].num_nodes);
-	print_vector(self->layer[1].input, self->layer[1].num_nodes);
-	print_vector(self->layer[2].input, self->layer[2].num_nodes);
-	print_vector(self->layer[3].input, self->layer[3].num_nodes);
+	print_input(&(self->context->layer[0]));
+	print_input(&(self->context->layer[1]));
+	print_input(&(self->context->layer[2]));
+	print_input(&(self->context->layer[3]));
 
 	return;
 }
@@ -518,13 +1173,13 @@ void test_back_propagation(neural_network_t* self)
 	//===Back Propagate===//
 	for (i=0; i<self->num_hidden_layers+2; i++){
 		for (j=0; j<self->layer[i].num_nodes; j++){
-			self->layer[i].derivative[j] = 1;
+			self->context->layer[i].derivative[j] = 1;
 		}
 	}
 	
 	//===Create Error===//
 	for (i=0; i<self->layer[self->num_hidden_layers+1].num_nodes; i++){
-		temp = self->layer[self->num_hidden_layers+1].activation[i] - true_decision[i];
+		temp = self->output[i] - true_decision[i];
 		self->error[i] = temp;
 	}
 
@@ -532,17 +1187,17 @@ void test_back_propagation(neural_network_t* self)
 	delta2[0] = 1; delta2[1] = 2; delta2[2] = 3;
 	for (i=self->num_hidden_layers+1; i>0; i--){
 		if (i == self->num_hidden_layers){
-			set_delta(&(self->layer[i]), delta2);
+			set_delta(&(self->context->layer[i]), delta2);
 		}
-		feed_layer_backwards(&(self->layer[i]));
+		feed_layer_backwards(&(self->layer[i]), self->context);
 	}
 
 
 	//===Print Deltas===//
 	fprintf(stdout, "\nDeltas: \n");
-	print_vector(self->layer[1].delta, self->layer[1].num_nodes);
-	print_vector(self->layer[2].delta, self->layer[2].num_nodes);
-	print_vector(self->layer[3].delta, self->layer[3].num_nodes);
+	print_delta(&(self->context->layer[1]));
+	print_delta(&(self->context->layer[2]));
+	print_delta(&(self->context->layer[3]));
 
 
 	return;
@@ -555,7 +1210,7 @@ void test_weight_update(neural_network_t* self)
 	//===Set Activation To Inputs===//
 	for (i=0; i<self->num_hidden_layers+2; i++){
 		for (j=0; j<self->layer[i].num_nodes; j++){
-			self->layer[i].activation[j] = self->layer[i].input[j];
+			self->context->layer[i].activation[j] = self->context->layer[i].input[j];
 		}
 	}
 
@@ -564,17 +1219,426 @@ void test_weight_update(neural_network_t* self)
 
 	//===Print Weight Updates===//
 	fprintf(stdout, "\nWeight Updates: \n");
-	print_matrix(self->layer[0].weight_update, 4, 5);
-	print_matrix(self->layer[1].weight_update, 6, 3);
-	print_matrix(self->layer[2].weight_update, 4, 1);
+	print_strided_matrix(self->layer[0].weight_update, 4, 5, self->layer[0].leading_dimension);
+	print_strided_matrix(self->layer[1].weight_update, 6, 3, self->layer[1].leading_dimension);
+	print_strided_matrix(self->layer[2].weight_update, 4, 1, self->layer[2].leading_dimension);
 
 	return;
 }	
 
+void test_padded_storage()
+{
+	unsigned int i, j;
+	unsigned int num_nodes[4];
+	double input[3], decision[1];
+	neural_network_parameters_t* parameters;
+	neural_network_t *packed, *padded;
+
+	//===Create Identical Networks===//
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	packed = create_neural_network(parameters);
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	padded = create_neural_network(parameters);
+
+	//===Check Alignment===//
+	for (i=0; i<padded->num_hidden_layers+2; i++){
+		if (((size_t)padded->layer[i].weight_matrix) % WEIGHT_ALIGNMENT != 0){
+			fprintf(stderr, "Error: Padded Weight Matrix %d Is Not Aligned!\n", i);
+		}
+	}
+
+	//===Train Both===//
+	for (i=0; i<100; i++){
+		input[0] = 0.01*i; input[1] = 1.0 - 0.01*i; input[2] = 0.5;
+		decision[0] = (i % 2);
+		iterate_network(packed, input, decision);
+		iterate_network(padded, input, decision);
+	}
+
+	//===Outputs Must Agree===//
+	for (j=0; j<packed->layer[packed->num_hidden_layers+1].num_nodes; j++){
+		if (fabs(packed->output[j] - padded->output[j]) > 1e-12){
+			fprintf(stderr, "Error: Padded Storage Disagrees With Packed Storage!\n");
+		}
+	}
+
+	destroy_neural_network(packed);
+	destroy_neural_network(padded);
+	free(parameters);
+
+	return;
+}
+
+typedef struct test_inference_s{
+	neural_network_t* network;
+	double output[64];
+	unsigned int num_samples;
+} test_inference_t;
+
+void* test_inference_thread( void* argument )
+{
+	unsigned int i;
+	double input[3];
+	test_inference_t* test;
+	neural_context_t* context;
+
+	test = (test_inference_t*)argument;
+	context = create_neural_context(test->network);
+	for (i=0; i<test->num_samples; i++){
+		input[0] = 0.1*i; input[1] = 0.2*i; input[2] = 0.3*i;
+		feed_forward_context(test->network, context, input);
+		test->output[i] = context->output[0];
+	}
+	destroy_neural_context(context);
+
+	return NULL;
+}
+
+void test_concurrent_inference()
+{
+	unsigned int i, t;
+	double input[3];
+	unsigned int num_nodes[4];
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	pthread_t threads[4];
+	test_inference_t tests[4];
+
+	//===Create Shared Network===//
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	network = create_neural_network(parameters);
+
+	//===Run Threads===//
+	for (t=0; t<4; t++){
+		tests[t].network = network;
+		tests[t].num_samples = 64;
+		pthread_create(&(threads[t]), NULL, test_inference_thread, &(tests[t]));
+	}
+	for (t=0; t<4; t++){
+		pthread_join(threads[t], NULL);
+	}
+
+	//===Compare Against Serial Results===//
+	for (i=0; i<64; i++){
+		input[0] = 0.1*i; input[1] = 0.2*i; input[2] = 0.3*i;
+		feed_forward(network, input);
+		for (t=0; t<4; t++){
+			if (tests[t].output[i] != network->output[0]){
+				fprintf(stderr, "Error: Function feed_forward_context Has Failed!\n");
+			}
+		}
+	}
+
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
+
+void test_input_views()
+{
+	unsigned int i, j;
+	unsigned int num_nodes[4];
+	double dataset[6*9], input[3], decision[2];
+	neural_network_parameters_t* parameters;
+	neural_network_t *copied, *viewed;
+	input_view_t view;
+
+	//===Rows Of Nine Values; The Three Features Start At Column Four===//
+	num_nodes[0] = 3; num_nodes[1] = 6; num_nodes[2] = 4; num_nodes[3] = 2;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	copied = create_neural_network(parameters);
+	viewed = create_neural_network(parameters);
+	for (i=0; i<6*9; i++){
+		dataset[i] = sin(0.37*i);
+	}
+	view.base = dataset;
+	view.row_stride = 9;
+	view.feature_offset = 4;
+
+	//===Train On Copies And On The View===//
+	for (i=0; i<60; i++){
+		for (j=0; j<3; j++){
+			input[j] = dataset[(i%6)*9 + 4 + j];
+		}
+		decision[0] = (i % 2); decision[1] = 1 - decision[0];
+		iterate_network(copied, input, decision);
+		iterate_network_view(viewed, &view, i%6, decision);
+	}
+
+	//===Outputs Must Agree===//
+	for (i=0; i<6; i++){
+		for (j=0; j<3; j++){
+			input[j] = dataset[i*9 + 4 + j];
+		}
+		feed_forward(copied, input);
+		feed_forward_view(viewed, viewed->context, &view, i);
+		for (j=0; j<2; j++){
+			if (fabs(copied->output[j] - viewed->output[j]) > 1e-10){
+				fprintf(stderr, "Error: Function feed_forward_view Does Not Match feed_forward!\n");
+				i = 6;
+				break;
+			}
+		}
+	}
+
+	//===Mixed Precision Networks Take Their Own Passes===//
+	if (set_mixed_precision(copied, 1, 0, 1024, 1) != 0 || set_mixed_precision(viewed, 1, 0, 1024, 1) != 0){
+		fprintf(stderr, "Error: Function set_mixed_precision Has Failed!\n");
+	}
+	for (i=0; i<12; i++){
+		for (j=0; j<3; j++){
+			input[j] = dataset[(i%6)*9 + 4 + j];
+		}
+		decision[0] = (i % 2); decision[1] = 1 - decision[0];
+		iterate_network(copied, input, decision);
+		iterate_network_view(viewed, &view, i%6, decision);
+	}
+	feed_forward(copied, input);
+	feed_forward_view(viewed, viewed->context, &view, 5);
+	for (j=0; j<2; j++){
+		if (fabs(copied->output[j] - viewed->output[j]) > 1e-10){
+			fprintf(stderr, "Error: Function feed_forward_view Ignores Mixed Precision!\n");
+			break;
+		}
+	}
+
+	destroy_neural_network(copied);
+	destroy_neural_network(viewed);
+	free(parameters);
+
+	return;
+}
+
+void test_incremental_inference()
+{
+	unsigned int i, j, n, num_nodes[4];
+	double input[40];
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	neural_context_t* context;
+	incremental_state_t state;
+
+	num_nodes[0] = 40; num_nodes[1] = 24; num_nodes[2] = 12; num_nodes[3] = 3;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->activation[3] = ACTIVATION_SOFTMAX;
+	network = create_neural_network(parameters);
+	context = create_neural_context(network);
+	if (initialize_incremental_state(network, context, 16, 0, &state) != 0){
+		fprintf(stderr, "Error: Function initialize_incremental_state Has Failed!\n");
+		destroy_neural_context(context);
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+
+	//===A Stream Where Few Features Change Per Frame, Then One Where All Do===//
+	for (i=0; i<40; i++){
+		input[i] = cos(0.3*i);
+	}
+	for (n=0; n<48; n++){
+		if (n < 40){
+			input[(7*n) % 40] += 0.25*sin(n);
+			input[(3*n + 1) % 40] -= 0.1;
+		}
+		else{
+			for (i=0; i<40; i++){
+				input[i] = sin(0.1*n + i);
+			}
+		}
+		feed_forward_incremental(network, &state, input);
+		feed_forward(network, input);
+		for (j=0; j<3; j++){
+			if (fabs(context->output[j] - network->output[j]) > 1e-10){
+				fprintf(stderr, "Error: Function feed_forward_incremental Does Not Match feed_forward!\n");
+				n = 48;
+				break;
+			}
+		}
+	}
+
+	//===First Frame, Every 16th, And The Dense Frames Recompute; Nothing Else Does===//
+	if (state.num_refreshes != 3 + 8){
+		fprintf(stderr, "Error: Function feed_forward_incremental Recomputed %u Times!\n", state.num_refreshes);
+	}
+
+	destroy_neural_context(context);
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
+
+void test_activation_kernels()
+{
+	unsigned int a, i;
+	double input[5], activation[5], derivative[5];
+	double upper[5], lower[5], scratch[5];
+	compute_backend_t* backend;
+
+	backend = get_compute_backend(COMPUTE_BACKEND_PORTABLE);
+	input[0] = -2; input[1] = -0.5; input[2] = 0.25; input[3] = 1; input[4] = 3;
+
+	//===Derivatives Must Match Finite Differences (Softmax Has No Elementwise Derivative)===//
+	for (a=0; a<NUM_ACTIVATIONS; a++){
+		if (a == ACTIVATION_SOFTMAX){
+			continue;
+		}
+		backend->activate[a](input, activation, derivative, 5);
+		for (i=0; i<5; i++){
+			upper[i] = input[i] + 1e-6;
+			lower[i] = input[i] - 1e-6;
+		}
+		backend->activate[a](upper, upper, scratch, 5);
+		backend->activate[a](lower, lower, scratch, 5);
+		for (i=0; i<5; i++){
+			if (fabs((upper[i] - lower[i])/2e-6 - derivative[i]) > 1e-5){
+				fprintf(stderr, "Error: Activation Kernel %d Has Failed!\n", a);
+				break;
+			}
+		}
+	}
+
+	//===ReLU Clamps Negatives===//
+	backend->activate[ACTIVATION_RELU](input, activation, derivative, 5);
+	if (activation[0] != 0 || activation[1] != 0 || activation[4] != 3){
+		fprintf(stderr, "Error: Function relu_kernel Has Failed!\n");
+	}
+
+	return;
+}
+
+void test_softmax_cross_entropy()
+{
+	unsigned int i;
+	double logits[6], labels[6], probabilities[6], gradient[6];
+	double shifted[6], scratch[6], loss, upper, lower;
+
+	//===Two Samples, Three Classes, One With Huge Logits===//
+	logits[0] = 1; logits[1] = 2; logits[2] = 3;
+	logits[3] = 1000; logits[4] = 1001; logits[5] = 999;
+	labels[0] = 0; labels[1] = 0; labels[2] = 1;
+	labels[3] = 0; labels[4] = 1; labels[5] = 0;
+	loss = softmax_cross_entropy(logits, labels, probabilities, gradient, 2, 3);
+	if (isnan(loss) || fabs(probabilities[3] + probabilities[4] + probabilities[5] - 1) > 1e-12){
+		fprintf(stderr, "Error: Function softmax_cross_entropy Is Not Stable!\n");
+	}
+
+	//===Gradient Of Mean Loss Is (p - y)/batch_size===//
+	for (i=0; i<6; i++){
+		memcpy(shifted, logits, sizeof(logits));
+		shifted[i] += 1e-6;
+		upper = softmax_cross_entropy(shifted, labels, scratch, NULL, 2, 3);
+		shifted[i] -= 2e-6;
+		lower = softmax_cross_entropy(shifted, labels, scratch, NULL, 2, 3);
+		if (fabs((upper - lower)/2e-6 - gradient[i]/2) > 1e-5){
+			fprintf(stderr, "Error: Function softmax_cross_entropy Gradient Has Failed!\n");
+			break;
+		}
+	}
+
+	return;
+}
+
+void test_training_trace()
+{
+	unsigned int i, n, num_nodes[4], indices[2];
+	long num_events;
+	char filename[64];
+	double input[3], label;
+	FILE* stream;
+	input_view_t view;
+	sparse_vector_t sparse_input;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.1);
+	network = create_neural_network(parameters);
+	reset_tracing();
+
+	//===Only The Two Traced Iterations Record: 1 + 4 Forward + 3 Backward + 3 Update Events Each===//
+	for (n=0; n<6; n++){
+		if (n == 3){
+			enable_tracing(0);
+		}
+		if (n == 5){
+			disable_tracing();
+		}
+		for (i=0; i<3; i++){
+			input[i] = sin(n + i);
+		}
+		label = n % 2;
+		iterate_network(network, input, &label);
+	}
+
+	//===A View And A Sparse Iteration Record The Same 11 Events===//
+	view.base = input;
+	view.row_stride = 3;
+	view.feature_offset = 0;
+	indices[0] = 0; indices[1] = 2;
+	sparse_input.indices = indices;
+	sparse_input.values = input;
+	sparse_input.num_nonzeros = 2;
+	enable_tracing(0);
+	iterate_network_view(network, &view, 0, &label);
+	iterate_network_sparse(network, &sparse_input, &label);
+	disable_tracing();
+
+	snprintf(filename, sizeof(filename), "/tmp/test_training_trace_%d", (int)getpid());
+	stream = fopen("/dev/null", "w");
+	if (stream == NULL || write_trace_file(filename) != 0){
+		fprintf(stderr, "Error: Function write_trace_file Has Failed!\n");
+		if (stream != NULL){
+			fclose(stream);
+		}
+		unlink(filename);
+		reset_tracing();
+		destroy_neural_network(network);
+		free(parameters);
+		return;
+	}
+	num_events = decode_trace_file(filename, stream);
+	fclose(stream);
+	if (num_events != 44){
+		fprintf(stderr, "Error: Function iterate_network Traced %ld Events!\n", num_events);
+	}
+	unlink(filename);
+
+	reset_tracing();
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
+
 void test_neural_network()
 {
 
 	neural_network_t* self;
+
+	//===Test Activation Kernels===//
+	test_activation_kernels();
+
+	//===Test Softmax Cross-Entropy===//
+	test_softmax_cross_entropy();
+
+	//===Test Padded Storage===//
+	test_padded_storage();
+
+	//===Test Concurrent Inference===//
+	test_concurrent_inference();
+
+	//===Test Input Views===//
+	test_input_views();
+	test_incremental_inference();
+
+	//===Test Training Trace===//
+	test_training_trace();
+
 	self = create_test_neural_network();
 
 	//===Test Feed Forward===//
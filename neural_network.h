@@ -10,7 +10,10 @@
 #include <errno.h>
 #include <float.h>
 #include <math.h>
-#include "cblas.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include "random.h"
+#include "trace.h"
 
 
 //================================================================================================//
@@ -23,11 +26,18 @@
 #define UNIT_TESTS 0
 #define DEBUG 0
 
-#define MAX_LAYER_NODES 10
+#define MAX_LAYER_NODES 4096
 #define MIN_HIDDEN_LAYERS 1
 #define MAX_HIDDEN_LAYERS 10
 #define MAX_LAYERS MAX_HIDDEN_LAYERS+2
 
+#define LEAKY_RELU_SLOPE 0.01
+
+#define WEIGHT_ALIGNMENT 64
+#define SIMD_WIDTH (WEIGHT_ALIGNMENT/sizeof(double))
+
+#define INCREMENTAL_REFRESH_INTERVAL 256
+
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
 
@@ -37,44 +47,265 @@
 //======================================Data Structures===========================================//
 //================================================================================================//
 
+//================================================================================================//
+/** @enum weight_storage_t
+*   @brief This enumeration selects how weight matrices are laid out in memory.
+*
+*	WEIGHT_STORAGE_PACKED stores rows back to back. WEIGHT_STORAGE_PADDED starts every matrix on
+*	a WEIGHT_ALIGNMENT boundary and rounds each row up to a multiple of SIMD_WIDTH, with the
+*	padding held at zero, so kernels can run full-width aligned vector loops.
+*/
+//================================================================================================//
+typedef enum weight_storage_e{
+	WEIGHT_STORAGE_PACKED,
+	WEIGHT_STORAGE_PADDED
+} weight_storage_t;
+
+
+//================================================================================================//
+/** @enum activation_function_t
+*   @brief This enumeration selects the activation function of a layer.
+*
+*	Each value indexes a whole-vector kernel that writes a layer's activations and derivatives in
+*	one pass. ReLU and leaky ReLU need no transcendental functions. ACTIVATION_SOFTMAX is only
+*	allowed on the output layer, where it is trained with cross-entropy loss.
+*/
+//================================================================================================//
+typedef enum activation_function_e{
+	ACTIVATION_IDENTITY,
+	ACTIVATION_SIGMOID,
+	ACTIVATION_TANH,
+	ACTIVATION_RELU,
+	ACTIVATION_LEAKY_RELU,
+	ACTIVATION_SOFTMAX,
+	NUM_ACTIVATIONS
+} activation_function_t;
+
+typedef void (*activation_kernel_t)(double*, double*, double*, unsigned int);
+
+
+//================================================================================================//
+/** @enum compute_backend_type_t
+*   @brief This enumeration selects the kernels a network computes with.
+*
+*	COMPUTE_BACKEND_CBLAS calls a CBLAS library found at run time, COMPUTE_BACKEND_PORTABLE is
+*	plain C and COMPUTE_BACKEND_SIMD is AVX2/FMA code used only on CPUs that support it.
+*	COMPUTE_BACKEND_AUTO picks the first of those that is available. The last two are variants
+*	for the autotuner: COMPUTE_BACKEND_UNROLLED is plain C unrolled for small shapes and
+*	COMPUTE_BACKEND_SIMD_BLOCKED is the SIMD backend with a cache blocked gemm.
+*/
+//================================================================================================//
+typedef enum compute_backend_type_e{
+	COMPUTE_BACKEND_AUTO,
+	COMPUTE_BACKEND_CBLAS,
+	COMPUTE_BACKEND_PORTABLE,
+	COMPUTE_BACKEND_SIMD,
+	COMPUTE_BACKEND_UNROLLED,
+	COMPUTE_BACKEND_SIMD_BLOCKED,
+	NUM_COMPUTE_BACKENDS
+} compute_backend_type_t;
+
+//===C = alpha*A*B + beta*C, Row Major===//
+typedef void (*gemm_kernel_t)(int, int, int, double, double*, int, double*, int, double, double*, int);
+
+//===y = alpha*A*x + beta*y, Row Major===//
+typedef void (*gemv_kernel_t)(int, int, double, double*, int, double*, double, double*);
+
+//===A += alpha*x*y^T, Row Major===//
+typedef void (*ger_kernel_t)(int, int, double, double*, double*, double*, int);
+
+//===y += alpha*x===//
+typedef void (*axpy_kernel_t)(int, double, double*, double*);
+
+//===Single Precision gemm And gemv For Mixed-Precision Passes===//
+typedef void (*sgemm_kernel_t)(int, int, int, float, float*, int, float*, int, float, float*, int);
+typedef void (*sgemv_kernel_t)(int, int, float, float*, int, float*, float, float*);
+
+
+//================================================================================================//
+/** @enum layer_operation_t
+*   @brief This enumeration names the weight matrix products of a layer.
+*
+*	Each product may run on a different backend, so the fastest one can be chosen per shape.
+*/
+//================================================================================================//
+typedef enum layer_operation_e{
+	LAYER_OPERATION_FORWARD,
+	LAYER_OPERATION_BACKWARD,
+	LAYER_OPERATION_UPDATE,
+	NUM_LAYER_OPERATIONS
+} layer_operation_t;
+
+
+//================================================================================================//
+/** @struct compute_backend_t
+*   @brief This structure comprises one set of compute kernels.
+*
+*	Backends are static tables obtained from get_compute_backend; they are never freed. When
+*	beta is zero, gemm and gemv do not read their output. sgemm and sgemv are the single
+*	precision forms of gemm and gemv.
+*/
+//================================================================================================//
+typedef struct compute_backend_s compute_backend_t;
+typedef struct compute_backend_s{
+	compute_backend_type_t type;
+	const char* name;
+	gemm_kernel_t gemm;
+	gemv_kernel_t gemv;
+	ger_kernel_t ger;
+	axpy_kernel_t axpy;
+	sgemm_kernel_t sgemm;
+	sgemv_kernel_t sgemv;
+	activation_kernel_t activate[NUM_ACTIVATIONS];
+} compute_backend_t;
+
+typedef struct sparse_matrix_s sparse_matrix_t;
+typedef struct model_parallel_s model_parallel_t;
+typedef struct mixed_precision_s mixed_precision_t;
+
+
 //================================================================================================//
 /** @struct neural_layer_t
 *   @brief This structure comprises the functionality of a neural network layer.
 *
+*	A layer only holds read-only model data: topology, weights and activation functions. The
+*	values that change on every pass live in a layer_state_t inside a neural_context_t. A pruned
+*	layer also has a weight_mask and may keep a CSR copy of its weights for the forward pass.
+*	The backend is the network's and supplies the layer's activation kernel; the products with
+*	the layer's weight matrix run on operation_backend, which the autotuner may change.
+*	weight_version points at the network's counter, which every weight update advances.
 */
 //================================================================================================//
 typedef struct neural_layer_s neural_layer_t;
 typedef struct neural_layer_s{
-	double input[MAX_LAYER_NODES];
-	double activation[MAX_LAYER_NODES+1];
-	double derivative[MAX_LAYER_NODES+1];
-	double weight_matrix[(MAX_LAYER_NODES+1)*(MAX_LAYER_NODES+1)];
-	double weight_update[(MAX_LAYER_NODES+1)*(MAX_LAYER_NODES+1)];
-	double delta[MAX_LAYER_NODES];
+	double* weight_matrix;
+	double* weight_update;
+	double* weight_mask;
+	sparse_matrix_t* sparse_weights;
 	neural_layer_t* previous_layer;
 	neural_layer_t* next_layer;
-	double (*activate)(double);
-	double (*derivate)(double);
+	compute_backend_t* backend;
+	compute_backend_t* operation_backend[NUM_LAYER_OPERATIONS];
+	activation_function_t activation;
 	double* learning_rate;
+	_Atomic uint64_t* weight_version;
+	unsigned int index;
 	unsigned int num_nodes;
+	unsigned int leading_dimension;
+	int use_sparse_weights;
 } neural_layer_t;
 
 
+//================================================================================================//
+/** @struct layer_state_t
+*   @brief This structure comprises the per-pass buffers of one neural network layer.
+*
+*/
+//================================================================================================//
+typedef struct layer_state_s layer_state_t;
+typedef struct layer_state_s{
+	double* input;
+	double* activation;
+	double* derivative;
+	double* delta;
+	unsigned int num_nodes;
+} layer_state_t;
+
+
+//================================================================================================//
+/** @struct neural_context_t
+*   @brief This structure comprises the execution context of a neural network.
+*
+*	A context holds every buffer a forward or backward pass writes to, sized to one network's
+*	topology in a single aligned arena. Threads sharing a network each use their own context
+*	and may then run feed_forward_context concurrently without locking.
+*/
+//================================================================================================//
+typedef struct neural_context_s neural_context_t;
+typedef struct neural_context_s{
+	layer_state_t layer[MAX_LAYERS];
+	double* input;
+	double* output;
+	double* error;
+	double* arena;
+	unsigned int num_layers;
+} neural_context_t;
+
+
+//================================================================================================//
+/** @struct input_view_t
+*   @brief This structure comprises a strided view of input rows held in caller memory.
+*
+*	Row r starts at base + r*row_stride + feature_offset and its features are contiguous. A view
+*	over a dataset (or an mmapped file) lets the first layer read inputs in place, with no copy
+*	into the context.
+*/
+//================================================================================================//
+typedef struct input_view_s input_view_t;
+typedef struct input_view_s{
+	double* base;
+	size_t row_stride;
+	size_t feature_offset;
+} input_view_t;
+
+
+//================================================================================================//
+/** @struct incremental_state_t
+*   @brief This structure comprises the first-layer cache of a stream fed through one context.
+*
+*	The context's first hidden layer pre-activation stays valid between frames, and its input
+*	buffer holds the last frame. A new frame only adds (x_new - x_old) times the weight rows of
+*	the features that changed. Every refresh_interval frames, or when more than max_changed
+*	features change, the product is recomputed in full so rounding drift stays bounded. A change
+*	of the network's weight_version also forces a full recompute.
+*/
+//================================================================================================//
+typedef struct incremental_state_s incremental_state_t;
+typedef struct incremental_state_s{
+	neural_context_t* context;
+	unsigned int refresh_interval;
+	unsigned int max_changed;
+	unsigned int frames_since_refresh;
+	unsigned int num_refreshes;
+	uint64_t weight_version;
+	int valid;
+} incremental_state_t;
+
+
 //================================================================================================//
 /** @struct neural_network_t
 *   @brief This structure comprises the functionality of a neural network.
 *
-*	This object coordinates the activities of multiple neural_layer_t objects.
+*	This object coordinates the activities of multiple neural_layer_t objects. All weight matrices
+*	live in one WEIGHT_ALIGNMENT aligned arena, and all weight updates in a second one. The
+*	network owns one neural_context_t used by training and by feed_forward; input, output and
+*	error point into it. loss holds the loss of the last back propagation: cross-entropy for a
+*	softmax output layer, half the squared error otherwise. With model_parallel set,
+*	feed_forward, back_propagate and update_weights split wide layers across the thread pool;
+*	with mixed_precision set, they run their products in float.
+*	weight_version changes whenever the weights do, so caches of outputs can tell they are stale.
 */
 //================================================================================================//
 typedef struct neural_network_s neural_network_t;
 typedef struct neural_network_s{
 	neural_layer_t layer[MAX_HIDDEN_LAYERS+2];
+	neural_context_t* context;
 	double* input;
 	double* output;
 	double* error;
+	double loss;
+	double* weight_arena;
+	double* update_arena;
+	double* mask_arena;
+	size_t arena_size;
 	double learning_rate;
 	unsigned int num_hidden_layers;
+	weight_storage_t weight_storage;
+	compute_backend_t* backend;
+	model_parallel_t* model_parallel;
+	mixed_precision_t* mixed_precision;
+	uint64_t seed;
+	_Atomic uint64_t weight_version;
 } neural_network_t;
 
 
@@ -82,14 +313,23 @@ typedef struct neural_network_s{
 /** @struct neural_network_parameters_t
 *   @brief This structure comprises the creation parameters of a neural network.
 *
-*	Use this structure to initialize a neural network.
+*	Use this structure to initialize a neural network. The seed defaults to RANDOM_DEFAULT_SEED;
+*	overwrite it after creation for a different (but still reproducible) initialization. The
+*	weight storage defaults to WEIGHT_STORAGE_PACKED and the backend to COMPUTE_BACKEND_AUTO.
+*	If autotune is set, each layer's products are tuned for single samples at creation using the
+*	default autotune cache. Layer activations default to sigmoid; the input layer is always ACTIVATION_IDENTITY.
 */
 //================================================================================================//
 typedef struct neural_network_parameters_s neural_network_parameters_t;
 typedef struct neural_network_parameters_s{
 	unsigned int num_nodes[MAX_HIDDEN_LAYERS+2];
+	activation_function_t activation[MAX_HIDDEN_LAYERS+2];
 	unsigned int num_hidden_layers;
 	double learning_rate;
+	weight_storage_t weight_storage;
+	compute_backend_type_t backend;
+	int autotune;
+	uint64_t seed;
 } neural_network_parameters_t; 
 
 
@@ -106,28 +346,34 @@ typedef struct neural_network_parameters_s{
 * If errors occur, the function exits.
 *
 * @param[in,out] neural_layer_t* self
+* @param[in] unsigned int index
 * @param[in] unsigned int num_nodes
+* @param[in] activation_function_t activation
 * @param[in] neural_layer_t* previous_layer
 * @param[in] neural_layer_t* next_layer
 *
 * @return neural_layer_t* self
 */
 //================================================================================================//
-void initialize_neural_layer(neural_layer_t*, unsigned int, neural_layer_t*, neural_layer_t*);
+void initialize_neural_layer(neural_layer_t*, unsigned int, unsigned int, activation_function_t, neural_layer_t*, neural_layer_t*);
 
 
 //================================================================================================//
 /**
 * @brief This function initializes a neural_layer_t's weight matrix.
 *
+* Each weight is drawn from a counter-based generator keyed by (key, element index), so the
+* result is reproducible and any block of the matrix can be filled independently.
+*
 * If errors occur, the function exits.
 *
 * @param[in,out] neural_layer_t* self
+* @param[in] uint64_t key
 *
 * @return NONE
 */
 //================================================================================================//
-void initialize_weight_matrix(neural_layer_t*);
+void initialize_weight_matrix(neural_layer_t*, uint64_t);
 
 
 void print_weight_matrix( neural_layer_t* self );
@@ -136,6 +382,8 @@ void print_weight_matrix( neural_layer_t* self );
 /**
 * @brief This function sets a neural_layer_t's weight matrix.
 *
+* The input matrix is packed row major; it is copied into the layer's storage layout.
+*
 * If errors occur, the function exits.
 *
 * @param[in,out] neural_layer_t* self
@@ -151,14 +399,34 @@ void set_weight_matrix(neural_layer_t*, double*);
 /**
 * @brief This function feeds data through a neural_layer_t forward.
 *
+* The layer is only read; all results are written to the context.
+*
 * If errors occur, the function exits.
 *
-* @param[in,out] neural_layer_t* self
+* @param[in] neural_layer_t* self
+* @param[in,out] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_layer_forward(neural_layer_t*, neural_context_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function feeds a neural_layer_t's delta back to the previous layer.
+*
+* The previous layer's delta in the context is overwritten.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_layer_t* self
+* @param[in,out] neural_context_t* context
 *
 * @return NONE
 */
 //================================================================================================//
-void feed_layer_forward(neural_layer_t*);
+void feed_layer_backwards(neural_layer_t*, neural_context_t*);
 
 
 //================================================================================================//
@@ -191,13 +459,198 @@ neural_network_parameters_t* create_neural_network_parameters(unsigned int, unsi
 neural_network_t* create_neural_network(neural_network_parameters_t*);
 
 
+//================================================================================================//
+/**
+* @brief This function frees a neural_network_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_neural_network(neural_network_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a neural_context_t object for a neural_network_t.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+*
+* @return neural_context_t* self
+*/
+//================================================================================================//
+neural_context_t* create_neural_context(neural_network_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function frees a neural_context_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_context_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_neural_context(neural_context_t*);
+
+
 void print_weight_matrices(neural_network_t*);
 
 
+//================================================================================================//
+/**
+* @brief This function writes the output error of a context and returns its loss.
+*
+* The error is p - y. The loss is the cross-entropy for a softmax output layer and half the
+* squared error otherwise. feed_forward_context must have been run on the context.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* true_decision
+*
+* @return double loss
+*/
+//================================================================================================//
+double compute_output_error(neural_network_t*, neural_context_t*, double*);
+
+
+//================================================================================================//
+/**
+* @brief This function back propagates the error of the last forward pass.
+*
+* Deltas are computed for every layer except the input layer, which has no incoming weights.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double* true_decision
+*
+* @return NONE
+*/
+//================================================================================================//
+void back_propagate(neural_network_t*, double*);
+
+
+//================================================================================================//
+/**
+* @brief This function applies one gradient step to a neural_layer_t's outgoing weights.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_layer_t* self
+* @param[in] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void update_weight_matrix(neural_layer_t*, neural_context_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function writes the gradient of a neural_layer_t's outgoing weights.
+*
+* The gradient is taken from the activations and deltas held in the context and written to the
+* layer's weight_update.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_layer_t* self
+* @param[in] neural_context_t* context
+*
+* @return NONE
+*/
+//================================================================================================//
+void compute_weight_gradient(neural_layer_t*, neural_context_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function adds update_weight times a gradient to a neural_layer_t's weights.
+*
+* The gradient has the layout of the layer's weight matrix. A pruning mask is reapplied.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_layer_t* self
+* @param[in] double* gradient
+* @param[in] double update_weight
+*
+* @return NONE
+*/
+//================================================================================================//
+void apply_weight_gradient(neural_layer_t*, double*, double);
+
+
+//================================================================================================//
+/**
+* @brief This function applies one gradient step to every layer of a neural_network_t.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void update_weights(neural_network_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function writes the gradient of every layer into the network's update arena.
+*
+* It is the first half of update_weights, for callers that combine gradients before applying
+* them. back_propagate must have been run.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void compute_weight_gradients(neural_network_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function adds update_weight times a gradient to every layer's weights.
+*
+* The gradient has the weight arena's layout. Pruning masks are reapplied.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double* gradient
+* @param[in] double update_weight
+*
+* @return NONE
+*/
+//================================================================================================//
+void apply_weight_gradients(neural_network_t*, double*, double);
+
+
 //================================================================================================//
 /**
 * @brief This function runs an update iteration for the neural_network_t object.
 *
+* While tracing is enabled each iteration records an iteration event (norm of the input), a
+* forward event per layer (norms of its activation and input), a backward event per layer
+* from the output down (norm of its delta; the output layer's value is the loss) and an
+* update event per weight matrix (norms of its weight update and weights). iterate_network_view
+* and iterate_network_sparse record the same events; pipeline_train and train_data_parallel
+* record none.
+*
 * If errors occur, the function exits.
 *
 * @param[in,out] neural_network_t* self
@@ -210,9 +663,305 @@ void print_weight_matrices(neural_network_t*);
 void iterate_network(neural_network_t*, double*, double*);
 
 
+//================================================================================================//
+/**
+* @brief This function records the iteration and forward events of an iteration.
+*
+* Layers below first_layer were not fed through the context, so their forward event holds
+* input_norm as both norms.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in] double input_norm
+* @param[in] unsigned int first_layer
+*
+* @return NONE
+*/
+//================================================================================================//
+void trace_forward_pass(neural_network_t*, double, unsigned int);
+
+
+//================================================================================================//
+/**
+* @brief This function records the backward events of an iteration.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void trace_backward_pass(neural_network_t*);
+
+
+//================================================================================================//
+/**
+* @brief This function records the update events of an iteration.
+*
+* Layers below first_layer did not fill their weight_update, so its norm is taken from
+* input_norm and the next layer's delta instead.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in] double input_norm
+* @param[in] unsigned int first_layer
+*
+* @return NONE
+*/
+//================================================================================================//
+void trace_weight_update(neural_network_t*, double, unsigned int);
+
+
+//================================================================================================//
+/**
+* @brief This function applies a numerically stable softmax to each row of a batch.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* logits
+* @param[out] double* probabilities
+* @param[in] unsigned int batch_size
+* @param[in] unsigned int num_classes
+*
+* @return NONE
+*/
+//================================================================================================//
+void softmax_rows( double* logits,
+				   double* probabilities,
+				   unsigned int batch_size,
+				   unsigned int num_classes );
+
+
+//================================================================================================//
+/**
+* @brief This function computes softmax, cross-entropy loss and its gradient in one fused pass.
+*
+* The gradient with respect to the logits is written directly as p - y, so the softmax Jacobian is
+* never formed. Rows are samples; pass batch_size 1 for a single sample. The gradient may be NULL.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* logits
+* @param[in] double* labels
+* @param[out] double* probabilities
+* @param[out] double* gradient
+* @param[in] unsigned int batch_size
+* @param[in] unsigned int num_classes
+*
+* @return double mean_loss
+*/
+//================================================================================================//
+double softmax_cross_entropy( double* logits,
+							  double* labels,
+							  double* probabilities,
+							  double* gradient,
+							  unsigned int batch_size,
+							  unsigned int num_classes );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds an input through a neural_network_t using the network's own context.
+*
+* The result is left in self->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double* input
+*
+* @return NONE
+*/
+//================================================================================================//
 void feed_forward( neural_network_t* self, 
 				   double* input );
 
+
+//================================================================================================//
+/**
+* @brief This function feeds an input through a neural_network_t using a caller owned context.
+*
+* The network is only read, so any number of threads may call this on one network at once as
+* long as each uses its own context. The result is left in context->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* input
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_forward_context( neural_network_t* self,
+						   neural_context_t* context,
+						   double* input );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds row 'row' of an input view through the network using a context.
+*
+* The first layer's product reads the row in place; context->input is not written, so the
+* first layer's activation buffer is not filled either. Mixed precision and model parallel
+* networks copy the row into context->input and run their own pass. The result is left in
+* context->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] input_view_t* view
+* @param[in] size_t row
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_forward_view( neural_network_t* self,
+						neural_context_t* context,
+						input_view_t* view,
+						size_t row );
+
+
+//================================================================================================//
+/**
+* @brief This function runs an update iteration on row 'row' of an input view.
+*
+* The first layer's weight update also reads the row in place. Mixed precision and model
+* parallel networks train on the row through iterate_network. Traced like iterate_network.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] input_view_t* view
+* @param[in] size_t row
+* @param[in] double* true_decision
+*
+* @return NONE
+*/
+//================================================================================================//
+void iterate_network_view( neural_network_t* self,
+						   input_view_t* view,
+						   size_t row,
+						   double* true_decision );
+
+
+//================================================================================================//
+/**
+* @brief This function prepares an incremental_state_t for a stream fed through a context.
+*
+* A refresh_interval of 0 means INCREMENTAL_REFRESH_INTERVAL frames between full recomputes;
+* a max_changed of 0 means a quarter of the input features. The first frame is always full.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] neural_context_t* context
+* @param[in] unsigned int refresh_interval
+* @param[in] unsigned int max_changed
+* @param[out] incremental_state_t* state
+*
+* @return int status (0 on success, -1 on error)
+*/
+//================================================================================================//
+int initialize_incremental_state( neural_network_t* network,
+								  neural_context_t* context,
+								  unsigned int refresh_interval,
+								  unsigned int max_changed,
+								  incremental_state_t* state );
+
+
+//================================================================================================//
+/**
+* @brief This function forces the next incremental frame to recompute the first layer in full.
+*
+* Weight updates that advance the network's weight_version are noticed without it; call it
+* after changing weights by any other means.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] incremental_state_t* state
+*
+* @return NONE
+*/
+//================================================================================================//
+void invalidate_incremental_state( incremental_state_t* state );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds the next frame of a stream through the network incrementally.
+*
+* Only the first layer is updated in place: past the first activation almost every unit
+* changes, so deeper layers are recomputed as usual. Beyond an O(n) scan for changed features,
+* the first layer costs one weight row per changed feature. The result is left in
+* state->context->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in,out] incremental_state_t* state
+* @param[in] double* input
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_forward_incremental( neural_network_t* self,
+							   incremental_state_t* state,
+							   double* input );
+
+
+//================================================================================================//
+/**
+* @brief This function advances the weight version after the weights are changed in place.
+*
+* The update functions do this themselves; call it after writing the weight arena directly.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void mark_weights_changed( neural_network_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function returns the current weight version of a neural_network_t.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+*
+* @return uint64_t weight_version
+*/
+//================================================================================================//
+uint64_t get_weight_version( neural_network_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function initializes a random stream for one worker thread of a neural_network_t.
+*
+* Streams are derived from the network seed, so shuffling stays reproducible and each
+* thread draws from its own non-overlapping sequence.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in] unsigned int thread_id
+* @param[out] random_stream_t* stream
+*
+* @return NONE
+*/
+//================================================================================================//
+void initialize_thread_random_stream(neural_network_t*, unsigned int, random_stream_t*);
+
 //================================================================================================//
 /**
 * @brief This function runs the unit test for the neural_network_t object
@@ -0,0 +1,583 @@
+#include "pipeline.h"
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//=====================================Queue Functions============================================//
+//================================================================================================//
+
+static void initialize_spsc_queue( spsc_queue_t* self )
+{
+	atomic_init(&(self->head), 0);
+	atomic_init(&(self->tail), 0);
+	return;
+}
+
+static int spsc_queue_push( spsc_queue_t* self,
+							unsigned int item )
+{
+	size_t tail;
+
+	tail = atomic_load_explicit(&(self->tail), memory_order_relaxed);
+	if (tail - atomic_load_explicit(&(self->head), memory_order_acquire) == MAX_MICRO_BATCHES){
+		return -1;
+	}
+	self->item[tail % MAX_MICRO_BATCHES] = item;
+
+	//===Release Publishes The Item And Everything Written Before It===//
+	atomic_store_explicit(&(self->tail), tail + 1, memory_order_release);
+
+	return 0;
+}
+
+static int spsc_queue_pop( spsc_queue_t* self,
+						   unsigned int* item )
+{
+	size_t head;
+
+	head = atomic_load_explicit(&(self->head), memory_order_relaxed);
+	if (head == atomic_load_explicit(&(self->tail), memory_order_acquire)){
+		return -1;
+	}
+	*item = self->item[head % MAX_MICRO_BATCHES];
+	atomic_store_explicit(&(self->head), head + 1, memory_order_release);
+
+	return 0;
+}
+
+//===Capacity Is MAX_MICRO_BATCHES And A Batch Never Has More Tokens, So A Push Cannot Fail===//
+static void send_token( spsc_queue_t* queue,
+						sem_t* ready,
+						unsigned int micro_batch )
+{
+	if (spsc_queue_push(queue, micro_batch) != 0){
+		fprintf(stderr, "Error:: Pipeline Queue Is Full! In Function -- send_token\n");
+		return;
+	}
+	sem_post(ready);
+	return;
+}
+
+//================================================================================================//
+//=====================================Stage Functions============================================//
+//================================================================================================//
+
+static double seconds_between( struct timespec* start,
+							   struct timespec* stop )
+{
+	return (stop->tv_sec - start->tv_sec) + 1e-9*(stop->tv_nsec - start->tv_nsec);
+}
+
+static void run_stage_backward( pipeline_stage_t* self,
+								unsigned int micro_batch )
+{
+	unsigned int i, l, output_layer;
+	double update_weight;
+	neural_layer_t* layer;
+	neural_context_t* context;
+	pipeline_t* pipeline;
+	neural_network_t* network;
+
+	pipeline = self->pipeline;
+	network = pipeline->network;
+	output_layer = network->num_hidden_layers+1;
+
+	//===Deltas Leaving This Stage Were Written Into The Same Contexts By The Next Stage===//
+	for (i=0; i<pipeline->micro_batch_size; i++){
+		context = pipeline->contexts[micro_batch*pipeline->micro_batch_size + i];
+		for (l=self->last_layer+1; l-- > self->first_layer;){
+			layer = &(network->layer[l]);
+			if (layer->next_layer != NULL){
+				compute_weight_gradient(layer, context);
+				layer->operation_backend[LAYER_OPERATION_UPDATE]->axpy((layer->num_nodes+1) * layer->leading_dimension, 1.0,
+																	   layer->weight_update,
+																	   pipeline->gradient_arena + (layer->weight_matrix - network->weight_arena));
+			}
+			if (l >= 1 && l < output_layer){
+				feed_layer_backwards(layer->next_layer, context);
+			}
+		}
+	}
+
+	//===Last Micro-Batch Of The Batch: Apply And Clear This Stage's Gradients===//
+	self->num_backward++;
+	if (self->num_backward == pipeline->num_micro_batches){
+		update_weight = -network->learning_rate / (pipeline->num_micro_batches * pipeline->micro_batch_size);
+		for (l=self->first_layer; l<=self->last_layer; l++){
+			layer = &(network->layer[l]);
+			if (layer->next_layer != NULL){
+				apply_weight_gradient(layer, pipeline->gradient_arena + (layer->weight_matrix - network->weight_arena), update_weight);
+				memset(pipeline->gradient_arena + (layer->weight_matrix - network->weight_arena), 0,
+					   (layer->num_nodes+1) * layer->leading_dimension * sizeof(double));
+			}
+		}
+		self->num_backward = 0;
+	}
+
+	return;
+}
+
+static void run_stage_forward( pipeline_stage_t* self,
+							   unsigned int micro_batch )
+{
+	unsigned int i, l, sample, num_inputs, num_outputs;
+	neural_context_t** contexts;
+	pipeline_t* pipeline;
+	neural_network_t* network;
+
+	pipeline = self->pipeline;
+	network = pipeline->network;
+	num_inputs = network->layer[0].num_nodes;
+	num_outputs = network->layer[network->num_hidden_layers+1].num_nodes;
+	contexts = pipeline->contexts + (size_t)micro_batch*pipeline->micro_batch_size;
+
+	if (self->first_layer == 0){
+		for (i=0; i<pipeline->micro_batch_size; i++){
+			sample = micro_batch*pipeline->micro_batch_size + i;
+			memcpy(contexts[i]->input, pipeline->inputs + (size_t)sample*num_inputs, num_inputs * sizeof(double));
+		}
+	}
+
+	//===Layer By Layer, So CSR Layers Run One SpMM Per Micro-Batch===//
+	for (l=self->first_layer; l<=self->last_layer; l++){
+		if (network->layer[l].use_sparse_weights){
+			feed_layer_forward_sparse_batch(&(network->layer[l]), contexts, pipeline->micro_batch_size, self->sparse_block);
+			continue;
+		}
+		for (i=0; i<pipeline->micro_batch_size; i++){
+			feed_layer_forward(&(network->layer[l]), contexts[i]);
+		}
+	}
+
+	//===Output Stage===//
+	if (self->last_layer == network->num_hidden_layers+1){
+		for (i=0; i<pipeline->micro_batch_size; i++){
+			sample = micro_batch*pipeline->micro_batch_size + i;
+			if (pipeline->training){
+				pipeline->loss += compute_output_error(network, contexts[i], pipeline->labels + (size_t)sample*num_outputs);
+			}
+			else{
+				memcpy(pipeline->outputs + (size_t)sample*num_outputs, contexts[i]->output, num_outputs * sizeof(double));
+			}
+		}
+	}
+
+	return;
+}
+
+static void* run_pipeline_stage( void* argument )
+{
+	int backward;
+	unsigned int micro_batch;
+	struct timespec start, stop;
+	pipeline_stage_t *self, *next, *previous;
+	pipeline_t* pipeline;
+
+	self = (pipeline_stage_t*)argument;
+	pipeline = self->pipeline;
+	next = (self->index+1 < pipeline->num_stages) ? &(pipeline->stage[self->index+1]) : NULL;
+	previous = (self->index > 0) ? &(pipeline->stage[self->index-1]) : NULL;
+
+	while (1){
+		while (sem_wait(&(self->ready)) != 0);
+		if (atomic_load(&(pipeline->shutdown))){
+			break;
+		}
+
+		//===Backward Tokens First: They Finish Micro-Batches And Drain The Pipeline===//
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (spsc_queue_pop(&(self->backward), &micro_batch) == 0){
+			run_stage_backward(self, micro_batch);
+			backward = 1;
+		}
+		else if (spsc_queue_pop(&(self->forward), &micro_batch) == 0){
+			run_stage_forward(self, micro_batch);
+			backward = 0;
+
+			//===The Output Stage Turns Training Micro-Batches Around At Once===//
+			if (next == NULL && pipeline->training){
+				run_stage_backward(self, micro_batch);
+				backward = 1;
+			}
+		}
+		else{
+			fprintf(stderr, "Error:: Stage Was Woken Without A Token! In Function -- run_pipeline_stage\n");
+			continue;
+		}
+		self->num_micro_batches++;
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		self->busy_seconds += seconds_between(&start, &stop);
+
+		//===Hand The Token On; The Done Queue Tells The Caller The Micro-Batch Is Finished===//
+		if (backward && previous != NULL){
+			send_token(&(previous->backward), &(previous->ready), micro_batch);
+		}
+		else if (!backward && next != NULL){
+			send_token(&(next->forward), &(next->ready), micro_batch);
+		}
+		else{
+			send_token(&(pipeline->done), &(pipeline->done_ready), micro_batch);
+		}
+	}
+
+	return NULL;
+}
+
+//================================================================================================//
+//====================================Pipeline Functions==========================================//
+//================================================================================================//
+
+static double layer_cost( neural_network_t* network,
+						  unsigned int l )
+{
+	if (network->layer[l].next_layer == NULL){
+		return network->layer[l].num_nodes;
+	}
+	return (network->layer[l].num_nodes+1) * (double)network->layer[l].next_layer->num_nodes;
+}
+
+//===Contiguous Runs Of Layers With About total/num_stages Weights Each, None Empty===//
+static void assign_pipeline_stages( pipeline_t* self )
+{
+	unsigned int s, first, last, num_layers;
+	double total, cost;
+
+	num_layers = self->network->num_hidden_layers+2;
+	total = 0;
+	for (first=0; first<num_layers; first++){
+		total += layer_cost(self->network, first);
+	}
+
+	cost = 0;
+	first = 0;
+	for (s=0; s<self->num_stages; s++){
+		last = first;
+		cost += layer_cost(self->network, last);
+		while (last+1 < num_layers - (self->num_stages-1-s) &&
+			   (s == self->num_stages-1 ||
+				cost + 0.5*layer_cost(self->network, last+1) <= total*(s+1)/self->num_stages)){
+			last++;
+			cost += layer_cost(self->network, last);
+		}
+		self->stage[s].first_layer = first;
+		self->stage[s].last_layer = last;
+		first = last+1;
+	}
+
+	return;
+}
+
+pipeline_t* create_pipeline( neural_network_t* network,
+							 unsigned int num_stages,
+							 unsigned int micro_batch_size )
+{
+	unsigned int s, i, l, width;
+	pipeline_t* self;
+
+	//===Check Parameters===//
+	if (network == NULL){
+		fprintf(stderr, "Error:: Network Is NULL! In Function -- create_pipeline\n");
+		return NULL;
+	}
+	if (num_stages == 0 || num_stages > network->num_hidden_layers+2 || micro_batch_size == 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- create_pipeline\n");
+		return NULL;
+	}
+
+	//===Allocate; Queues Are Cache Line Aligned===//
+	self = aligned_alloc(WEIGHT_ALIGNMENT, round_up(sizeof(pipeline_t), WEIGHT_ALIGNMENT));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Pipeline Was Not Allocated! In Function -- create_pipeline\n");
+		return NULL;
+	}
+	memset(self, 0, sizeof(pipeline_t));
+	self->network = network;
+	self->num_stages = num_stages;
+	self->micro_batch_size = micro_batch_size;
+	atomic_init(&(self->shutdown), 0);
+	initialize_spsc_queue(&(self->done));
+	sem_init(&(self->done_ready), 0, 0);
+
+	//===One Context Per Sample In Flight===//
+	self->contexts = calloc(MAX_MICRO_BATCHES * micro_batch_size, sizeof(neural_context_t*));
+	self->gradient_arena = aligned_alloc(WEIGHT_ALIGNMENT, round_up(network->arena_size * sizeof(double), WEIGHT_ALIGNMENT));
+	if (self->contexts == NULL || self->gradient_arena == NULL){
+		fprintf(stderr, "Error:: Pipeline Buffers Were Not Allocated! In Function -- create_pipeline\n");
+		free(self->contexts);
+		free(self->gradient_arena);
+		free(self);
+		return NULL;
+	}
+	memset(self->gradient_arena, 0, network->arena_size * sizeof(double));
+	for (i=0; i<MAX_MICRO_BATCHES * micro_batch_size; i++){
+		self->contexts[i] = create_neural_context(network);
+		if (self->contexts[i] == NULL){
+			fprintf(stderr, "Error:: Context Was Not Created! In Function -- create_pipeline\n");
+			destroy_pipeline(self);
+			return NULL;
+		}
+	}
+
+	//===Sparse Blocks Fit A Micro-Batch Through The Widest Layer===//
+	width = 0;
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		width = MAX(width, network->layer[l].num_nodes+1 + network->layer[l+1].num_nodes);
+	}
+	for (s=0; s<num_stages; s++){
+		self->stage[s].sparse_block = malloc((size_t)micro_batch_size * width * sizeof(double));
+		if (self->stage[s].sparse_block == NULL){
+			fprintf(stderr, "Error:: Sparse Block Was Not Allocated! In Function -- create_pipeline\n");
+			self->num_stages = 0;
+			destroy_pipeline(self);
+			return NULL;
+		}
+	}
+
+	//===Start Stages===//
+	assign_pipeline_stages(self);
+	for (s=0; s<num_stages; s++){
+		self->stage[s].pipeline = self;
+		self->stage[s].index = s;
+		initialize_spsc_queue(&(self->stage[s].forward));
+		initialize_spsc_queue(&(self->stage[s].backward));
+		sem_init(&(self->stage[s].ready), 0, 0);
+	}
+	for (s=0; s<num_stages; s++){
+		if (pthread_create(&(self->stage[s].thread), NULL, run_pipeline_stage, &(self->stage[s])) != 0){
+			fprintf(stderr, "Error:: Stage Thread Was Not Created! In Function -- create_pipeline\n");
+			self->num_stages = s;
+			destroy_pipeline(self);
+			return NULL;
+		}
+	}
+
+	return self;
+}
+
+void destroy_pipeline( pipeline_t* self )
+{
+	unsigned int s, i;
+
+	if (self == NULL){
+		return;
+	}
+
+	//===Wake And Join Every Stage===//
+	atomic_store(&(self->shutdown), 1);
+	for (s=0; s<self->num_stages; s++){
+		if (self->stage[s].pipeline != NULL){
+			sem_post(&(self->stage[s].ready));
+			pthread_join(self->stage[s].thread, NULL);
+			sem_destroy(&(self->stage[s].ready));
+		}
+	}
+	sem_destroy(&(self->done_ready));
+
+	for (i=0; i<MAX_MICRO_BATCHES * self->micro_batch_size; i++){
+		if (self->contexts[i] != NULL){
+			destroy_neural_context(self->contexts[i]);
+		}
+	}
+	for (s=0; s<MAX_PIPELINE_STAGES; s++){
+		free(self->stage[s].sparse_block);
+	}
+	free(self->contexts);
+	free(self->gradient_arena);
+	free(self);
+
+	return;
+}
+
+static void run_pipeline( pipeline_t* self,
+						  unsigned int num_micro_batches )
+{
+	unsigned int m, micro_batch;
+	struct timespec start, stop;
+
+	//===Fields Set Here Reach The Stages Through The Release In send_token===//
+	self->num_micro_batches = num_micro_batches;
+	self->loss = 0;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (m=0; m<num_micro_batches; m++){
+		send_token(&(self->stage[0].forward), &(self->stage[0].ready), m);
+	}
+	for (m=0; m<num_micro_batches; m++){
+		while (sem_wait(&(self->done_ready)) != 0);
+		spsc_queue_pop(&(self->done), &micro_batch);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+	self->wall_seconds += seconds_between(&start, &stop);
+
+	return;
+}
+
+double pipeline_train( pipeline_t* self,
+					   double* inputs,
+					   double* labels,
+					   unsigned int num_micro_batches )
+{
+	if (self == NULL || inputs == NULL || labels == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- pipeline_train\n");
+		return -1;
+	}
+	if (num_micro_batches == 0 || num_micro_batches > MAX_MICRO_BATCHES){
+		fprintf(stderr, "Error:: Number Of Micro-Batches Is Invalid! In Function -- pipeline_train\n");
+		return -1;
+	}
+
+	self->inputs = inputs;
+	self->labels = labels;
+	self->training = 1;
+	run_pipeline(self, num_micro_batches);
+
+	return self->loss / (num_micro_batches * self->micro_batch_size);
+}
+
+void pipeline_feed_forward( pipeline_t* self,
+							double* inputs,
+							double* outputs,
+							unsigned int num_micro_batches )
+{
+	if (self == NULL || inputs == NULL || outputs == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- pipeline_feed_forward\n");
+		return;
+	}
+	if (num_micro_batches == 0 || num_micro_batches > MAX_MICRO_BATCHES){
+		fprintf(stderr, "Error:: Number Of Micro-Batches Is Invalid! In Function -- pipeline_feed_forward\n");
+		return;
+	}
+
+	self->inputs = inputs;
+	self->outputs = outputs;
+	self->training = 0;
+	run_pipeline(self, num_micro_batches);
+
+	return;
+}
+
+void print_pipeline_report( pipeline_t* self )
+{
+	unsigned int s;
+	double utilization;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Pipeline Is NULL! In Function -- print_pipeline_report\n");
+		return;
+	}
+
+	fprintf(stdout, "Pipeline: %u Stages, %u Samples Per Micro-Batch, %lf Seconds\n",
+			self->num_stages, self->micro_batch_size, self->wall_seconds);
+	for (s=0; s<self->num_stages; s++){
+		utilization = (self->wall_seconds > 0) ? self->stage[s].busy_seconds / self->wall_seconds : 0;
+		fprintf(stdout, "Stage %u: Layers %u-%u, %lu Steps, Busy %lf Seconds, Utilization %.1lf%%, Bubble %.1lf%%\n",
+				s, self->stage[s].first_layer, self->stage[s].last_layer, self->stage[s].num_micro_batches,
+				self->stage[s].busy_seconds, 100.0*utilization, 100.0*(1.0 - utilization));
+	}
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+void test_pipeline()
+{
+	unsigned int i, b, s, num_nodes[6];
+	double inputs[16*4], labels[16*3], outputs[16*3], *gradient;
+	neural_network_parameters_t* parameters;
+	neural_network_t *network, *serial;
+	pipeline_t* pipeline;
+
+	//===Two Identical Networks With A Softmax Output===//
+	num_nodes[0] = 4; num_nodes[1] = 9; num_nodes[2] = 7; num_nodes[3] = 8; num_nodes[4] = 6; num_nodes[5] = 3;
+	parameters = create_neural_network_parameters(4, num_nodes, 0.3);
+	parameters->activation[5] = ACTIVATION_SOFTMAX;
+	network = create_neural_network(parameters);
+	serial = create_neural_network(parameters);
+	memset(labels, 0, sizeof(labels));
+	for (i=0; i<16; i++){
+		inputs[4*i] = (i & 1); inputs[4*i+1] = (i & 2)/2; inputs[4*i+2] = (i & 4)/4; inputs[4*i+3] = 0.05*i;
+		labels[3*i + i%3] = 1;
+	}
+
+	//===Three Stages, Micro-Batches Of Two, Batches Of Eight===//
+	pipeline = create_pipeline(network, 3, 2);
+	if (pipeline == NULL){
+		fprintf(stderr, "Error: Function create_pipeline Has Failed!\n");
+		destroy_neural_network(network);
+		destroy_neural_network(serial);
+		free(parameters);
+		return;
+	}
+	for (b=0; b<4; b++){
+		pipeline_train(pipeline, inputs + 4*8*(b%2), labels + 3*8*(b%2), 4);
+	}
+
+	//===Serial Mini-Batch Training Over The Same Samples===//
+	gradient = calloc(serial->arena_size, sizeof(double));
+	for (b=0; b<4; b++){
+		memset(gradient, 0, serial->arena_size * sizeof(double));
+		for (s=0; s<8; s++){
+			feed_forward(serial, inputs + 4*(8*(b%2) + s));
+			back_propagate(serial, labels + 3*(8*(b%2) + s));
+			compute_weight_gradients(serial);
+			for (i=0; i<serial->arena_size; i++){
+				gradient[i] += serial->update_arena[i];
+			}
+		}
+		apply_weight_gradients(serial, gradient, -serial->learning_rate/8);
+	}
+	for (i=0; i<serial->arena_size; i++){
+		if (fabs(serial->weight_arena[i] - network->weight_arena[i]) > 1e-12){
+			fprintf(stderr, "Error: Function pipeline_train Does Not Match Serial Training!\n");
+			break;
+		}
+	}
+
+	//===Inference Matches feed_forward===//
+	pipeline_feed_forward(pipeline, inputs, outputs, 8);
+	for (s=0; s<16; s++){
+		feed_forward(serial, inputs + 4*s);
+		for (i=0; i<3; i++){
+			if (fabs(outputs[3*s+i] - serial->output[i]) > 1e-12){
+				fprintf(stderr, "Error: Function pipeline_feed_forward Does Not Match feed_forward!\n");
+				s = 16;
+				break;
+			}
+		}
+	}
+
+	//===Every Stage Did Work===//
+	for (s=0; s<pipeline->num_stages; s++){
+		if (pipeline->stage[s].num_micro_batches == 0 || pipeline->stage[s].busy_seconds > pipeline->wall_seconds){
+			fprintf(stderr, "Error: Function print_pipeline_report Has Invalid Utilization!\n");
+		}
+	}
+
+	//===Pruned Layers Run The Batched CSR Kernel===//
+	prune_network_to_sparsity(network, 0.5);
+	select_weight_kernels(network);
+	for (i=0; i<network->num_hidden_layers+1; i++){
+		network->layer[i].use_sparse_weights = 1;
+	}
+	pipeline_feed_forward(pipeline, inputs, outputs, 8);
+	for (s=0; s<16; s++){
+		feed_forward(network, inputs + 4*s);
+		for (i=0; i<3; i++){
+			if (fabs(outputs[3*s+i] - network->output[i]) > 1e-12){
+				fprintf(stderr, "Error: Function feed_layer_forward_sparse_batch Does Not Match feed_forward!\n");
+				s = 16;
+				break;
+			}
+		}
+	}
+
+	free(gradient);
+	destroy_pipeline(pipeline);
+	destroy_neural_network(network);
+	destroy_neural_network(serial);
+	free(parameters);
+
+	return;
+}
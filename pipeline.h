@@ -0,0 +1,209 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdatomic.h>
+#include <semaphore.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_PIPELINE_STAGES MAX_LAYERS
+#define MAX_MICRO_BATCHES 64
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct spsc_queue_t
+*   @brief This structure comprises a bounded lock-free single producer single consumer queue.
+*
+*	Items are micro-batch indices. The head is only written by the consumer and the tail only by
+*	the producer; each sits on its own cache line.
+*/
+//================================================================================================//
+typedef struct spsc_queue_s spsc_queue_t;
+typedef struct spsc_queue_s{
+	_Atomic size_t head;
+	char head_padding[WEIGHT_ALIGNMENT - sizeof(size_t)];
+	_Atomic size_t tail;
+	char tail_padding[WEIGHT_ALIGNMENT - sizeof(size_t)];
+	unsigned int item[MAX_MICRO_BATCHES];
+} spsc_queue_t;
+
+
+//================================================================================================//
+/** @struct pipeline_stage_t
+*   @brief This structure comprises one pipeline stage: a thread that owns consecutive layers.
+*
+*	The stage runs the forward pass of its layers, and the backward pass and weight updates of
+*	the weights leaving them. The semaphore counts tokens waiting in both of its queues. CSR
+*	layers gather a micro-batch into the sparse block and run one SpMM.
+*/
+//================================================================================================//
+typedef struct pipeline_stage_s pipeline_stage_t;
+typedef struct pipeline_stage_s{
+	spsc_queue_t forward;
+	spsc_queue_t backward;
+	sem_t ready;
+	pthread_t thread;
+	struct pipeline_s* pipeline;
+	double* sparse_block;
+	unsigned int index;
+	unsigned int first_layer;
+	unsigned int last_layer;
+	unsigned int num_backward;
+	unsigned long num_micro_batches;
+	double busy_seconds;
+} pipeline_stage_t;
+
+
+//================================================================================================//
+/** @struct pipeline_t
+*   @brief This structure comprises a GPipe style pipeline over a network's layers.
+*
+*	A call splits a batch into micro-batches that flow through the stages, so several are in
+*	flight at once. Each micro-batch sample has its own neural_context_t. Weights are updated
+*	once per batch, after every micro-batch has gone backward, so training matches serial
+*	mini-batch gradient descent.
+*/
+//================================================================================================//
+typedef struct pipeline_s pipeline_t;
+typedef struct pipeline_s{
+	pipeline_stage_t stage[MAX_PIPELINE_STAGES];
+	spsc_queue_t done;
+	sem_t done_ready;
+	neural_network_t* network;
+	neural_context_t** contexts;
+	double* gradient_arena;
+	double* inputs;
+	double* labels;
+	double* outputs;
+	double loss;
+	double wall_seconds;
+	unsigned int num_stages;
+	unsigned int micro_batch_size;
+	unsigned int num_micro_batches;
+	int training;
+	atomic_int shutdown;
+} pipeline_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a pipeline_t object and starts one thread per stage.
+*
+* Layers are split into num_stages runs of consecutive layers with about equal weight counts.
+* The network must not be used elsewhere while it is being trained through the pipeline.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+* @param[in] unsigned int num_stages
+* @param[in] unsigned int micro_batch_size
+*
+* @return pipeline_t* self
+*/
+//================================================================================================//
+pipeline_t* create_pipeline( neural_network_t* network,
+							 unsigned int num_stages,
+							 unsigned int micro_batch_size );
+
+
+//================================================================================================//
+/**
+* @brief This function stops the stage threads and frees a pipeline_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] pipeline_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_pipeline( pipeline_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function trains on one batch of num_micro_batches * micro_batch_size samples.
+*
+* The stages train outside iterate_network, so no trace events are recorded.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] pipeline_t* self
+* @param[in] double* inputs
+* @param[in] double* labels
+* @param[in] unsigned int num_micro_batches
+*
+* @return double loss (mean over the batch)
+*/
+//================================================================================================//
+double pipeline_train( pipeline_t* self,
+					   double* inputs,
+					   double* labels,
+					   unsigned int num_micro_batches );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds num_micro_batches * micro_batch_size samples through the pipeline.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] pipeline_t* self
+* @param[in] double* inputs
+* @param[out] double* outputs
+* @param[in] unsigned int num_micro_batches
+*
+* @return NONE
+*/
+//================================================================================================//
+void pipeline_feed_forward( pipeline_t* self,
+							double* inputs,
+							double* outputs,
+							unsigned int num_micro_batches );
+
+
+//================================================================================================//
+/**
+* @brief This function prints the utilization of every stage to stdout.
+*
+* Utilization is a stage's busy time over the wall time of all pipeline calls; the rest is
+* pipeline bubble or waiting on a slower stage.
+*
+* If errors occur, the function exits.
+*
+* @param[in] pipeline_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void print_pipeline_report( pipeline_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function tests pipeline training against serial mini-batch training.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_pipeline();
+
+
+
+#endif //PIPELINE_H//
@@ -0,0 +1,200 @@
+#include "random.h"
+
+//================================================================================================//
+//====================================Generator Functions=========================================//
+//================================================================================================//
+
+static inline uint64_t rotate_left( uint64_t x,
+									int k )
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t splitmix64( uint64_t* state )
+{
+	uint64_t z;
+	z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static inline double bits_to_uniform( uint64_t bits )
+{
+	//===Top 53 Bits Fill The Mantissa===//
+	return (double)(bits >> 11) * (1.0/9007199254740992.0);
+}
+
+uint64_t random_next( random_stream_t* self )
+{
+	uint64_t result, t;
+
+	result = rotate_left(self->state[1] * 5, 7) * 9;
+	t = self->state[1] << 17;
+
+	self->state[2] ^= self->state[0];
+	self->state[3] ^= self->state[1];
+	self->state[1] ^= self->state[2];
+	self->state[0] ^= self->state[3];
+	self->state[2] ^= t;
+	self->state[3] = rotate_left(self->state[3], 45);
+
+	return result;
+}
+
+static void random_jump( random_stream_t* self )
+{
+	static const uint64_t jump[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+									  0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	unsigned int i, b;
+	uint64_t s[4];
+
+	s[0] = 0; s[1] = 0; s[2] = 0; s[3] = 0;
+	for (i=0; i<4; i++){
+		for (b=0; b<64; b++){
+			if (jump[i] & ((uint64_t)1 << b)){
+				s[0] ^= self->state[0];
+				s[1] ^= self->state[1];
+				s[2] ^= self->state[2];
+				s[3] ^= self->state[3];
+			}
+			random_next(self);
+		}
+	}
+	self->state[0] = s[0]; self->state[1] = s[1];
+	self->state[2] = s[2]; self->state[3] = s[3];
+
+	return;
+}
+
+void initialize_random_stream( random_stream_t* self,
+							   uint64_t seed,
+							   uint64_t stream_id )
+{
+	uint64_t i, mix;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Random Stream Is NULL! In Function -- initialize_random_stream\n");
+		return;
+	}
+
+	//===Expand Seed===//
+	mix = seed;
+	for (i=0; i<4; i++){
+		self->state[i] = splitmix64(&mix);
+	}
+
+	//===Advance To Stream===//
+	for (i=0; i<stream_id; i++){
+		random_jump(self);
+	}
+
+	return;
+}
+
+double random_uniform( random_stream_t* self )
+{
+	return bits_to_uniform(random_next(self));
+}
+
+uint64_t random_derive_key( uint64_t seed,
+							uint64_t sub_key )
+{
+	uint64_t mix;
+	mix = seed ^ (sub_key * 0xD1342543DE82EF95ULL);
+	return splitmix64(&mix);
+}
+
+double random_uniform_at( uint64_t key,
+						  uint64_t counter )
+{
+	uint64_t mix;
+	mix = key + counter * 0x9E3779B97F4A7C15ULL;
+	return bits_to_uniform(splitmix64(&mix));
+}
+
+//================================================================================================//
+//======================================Sampling Functions========================================//
+//================================================================================================//
+
+void shuffle_indices( random_stream_t* self,
+					  unsigned int* indices,
+					  unsigned int num_indices )
+{
+	unsigned int i, j, temp;
+
+	if (indices == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'indices' Is NULL! In Function -- shuffle_indices\n");
+		return;
+	}
+
+	for (i=num_indices; i>1; i--){
+		j = (unsigned int)(random_uniform(self) * (double)i);
+		temp = indices[i-1];
+		indices[i-1] = indices[j];
+		indices[j] = temp;
+	}
+
+	return;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+void test_random_stream()
+{
+	unsigned int i, moved, indices[100], seen[100];
+	double mean;
+	random_stream_t stream1, stream2, stream3;
+
+	//===Same Seed And Stream Must Match===//
+	initialize_random_stream(&stream1, 1234, 0);
+	initialize_random_stream(&stream2, 1234, 0);
+	initialize_random_stream(&stream3, 1234, 1);
+	for (i=0; i<1000; i++){
+		if (random_next(&stream1) != random_next(&stream2)){
+			fprintf(stderr, "Error: Function random_next Is Not Deterministic!\n");
+			break;
+		}
+	}
+	if (random_next(&stream1) == random_next(&stream3)){
+		fprintf(stderr, "Error: Function initialize_random_stream Did Not Separate Streams!\n");
+	}
+
+	//===Check Uniform Mean===//
+	mean = 0;
+	for (i=0; i<100000; i++){
+		mean += random_uniform(&stream1);
+	}
+	mean /= 100000.0;
+	if (fabs(mean - 0.5) > 0.01){
+		fprintf(stderr, "Error: Function random_uniform Has Failed!\n");
+	}
+
+	//===Counter Draws Depend Only On Arguments===//
+	if (random_uniform_at(7, 42) != random_uniform_at(7, 42)){
+		fprintf(stderr, "Error: Function random_uniform_at Has Failed!\n");
+	}
+
+	//===Shuffling Yields A Permutation===//
+	for (i=0; i<100; i++){
+		indices[i] = i;
+		seen[i] = 0;
+	}
+	shuffle_indices(&stream1, indices, 100);
+	moved = 0;
+	for (i=0; i<100; i++){
+		if (indices[i] >= 100 || seen[indices[i]]++){
+			fprintf(stderr, "Error: Function shuffle_indices Did Not Return A Permutation!\n");
+			break;
+		}
+		moved += (indices[i] != i);
+	}
+	if (moved == 0){
+		fprintf(stderr, "Error: Function shuffle_indices Did Not Shuffle!\n");
+	}
+
+
+	return;
+}
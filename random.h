@@ -0,0 +1,145 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define RANDOM_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct random_stream_t
+*   @brief This structure comprises the state of a xoshiro256** random number stream.
+*
+*	Each thread should own its own stream. Streams created from the same seed with different
+*	stream ids are 2^128 draws apart and therefore never overlap.
+*/
+//================================================================================================//
+typedef struct random_stream_s random_stream_t;
+typedef struct random_stream_s{
+	uint64_t state[4];
+} random_stream_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function initializes a random_stream_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] random_stream_t* self
+* @param[in] uint64_t seed
+* @param[in] uint64_t stream_id
+*
+* @return NONE
+*/
+//================================================================================================//
+void initialize_random_stream( random_stream_t* self,
+							   uint64_t seed,
+							   uint64_t stream_id );
+
+
+//================================================================================================//
+/**
+* @brief This function returns the next 64 random bits of a random_stream_t object.
+*
+* @param[in,out] random_stream_t* self
+*
+* @return uint64_t bits
+*/
+//================================================================================================//
+uint64_t random_next( random_stream_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function returns a uniform random number in [0,1) from a random_stream_t object.
+*
+* @param[in,out] random_stream_t* self
+*
+* @return double value
+*/
+//================================================================================================//
+double random_uniform( random_stream_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function returns a uniform random number in [0,1) for a (key, counter) pair.
+*
+* The result depends only on its arguments, so any element of a sequence can be drawn
+* independently of the others. This is used to initialize weights in parallel.
+*
+* @param[in] uint64_t key
+* @param[in] uint64_t counter
+*
+* @return double value
+*/
+//================================================================================================//
+double random_uniform_at( uint64_t key,
+						  uint64_t counter );
+
+
+//================================================================================================//
+/**
+* @brief This function derives an independent counter key from a seed and a sub-key.
+*
+* @param[in] uint64_t seed
+* @param[in] uint64_t sub_key
+*
+* @return uint64_t key
+*/
+//================================================================================================//
+uint64_t random_derive_key( uint64_t seed,
+							uint64_t sub_key );
+
+
+//================================================================================================//
+/**
+* @brief This function shuffles an array of indices in place (Fisher-Yates).
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] random_stream_t* self
+* @param[in,out] unsigned int* indices
+* @param[in] unsigned int num_indices
+*
+* @return NONE
+*/
+//================================================================================================//
+void shuffle_indices( random_stream_t* self,
+					  unsigned int* indices,
+					  unsigned int num_indices );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the random_stream_t object.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_random_stream();
+
+
+
+#endif //RANDOM_H//
@@ -0,0 +1,793 @@
+#include "sparse.h"
+#include "helper.h"
+
+//================================================================================================//
+//=====================================Sparse Kernels=============================================//
+//================================================================================================//
+
+sparse_matrix_t* create_sparse_matrix( double* matrix,
+									   double* mask,
+									   unsigned int num_rows,
+									   unsigned int num_columns,
+									   unsigned int leading_dimension )
+{
+	unsigned int i, j, count;
+	double* pattern;
+	sparse_matrix_t* self;
+
+	if (matrix == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'matrix' Is NULL! In Function -- create_sparse_matrix\n");
+		return NULL;
+	}
+	pattern = (mask != NULL) ? mask : matrix;
+
+	//===Count Stored Entries===//
+	count = 0;
+	for (i=0; i<num_rows; i++){
+		for (j=0; j<num_columns; j++){
+			count += (pattern[j + (size_t)i*leading_dimension] != 0);
+		}
+	}
+
+	self = NULL;
+	self = malloc(sizeof(sparse_matrix_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Sparse Matrix Was Not Allocated! In Function -- create_sparse_matrix\n");
+		return self;
+	}
+	self->row_offsets = malloc((num_rows+1) * sizeof(unsigned int));
+	self->column_indices = malloc(MAX(count, 1) * sizeof(unsigned int));
+	self->values = malloc(MAX(count, 1) * sizeof(double));
+	if (self->row_offsets == NULL || self->column_indices == NULL || self->values == NULL){
+		fprintf(stderr, "Error:: Sparse Matrix Arrays Were Not Allocated! In Function -- create_sparse_matrix\n");
+		destroy_sparse_matrix(self);
+		return NULL;
+	}
+	self->num_rows = num_rows;
+	self->num_columns = num_columns;
+
+	//===Fill Rows===//
+	count = 0;
+	for (i=0; i<num_rows; i++){
+		self->row_offsets[i] = count;
+		for (j=0; j<num_columns; j++){
+			if (pattern[j + (size_t)i*leading_dimension] != 0){
+				self->column_indices[count] = j;
+				self->values[count] = matrix[j + (size_t)i*leading_dimension];
+				count++;
+			}
+		}
+	}
+	self->row_offsets[num_rows] = count;
+
+	return self;
+}
+
+void destroy_sparse_matrix( sparse_matrix_t* self )
+{
+	if (self == NULL){
+		fprintf(stderr, "Error:: Sparse Matrix Is NULL! In Function -- destroy_sparse_matrix\n");
+		return;
+	}
+
+	free(self->row_offsets);
+	free(self->column_indices);
+	free(self->values);
+	free(self);
+
+	return;
+}
+
+void get_sparse_row( sparse_matrix_t* matrix,
+					 unsigned int row,
+					 sparse_vector_t* row_vector )
+{
+	if (row >= matrix->num_rows){
+		fprintf(stderr, "Error:: Input Parameter 'row' Is Invalid! In Function -- get_sparse_row\n");
+		row_vector->num_nonzeros = 0;
+		return;
+	}
+
+	row_vector->indices = matrix->column_indices + matrix->row_offsets[row];
+	row_vector->values = matrix->values + matrix->row_offsets[row];
+	row_vector->num_nonzeros = matrix->row_offsets[row+1] - matrix->row_offsets[row];
+
+	return;
+}
+
+void sparse_vector_matrix_multiply( sparse_vector_t* vector,
+									double* matrix,
+									double* bias_row,
+									int matrix_columns,
+									int leading_dimension,
+									double* result )
+{
+	int j;
+	unsigned int k;
+	double value, *row;
+
+	//===Start From The Bias===//
+	for (j=0; j<matrix_columns; j++){
+		result[j] = (bias_row != NULL) ? bias_row[j] : 0;
+	}
+
+	//===Gather Active Rows===//
+	for (k=0; k<vector->num_nonzeros; k++){
+		value = vector->values[k];
+		row = matrix + (size_t)vector->indices[k] * leading_dimension;
+		for (j=0; j<matrix_columns; j++){
+			result[j] += value * row[j];
+		}
+	}
+
+	return;
+}
+
+void sparse_rank_one_update( double* matrix,
+							 int leading_dimension,
+							 sparse_vector_t* vector,
+							 double* delta,
+							 int matrix_columns,
+							 double update_weight )
+{
+	int j;
+	unsigned int k;
+	double scale, *row;
+
+	for (k=0; k<vector->num_nonzeros; k++){
+		scale = update_weight * vector->values[k];
+		row = matrix + (size_t)vector->indices[k] * leading_dimension;
+		for (j=0; j<matrix_columns; j++){
+			row[j] += scale * delta[j];
+		}
+	}
+
+	return;
+}
+
+void csr_vector_matrix_multiply( double* vector,
+								 sparse_matrix_t* matrix,
+								 double* result )
+{
+	unsigned int i, k, end;
+	double value;
+
+	for (i=0; i<matrix->num_columns; i++){
+		result[i] = 0;
+	}
+
+	//===Scatter Each Active Row===//
+	for (i=0; i<matrix->num_rows; i++){
+		value = vector[i];
+		if (value == 0){
+			continue;
+		}
+		end = matrix->row_offsets[i+1];
+		for (k=matrix->row_offsets[i]; k<end; k++){
+			result[matrix->column_indices[k]] += value * matrix->values[k];
+		}
+	}
+
+	return;
+}
+
+//================================================================================================//
+//======================================Pruning Functions=========================================//
+//================================================================================================//
+
+void csr_matrix_matrix_multiply( double* vectors,
+								 unsigned int batch_size,
+								 sparse_matrix_t* matrix,
+								 double* results )
+{
+	unsigned int b, i, k, end, column;
+	double weight;
+
+	for (i=0; i<batch_size*matrix->num_columns; i++){
+		results[i] = 0;
+	}
+
+	//===Each Stored Weight Is Loaded Once Per Batch===//
+	for (i=0; i<matrix->num_rows; i++){
+		end = matrix->row_offsets[i+1];
+		for (k=matrix->row_offsets[i]; k<end; k++){
+			weight = matrix->values[k];
+			column = matrix->column_indices[k];
+			for (b=0; b<batch_size; b++){
+				results[column + b*matrix->num_columns] += vectors[i + b*matrix->num_rows] * weight;
+			}
+		}
+	}
+
+	return;
+}
+
+void refresh_sparse_weights( neural_layer_t* self )
+{
+	unsigned int i, k, end;
+	double* row;
+	sparse_matrix_t* sparse;
+
+	sparse = self->sparse_weights;
+	for (i=0; i<sparse->num_rows; i++){
+		row = self->weight_matrix + (size_t)i * self->leading_dimension;
+		end = sparse->row_offsets[i+1];
+		for (k=sparse->row_offsets[i]; k<end; k++){
+			sparse->values[k] = row[sparse->column_indices[k]];
+		}
+	}
+
+	return;
+}
+
+static int allocate_mask_arena( neural_network_t* self )
+{
+	size_t i, bytes;
+	unsigned int l;
+
+	if (self->mask_arena != NULL){
+		return 0;
+	}
+
+	//===Masks Share The Weight Arena Layout===//
+	bytes = round_up(self->arena_size * sizeof(double), WEIGHT_ALIGNMENT);
+	self->mask_arena = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	if (self->mask_arena == NULL){
+		return -1;
+	}
+	for (i=0; i<self->arena_size; i++){
+		self->mask_arena[i] = 1;
+	}
+	for (l=0; l<self->num_hidden_layers+2; l++){
+		self->layer[l].weight_mask = self->mask_arena + (self->layer[l].weight_matrix - self->weight_arena);
+	}
+
+	return 0;
+}
+
+static double apply_pruning( neural_network_t* self,
+							 unsigned int layer_index,
+							 double threshold )
+{
+	unsigned int i, j, num_columns, pruned;
+	size_t position;
+	neural_layer_t* layer;
+
+	layer = &(self->layer[layer_index]);
+	num_columns = layer->next_layer->num_nodes;
+
+	//===Bias Row Is Left Alone===//
+	pruned = 0;
+	for (i=0; i<layer->num_nodes; i++){
+		for (j=0; j<num_columns; j++){
+			position = j + (size_t)i*layer->leading_dimension;
+			if (layer->weight_mask[position] == 0 || fabs(layer->weight_matrix[position]) < threshold){
+				layer->weight_mask[position] = 0;
+				layer->weight_matrix[position] = 0;
+				pruned++;
+			}
+		}
+	}
+	mark_weights_changed(self);
+
+	return pruned;
+}
+
+static double count_prunable( neural_network_t* self )
+{
+	unsigned int l;
+	double total;
+
+	total = 0;
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		total += (double)self->layer[l].num_nodes * self->layer[l].next_layer->num_nodes;
+	}
+
+	return total;
+}
+
+double prune_network( neural_network_t* self,
+					  double threshold )
+{
+	unsigned int l;
+	double pruned;
+
+	if (self == NULL || threshold < 0){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- prune_network\n");
+		return 0;
+	}
+	if (allocate_mask_arena(self) != 0){
+		fprintf(stderr, "Error:: Mask Arena Was Not Allocated! In Function -- prune_network\n");
+		return 0;
+	}
+
+	pruned = 0;
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		pruned += apply_pruning(self, l, threshold);
+	}
+
+	return pruned/count_prunable(self);
+}
+
+static int compare_doubles( const void* a,
+							const void* b )
+{
+	double x, y;
+	x = *(const double*)a;
+	y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+double prune_network_to_sparsity( neural_network_t* self,
+								  double sparsity )
+{
+	unsigned int l, i, j, num_columns, count, target;
+	double pruned, *magnitudes;
+	neural_layer_t* layer;
+
+	if (self == NULL || sparsity < 0 || sparsity >= 1){
+		fprintf(stderr, "Error:: Input Parameter Is Invalid! In Function -- prune_network_to_sparsity\n");
+		return 0;
+	}
+	if (allocate_mask_arena(self) != 0){
+		fprintf(stderr, "Error:: Mask Arena Was Not Allocated! In Function -- prune_network_to_sparsity\n");
+		return 0;
+	}
+
+	pruned = 0;
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		layer = &(self->layer[l]);
+		num_columns = layer->next_layer->num_nodes;
+		count = layer->num_nodes * num_columns;
+		target = (unsigned int)(sparsity * count);
+		if (target == 0){
+			continue;
+		}
+
+		//===Threshold Is The Target-th Smallest Magnitude===//
+		magnitudes = malloc(count * sizeof(double));
+		if (magnitudes == NULL){
+			fprintf(stderr, "Error:: Magnitudes Were Not Allocated! In Function -- prune_network_to_sparsity\n");
+			return pruned/count_prunable(self);
+		}
+		for (i=0; i<layer->num_nodes; i++){
+			for (j=0; j<num_columns; j++){
+				magnitudes[j + i*num_columns] = fabs(layer->weight_matrix[j + (size_t)i*layer->leading_dimension]);
+			}
+		}
+		qsort(magnitudes, count, sizeof(double), compare_doubles);
+		pruned += apply_pruning(self, l, (target < count) ? magnitudes[target] : DBL_MAX);
+		free(magnitudes);
+	}
+
+	return pruned/count_prunable(self);
+}
+
+static void run_layer_kernel( neural_layer_t* layer,
+							  double* vectors,
+							  unsigned int batch_size,
+							  double* results,
+							  int use_sparse )
+{
+	unsigned int columns;
+
+	columns = layer->next_layer->num_nodes;
+	if (use_sparse && batch_size == 1){
+		csr_vector_matrix_multiply(vectors, layer->sparse_weights, results);
+	}
+	else if (use_sparse){
+		csr_matrix_matrix_multiply(vectors, batch_size, layer->sparse_weights, results);
+	}
+	else if (batch_size == 1){
+		vector_matrix_multiply(layer->operation_backend[LAYER_OPERATION_FORWARD], vectors, layer->num_nodes+1, layer->weight_matrix,
+							   layer->num_nodes+1, columns, layer->leading_dimension, results);
+	}
+	else{
+		layer->operation_backend[LAYER_OPERATION_FORWARD]->gemm(batch_size, columns, layer->num_nodes+1, 1.0,
+															   vectors, layer->num_nodes+1,
+															   layer->weight_matrix, layer->leading_dimension,
+															   0.0, results, columns);
+	}
+
+	return;
+}
+
+static double time_layer_kernel( neural_layer_t* layer,
+								 double* vectors,
+								 unsigned int batch_size,
+								 double* results,
+								 int use_sparse )
+{
+	unsigned int t, r;
+	double elapsed, best;
+	struct timespec start, stop;
+
+	//===Trial 0 Warms Caches And Is Discarded; Keep The Best Of The Rest===//
+	best = DBL_MAX;
+	for (t=0; t<=KERNEL_TIMING_TRIALS; t++){
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (r=0; r<KERNEL_TIMING_REPETITIONS; r++){
+			run_layer_kernel(layer, vectors, batch_size, results, use_sparse);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		elapsed = (stop.tv_sec - start.tv_sec) + 1e-9*(stop.tv_nsec - start.tv_nsec);
+		if (t > 0 && elapsed < best){
+			best = elapsed;
+		}
+	}
+
+	return best;
+}
+
+void select_weight_kernels( neural_network_t* self )
+{
+	unsigned int l, i, width;
+	double dense_time, sparse_time;
+	double *vectors, *results;
+	neural_layer_t* layer;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'self' Is NULL! In Function -- select_weight_kernels\n");
+		return;
+	}
+
+	//===Private Timing Buffers, So No Context Is Touched===//
+	width = 0;
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		width = MAX(width, MAX(self->layer[l].num_nodes+1, self->layer[l].leading_dimension));
+	}
+	vectors = malloc(KERNEL_TIMING_BATCH * width * sizeof(double));
+	results = malloc(KERNEL_TIMING_BATCH * width * sizeof(double));
+	if (vectors == NULL || results == NULL){
+		fprintf(stderr, "Error:: Timing Buffers Were Not Allocated! In Function -- select_weight_kernels\n");
+		free(vectors);
+		free(results);
+		return;
+	}
+	for (i=0; i<KERNEL_TIMING_BATCH * width; i++){
+		vectors[i] = 1;
+	}
+
+	for (l=0; l<self->num_hidden_layers+1; l++){
+		layer = &(self->layer[l]);
+		layer->use_sparse_weights = 0;
+		if (layer->weight_mask == NULL){
+			continue;
+		}
+
+		//===Rebuild CSR From The Current Mask===//
+		if (layer->sparse_weights != NULL){
+			destroy_sparse_matrix(layer->sparse_weights);
+		}
+		layer->sparse_weights = create_sparse_matrix(layer->weight_matrix, layer->weight_mask,
+													 layer->num_nodes+1, layer->next_layer->num_nodes,
+													 layer->leading_dimension);
+		if (layer->sparse_weights == NULL){
+			continue;
+		}
+
+		//===Per Row Cost Of The Single Vector And The Batched Kernel, Dense Against CSR===//
+		dense_time = time_layer_kernel(layer, vectors, 1, results, 0)
+				   + time_layer_kernel(layer, vectors, KERNEL_TIMING_BATCH, results, 0) / KERNEL_TIMING_BATCH;
+		sparse_time = time_layer_kernel(layer, vectors, 1, results, 1)
+					+ time_layer_kernel(layer, vectors, KERNEL_TIMING_BATCH, results, 1) / KERNEL_TIMING_BATCH;
+		layer->use_sparse_weights = (sparse_time < dense_time);
+	}
+	free(vectors);
+	free(results);
+
+	return;
+}
+
+void feed_layer_forward_sparse_batch( neural_layer_t* self,
+									  neural_context_t** contexts,
+									  unsigned int num_contexts,
+									  double* block )
+{
+	unsigned int b, rows, columns;
+	double* product;
+	layer_state_t* state;
+
+	rows = self->num_nodes + 1;
+	columns = self->next_layer->num_nodes;
+	product = block + (size_t)num_contexts * rows;
+
+	//===Activate And Gather One Row Per Context===//
+	for (b=0; b<num_contexts; b++){
+		state = &(contexts[b]->layer[self->index]);
+		self->backend->activate[self->activation](state->input, state->activation, state->derivative, self->num_nodes);
+		state->activation[self->num_nodes] = 1;
+		memcpy(block + (size_t)b*rows, state->activation, rows * sizeof(double));
+	}
+
+	//===One SpMM, Then Scatter===//
+	csr_matrix_matrix_multiply(block, num_contexts, self->sparse_weights, product);
+	for (b=0; b<num_contexts; b++){
+		memcpy(contexts[b]->layer[self->index+1].input, product + (size_t)b*columns, columns * sizeof(double));
+	}
+
+	return;
+}
+
+//================================================================================================//
+//===================================Sparse Network Functions=====================================//
+//================================================================================================//
+
+static int check_sparse_input( neural_network_t* self,
+							   sparse_vector_t* input )
+{
+	unsigned int k;
+
+	for (k=0; k<input->num_nonzeros; k++){
+		if (input->indices[k] >= self->layer[0].num_nodes){
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int feed_forward_sparse( neural_network_t* self,
+						 neural_context_t* context,
+						 sparse_vector_t* input )
+{
+	unsigned int i;
+	neural_layer_t* first;
+
+	if (input == NULL || check_sparse_input(self, input) != 0){
+		fprintf(stderr, "Error:: Input Parameter 'input' Is Invalid! In Function -- feed_forward_sparse\n");
+		return -1;
+	}
+
+	//===First Layer As A Row Gather===//
+	first = &(self->layer[0]);
+	sparse_vector_matrix_multiply(input, first->weight_matrix,
+								  first->weight_matrix + (size_t)first->num_nodes * first->leading_dimension,
+								  first->next_layer->num_nodes, first->leading_dimension,
+								  context->layer[1].input);
+
+	//===Feed Through Remaining Layers===//
+	for (i=1; i<self->num_hidden_layers+2; i++){
+		feed_layer_forward(&(self->layer[i]), context);
+	}
+
+	return 0;
+}
+
+void iterate_network_sparse( neural_network_t* self,
+							 sparse_vector_t* input,
+							 double* true_decision )
+{
+	int traced;
+	unsigned int i, j;
+	double input_norm;
+	double *bias_row, *delta;
+	neural_layer_t* first;
+
+	//===Forward And Backward===//
+	if (feed_forward_sparse(self, self->context, input) != 0){
+		return;
+	}
+	traced = TRACE_ENABLED();
+	input_norm = 0;
+	if (traced){
+		for (j=0; j<input->num_nonzeros; j++){
+			input_norm += input->values[j] * input->values[j];
+		}
+		input_norm = sqrt(input_norm);
+		trace_forward_pass(self, input_norm, 1);
+	}
+	back_propagate(self, true_decision);
+	if (traced){
+		trace_backward_pass(self);
+	}
+
+	//===Dense Layers===//
+	for (i=1; i<self->num_hidden_layers+2; i++){
+		update_weight_matrix(&(self->layer[i]), self->context);
+	}
+
+	//===First Layer Touches Active Rows And Bias Only===//
+	first = &(self->layer[0]);
+	delta = self->context->layer[1].delta;
+	sparse_rank_one_update(first->weight_matrix, first->leading_dimension, input, delta,
+						   first->next_layer->num_nodes, -self->learning_rate);
+	bias_row = first->weight_matrix + (size_t)first->num_nodes * first->leading_dimension;
+	for (j=0; j<first->next_layer->num_nodes; j++){
+		bias_row[j] -= self->learning_rate * delta[j];
+	}
+	if (first->weight_mask != NULL){
+		matrix_mask(first->weight_matrix, first->num_nodes+1, first->leading_dimension, first->weight_mask);
+		if (first->sparse_weights != NULL){
+			refresh_sparse_weights(first);
+		}
+	}
+	mark_weights_changed(self);
+	if (traced){
+		trace_weight_update(self, input_norm, 1);
+	}
+
+	return;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+void test_pruning()
+{
+	unsigned int i, l, step;
+	unsigned int num_nodes[4];
+	unsigned int indices[4];
+	double sparsity, input[32], decision[2], dense_output[2], values[4];
+	double block[3*33], dense_block[3*64], sparse_block[3*64];
+	sparse_vector_t sparse_input;
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	neural_layer_t* layer;
+
+	//===Create Network===//
+	num_nodes[0] = 32; num_nodes[1] = 64; num_nodes[2] = 16; num_nodes[3] = 2;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.01);
+	parameters->activation[1] = ACTIVATION_RELU;
+	parameters->activation[2] = ACTIVATION_RELU;
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	network = create_neural_network(parameters);
+	for (i=0; i<32; i++){
+		input[i] = 0.01*i;
+	}
+
+	//===Prune And Check Sparsity===//
+	sparsity = prune_network_to_sparsity(network, 0.75);
+	if (fabs(sparsity - 0.75) > 0.01){
+		fprintf(stderr, "Error: Function prune_network_to_sparsity Has Failed!\n");
+	}
+
+	//===Fine-Tune With The Mask Held Fixed===//
+	decision[0] = 1; decision[1] = 0;
+	for (step=0; step<20; step++){
+		iterate_network(network, input, decision);
+	}
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		layer = &(network->layer[l]);
+		for (i=0; i<(layer->num_nodes+1)*layer->leading_dimension; i++){
+			if (layer->weight_mask[i] == 0 && layer->weight_matrix[i] != 0){
+				fprintf(stderr, "Error: Pruned Weight Was Revived By Training!\n");
+				l = network->num_hidden_layers+1;
+				break;
+			}
+		}
+	}
+
+	//===CSR Kernels Must Match Dense After A Sparse Update===//
+	select_weight_kernels(network);
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		network->layer[l].use_sparse_weights = 1;
+	}
+	iterate_network(network, input, decision);
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		network->layer[l].use_sparse_weights = 0;
+	}
+	feed_forward(network, input);
+	dense_output[0] = network->output[0]; dense_output[1] = network->output[1];
+	for (l=0; l<network->num_hidden_layers+1; l++){
+		network->layer[l].use_sparse_weights = 1;
+	}
+	feed_forward(network, input);
+	for (i=0; i<2; i++){
+		if (fabs(network->output[i] - dense_output[i]) > 1e-12){
+			fprintf(stderr, "Error: Function csr_vector_matrix_multiply Has Failed!\n");
+		}
+	}
+
+	//===A Batched CSR Product Must Match The Dense Gemm Row For Row===//
+	layer = &(network->layer[0]);
+	for (i=0; i<3*(layer->num_nodes+1); i++){
+		block[i] = 0.01*(i % 29) - 0.1;
+	}
+	run_layer_kernel(layer, block, 3, dense_block, 0);
+	run_layer_kernel(layer, block, 3, sparse_block, 1);
+	for (i=0; i<3*layer->next_layer->num_nodes; i++){
+		if (fabs(sparse_block[i] - dense_block[i]) > 1e-12){
+			fprintf(stderr, "Error: Function csr_matrix_matrix_multiply Has Failed!\n");
+			break;
+		}
+	}
+
+	//===The Sparse Input Path Keeps The Mask And CSR Copy Current===//
+	for (i=0; i<4; i++){
+		indices[i] = 8*i + 1;
+		values[i] = input[indices[i]];
+	}
+	sparse_input.indices = indices;
+	sparse_input.values = values;
+	sparse_input.num_nonzeros = 4;
+	for (step=0; step<5; step++){
+		iterate_network_sparse(network, &sparse_input, decision);
+	}
+	layer = &(network->layer[0]);
+	for (i=0; i<(layer->num_nodes+1)*layer->leading_dimension; i++){
+		if (layer->weight_mask[i] == 0 && layer->weight_matrix[i] != 0){
+			fprintf(stderr, "Error: Function iterate_network_sparse Revived A Pruned Weight!\n");
+			break;
+		}
+	}
+	feed_forward(network, input);
+	dense_output[0] = network->output[0]; dense_output[1] = network->output[1];
+	network->layer[0].use_sparse_weights = 0;
+	feed_forward(network, input);
+	for (i=0; i<2; i++){
+		if (fabs(network->output[i] - dense_output[i]) > 1e-12){
+			fprintf(stderr, "Error: Function iterate_network_sparse Left A Stale CSR Copy!\n");
+		}
+	}
+
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
+
+void test_sparse_input()
+{
+	unsigned int i, k, step;
+	unsigned int num_nodes[4];
+	unsigned int indices[4];
+	double values[4], dense[64], decision[2];
+	double* weights;
+	sparse_vector_t input;
+	neural_network_parameters_t* parameters;
+	neural_network_t *dense_network, *sparse_network;
+
+	//===Create Identical Networks===//
+	num_nodes[0] = 64; num_nodes[1] = 8; num_nodes[2] = 4; num_nodes[3] = 2;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	parameters->weight_storage = WEIGHT_STORAGE_PADDED;
+	dense_network = create_neural_network(parameters);
+	sparse_network = create_neural_network(parameters);
+
+	//===Train Both On The Same Sparse Data===//
+	input.indices = indices;
+	input.values = values;
+	input.num_nonzeros = 4;
+	for (step=0; step<200; step++){
+		for (i=0; i<64; i++){
+			dense[i] = 0;
+		}
+		for (k=0; k<4; k++){
+			indices[k] = (step*7 + k*13) % 64;
+			values[k] = 0.1*(k+1);
+			dense[indices[k]] = values[k];
+		}
+		decision[0] = step % 2; decision[1] = 1 - decision[0];
+		iterate_network(dense_network, dense, decision);
+		iterate_network_sparse(sparse_network, &input, decision);
+	}
+
+	//===An Out Of Range Feature Is Rejected Without Training===//
+	weights = malloc(sparse_network->arena_size * sizeof(double));
+	memcpy(weights, sparse_network->weight_arena, sparse_network->arena_size * sizeof(double));
+	k = indices[3];
+	indices[3] = 64;
+	iterate_network_sparse(sparse_network, &input, decision);
+	indices[3] = k;
+	if (memcmp(weights, sparse_network->weight_arena, sparse_network->arena_size * sizeof(double)) != 0){
+		fprintf(stderr, "Error: Function iterate_network_sparse Trained On A Rejected Input!\n");
+	}
+	free(weights);
+
+	//===Predictions Must Agree===//
+	feed_forward(dense_network, dense);
+	feed_forward_sparse(sparse_network, sparse_network->context, &input);
+	for (i=0; i<2; i++){
+		if (fabs(dense_network->output[i] - sparse_network->output[i]) > 1e-10){
+			fprintf(stderr, "Error: Function iterate_network_sparse Has Failed!\n");
+		}
+	}
+
+	destroy_neural_network(dense_network);
+	destroy_neural_network(sparse_network);
+	free(parameters);
+
+	return;
+}
@@ -0,0 +1,370 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define KERNEL_TIMING_REPETITIONS 64
+#define KERNEL_TIMING_TRIALS 5
+#define KERNEL_TIMING_BATCH 16
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct sparse_vector_t
+*   @brief This structure comprises a sparse vector as index/value pairs.
+*
+*	The arrays are owned by the caller; indices need not be sorted but must be unique.
+*/
+//================================================================================================//
+typedef struct sparse_vector_s sparse_vector_t;
+typedef struct sparse_vector_s{
+	unsigned int* indices;
+	double* values;
+	unsigned int num_nonzeros;
+} sparse_vector_t;
+
+
+//================================================================================================//
+/** @struct sparse_matrix_t
+*   @brief This structure comprises a sparse matrix in compressed sparse row (CSR) form.
+*
+*	Row r holds the entries row_offsets[r] through row_offsets[r+1]-1 of column_indices and
+*	values. Matrices built by create_sparse_matrix own their arrays; otherwise the arrays are
+*	owned by the caller.
+*/
+//================================================================================================//
+typedef struct sparse_matrix_s sparse_matrix_t;
+typedef struct sparse_matrix_s{
+	unsigned int* row_offsets;
+	unsigned int* column_indices;
+	double* values;
+	unsigned int num_rows;
+	unsigned int num_columns;
+} sparse_matrix_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function builds a CSR matrix from a dense row major matrix.
+*
+* An entry is stored where the mask is nonzero, or where the matrix is nonzero if the mask is
+* NULL. The mask has the same layout as the matrix.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* matrix
+* @param[in] double* mask
+* @param[in] unsigned int num_rows
+* @param[in] unsigned int num_columns
+* @param[in] unsigned int leading_dimension
+*
+* @return sparse_matrix_t* self
+*/
+//================================================================================================//
+sparse_matrix_t* create_sparse_matrix( double* matrix,
+									   double* mask,
+									   unsigned int num_rows,
+									   unsigned int num_columns,
+									   unsigned int leading_dimension );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a sparse_matrix_t built by create_sparse_matrix.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] sparse_matrix_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_sparse_matrix( sparse_matrix_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function views one row of a CSR matrix as a sparse_vector_t without copying.
+*
+* If errors occur, the function exits.
+*
+* @param[in] sparse_matrix_t* matrix
+* @param[in] unsigned int row
+* @param[out] sparse_vector_t* row_vector
+*
+* @return NONE
+*/
+//================================================================================================//
+void get_sparse_row( sparse_matrix_t* matrix,
+					 unsigned int row,
+					 sparse_vector_t* row_vector );
+
+
+//================================================================================================//
+/**
+* @brief This function multiplies a sparse vector by a dense row major matrix.
+*
+* Only the matrix rows named by the vector are read, and the bias row (if not NULL) is added,
+* so the cost scales with the number of nonzeros rather than the vector length.
+*
+* If errors occur, the function exits.
+*
+* @param[in] sparse_vector_t* vector
+* @param[in] double* matrix
+* @param[in] double* bias_row
+* @param[in] int matrix_columns
+* @param[in] int leading_dimension
+* @param[out] double* result
+*
+* @return NONE
+*/
+//================================================================================================//
+void sparse_vector_matrix_multiply( sparse_vector_t* vector,
+									double* matrix,
+									double* bias_row,
+									int matrix_columns,
+									int leading_dimension,
+									double* result );
+
+
+//================================================================================================//
+/**
+* @brief This function adds update_weight * x * delta^T to the rows of a matrix named by x.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] double* matrix
+* @param[in] int leading_dimension
+* @param[in] sparse_vector_t* vector
+* @param[in] double* delta
+* @param[in] int matrix_columns
+* @param[in] double update_weight
+*
+* @return NONE
+*/
+//================================================================================================//
+void sparse_rank_one_update( double* matrix,
+							 int leading_dimension,
+							 sparse_vector_t* vector,
+							 double* delta,
+							 int matrix_columns,
+							 double update_weight );
+
+
+//================================================================================================//
+/**
+* @brief This function multiplies a dense vector by a CSR matrix (SpMV, result = x^T A).
+*
+* Rows whose vector entry is zero are skipped, which pays off after ReLU layers.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* vector
+* @param[in] sparse_matrix_t* matrix
+* @param[out] double* result
+*
+* @return NONE
+*/
+//================================================================================================//
+void csr_vector_matrix_multiply( double* vector,
+								 sparse_matrix_t* matrix,
+								 double* result );
+
+
+//================================================================================================//
+/**
+* @brief This function multiplies a row major batch of vectors by a CSR matrix (SpMM).
+*
+* Each stored entry is loaded once and applied to every row of the batch.
+*
+* If errors occur, the function exits.
+*
+* @param[in] double* vectors
+* @param[in] unsigned int batch_size
+* @param[in] sparse_matrix_t* matrix
+* @param[out] double* results
+*
+* @return NONE
+*/
+//================================================================================================//
+void csr_matrix_matrix_multiply( double* vectors,
+								 unsigned int batch_size,
+								 sparse_matrix_t* matrix,
+								 double* results );
+
+
+//================================================================================================//
+/**
+* @brief This function copies a pruned layer's dense weights into its CSR copy.
+*
+* The mask is fixed, so the sparsity pattern is unchanged and only values are refreshed.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_layer_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void refresh_sparse_weights( neural_layer_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function prunes every weight whose magnitude is below a threshold.
+*
+* Bias rows are never pruned. The resulting masks are held fixed by later training, so the
+* network can be fine-tuned after pruning.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double threshold
+*
+* @return double sparsity (fraction of non-bias weights pruned)
+*/
+//================================================================================================//
+double prune_network( neural_network_t* self,
+					  double threshold );
+
+
+//================================================================================================//
+/**
+* @brief This function prunes the smallest weights of each layer to reach a target sparsity.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] double sparsity
+*
+* @return double sparsity (fraction of non-bias weights pruned)
+*/
+//================================================================================================//
+double prune_network_to_sparsity( neural_network_t* self,
+								  double sparsity );
+
+
+//================================================================================================//
+/**
+* @brief This function builds CSR weights for pruned layers and picks the faster forward kernel.
+*
+* Each pruned layer is timed with its dense and its CSR kernels, single vector and batched, and
+* keeps whichever costs less per row. Every timing is a warm-up run followed by the best of
+* KERNEL_TIMING_TRIALS runs. Call it again after pruning further.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void select_weight_kernels( neural_network_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds a CSR layer forward for a batch of contexts with one SpMM.
+*
+* Block must hold num_contexts rows of num_nodes+1 followed by num_contexts rows of the next
+* layer's num_nodes.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_layer_t* self
+* @param[in,out] neural_context_t** contexts
+* @param[in] unsigned int num_contexts
+* @param[in] double* block
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_layer_forward_sparse_batch( neural_layer_t* self,
+									  neural_context_t** contexts,
+									  unsigned int num_contexts,
+									  double* block );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds a sparse input through a neural_network_t.
+*
+* The first layer is computed as a gather of the weight rows of the active features; the dense
+* input buffer of the context is not used. The result is left in context->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] sparse_vector_t* input
+*
+* @return int status (0 on success, -1 on an invalid input)
+*/
+//================================================================================================//
+int feed_forward_sparse( neural_network_t* self,
+						 neural_context_t* context,
+						 sparse_vector_t* input );
+
+
+//================================================================================================//
+/**
+* @brief This function runs an update iteration for a sparse input.
+*
+* Only the first layer weight rows of active features (and the bias row) are updated. An
+* input rejected by feed_forward_sparse leaves the network untouched. Traced like
+* iterate_network.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] neural_network_t* self
+* @param[in] sparse_vector_t* input
+* @param[in] double* true_decision
+*
+* @return NONE
+*/
+//================================================================================================//
+void iterate_network_sparse( neural_network_t* self,
+							 sparse_vector_t* input,
+							 double* true_decision );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the sparse input path against the dense one.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_sparse_input();
+
+
+//================================================================================================//
+/**
+* @brief This function tests pruning and the CSR weight kernels.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_pruning();
+
+
+
+#endif //SPARSE_H//
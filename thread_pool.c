@@ -0,0 +1,515 @@
+#define _GNU_SOURCE
+#include "thread_pool.h"
+#include "helper.h"
+
+static _Thread_local thread_pool_worker_t* current_worker = NULL;
+static thread_pool_t* shared_pool = NULL;
+static pthread_once_t shared_pool_once = PTHREAD_ONCE_INIT;
+
+//================================================================================================//
+//=====================================Deque Functions============================================//
+//================================================================================================//
+
+static void initialize_task_deque( task_deque_t* self )
+{
+	unsigned int i;
+
+	atomic_init(&(self->top), 0);
+	atomic_init(&(self->bottom), 0);
+	for (i=0; i<THREAD_POOL_DEQUE_SIZE; i++){
+		atomic_init(&(self->buffer[i]), NULL);
+	}
+
+	return;
+}
+
+//===Owner Only===//
+static int task_deque_push( task_deque_t* self,
+							task_t* task )
+{
+	int64_t top, bottom;
+
+	bottom = atomic_load_explicit(&(self->bottom), memory_order_relaxed);
+	top = atomic_load_explicit(&(self->top), memory_order_acquire);
+	if (bottom - top >= THREAD_POOL_DEQUE_SIZE){
+		return -1;
+	}
+	atomic_store_explicit(&(self->buffer[bottom & (THREAD_POOL_DEQUE_SIZE-1)]), task, memory_order_relaxed);
+	atomic_store_explicit(&(self->bottom), bottom + 1, memory_order_release);
+
+	return 0;
+}
+
+//===Owner Only: Newest Task First===//
+static task_t* task_deque_take( task_deque_t* self )
+{
+	int64_t top, bottom;
+	task_t* task;
+
+	bottom = atomic_load_explicit(&(self->bottom), memory_order_relaxed) - 1;
+	atomic_store_explicit(&(self->bottom), bottom, memory_order_seq_cst);
+	top = atomic_load_explicit(&(self->top), memory_order_seq_cst);
+
+	if (top > bottom){
+		atomic_store_explicit(&(self->bottom), bottom + 1, memory_order_relaxed);
+		return NULL;
+	}
+	task = atomic_load_explicit(&(self->buffer[bottom & (THREAD_POOL_DEQUE_SIZE-1)]), memory_order_relaxed);
+	if (top == bottom){
+
+		//===Last Task: Race Any Thief For It===//
+		if (!atomic_compare_exchange_strong_explicit(&(self->top), &top, top + 1, memory_order_seq_cst, memory_order_relaxed)){
+			task = NULL;
+		}
+		atomic_store_explicit(&(self->bottom), bottom + 1, memory_order_relaxed);
+	}
+
+	return task;
+}
+
+//===Any Thread: Oldest Task First===//
+static task_t* task_deque_steal( task_deque_t* self )
+{
+	int64_t top, bottom;
+	task_t* task;
+
+	top = atomic_load_explicit(&(self->top), memory_order_seq_cst);
+	bottom = atomic_load_explicit(&(self->bottom), memory_order_seq_cst);
+	if (top >= bottom){
+		return NULL;
+	}
+	task = atomic_load_explicit(&(self->buffer[top & (THREAD_POOL_DEQUE_SIZE-1)]), memory_order_relaxed);
+	if (!atomic_compare_exchange_strong_explicit(&(self->top), &top, top + 1, memory_order_seq_cst, memory_order_relaxed)){
+		return NULL;
+	}
+
+	return task;
+}
+
+//================================================================================================//
+//======================================Task Functions============================================//
+//================================================================================================//
+
+static void run_task( task_t* task )
+{
+	task->function(task->argument, task->begin, task->end);
+	atomic_fetch_sub_explicit(&(task->group->pending), 1, memory_order_release);
+	return;
+}
+
+//===Own Deque, Then Tasks From Outside The Pool, Then Other Workers' Deques===//
+static task_t* find_task( thread_pool_t* self,
+						  thread_pool_worker_t* worker )
+{
+	unsigned int i, start;
+	task_t* task;
+
+	task = NULL;
+	if (worker != NULL){
+		task = task_deque_take(&(worker->deque));
+	}
+	if (task == NULL && atomic_load(&(self->num_injected)) > 0){
+		pthread_mutex_lock(&(self->lock));
+		task = self->injected_head;
+		if (task != NULL){
+			self->injected_head = task->next;
+			if (self->injected_head == NULL){
+				self->injected_tail = NULL;
+			}
+			atomic_fetch_sub(&(self->num_injected), 1);
+		}
+		pthread_mutex_unlock(&(self->lock));
+	}
+	if (task == NULL){
+		start = (worker != NULL) ? worker->index + 1 : 0;
+		for (i=0; i<self->num_workers && task == NULL; i++){
+			if (&(self->worker[(start + i) % self->num_workers]) != worker){
+				task = task_deque_steal(&(self->worker[(start + i) % self->num_workers].deque));
+			}
+		}
+	}
+	if (task != NULL){
+		atomic_fetch_sub(&(self->num_queued), 1);
+	}
+
+	return task;
+}
+
+static void* run_thread_pool_worker( void* argument )
+{
+	unsigned int spins;
+	long num_cpus;
+	cpu_set_t cpus;
+	task_t* task;
+	thread_pool_worker_t* self;
+	thread_pool_t* pool;
+
+	self = (thread_pool_worker_t*)argument;
+	pool = self->pool;
+	current_worker = self;
+
+	if (pool->pin_workers){
+		num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		CPU_ZERO(&cpus);
+		CPU_SET(self->index % MAX(num_cpus, 1), &cpus);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0){
+			fprintf(stderr, "Error:: Worker %u Was Not Pinned! In Function -- run_thread_pool_worker\n", self->index);
+		}
+	}
+
+	spins = 0;
+	while (!atomic_load(&(pool->shutdown))){
+		task = find_task(pool, self);
+		if (task != NULL){
+			run_task(task);
+			spins = 0;
+			continue;
+		}
+		if (++spins < THREAD_POOL_SPIN_LIMIT){
+			sched_yield();
+			continue;
+		}
+
+		//===Sleep; A Spawner Sees num_sleeping Or This Thread Sees num_queued===//
+		pthread_mutex_lock(&(pool->lock));
+		atomic_fetch_add(&(pool->num_sleeping), 1);
+		while (atomic_load(&(pool->num_queued)) == 0 && !atomic_load(&(pool->shutdown))){
+			pthread_cond_wait(&(pool->wakeup), &(pool->lock));
+		}
+		atomic_fetch_sub(&(pool->num_sleeping), 1);
+		pthread_mutex_unlock(&(pool->lock));
+		spins = 0;
+	}
+
+	return NULL;
+}
+
+//================================================================================================//
+//======================================Pool Functions============================================//
+//================================================================================================//
+
+thread_pool_t* create_thread_pool( unsigned int num_workers,
+								   int pin_workers )
+{
+	unsigned int w;
+	size_t bytes;
+	thread_pool_t* self;
+
+	if (num_workers > MAX_THREAD_POOL_WORKERS){
+		fprintf(stderr, "Error:: Too Many Workers! In Function -- create_thread_pool\n");
+		return NULL;
+	}
+
+	self = malloc(sizeof(thread_pool_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Thread Pool Was Not Allocated! In Function -- create_thread_pool\n");
+		return NULL;
+	}
+	bytes = round_up(MAX(num_workers, 1) * sizeof(thread_pool_worker_t), WEIGHT_ALIGNMENT);
+	self->worker = aligned_alloc(WEIGHT_ALIGNMENT, bytes);
+	if (self->worker == NULL){
+		fprintf(stderr, "Error:: Workers Were Not Allocated! In Function -- create_thread_pool\n");
+		free(self);
+		return NULL;
+	}
+
+	//===Set Local Data===//
+	self->num_workers = num_workers;
+	self->pin_workers = pin_workers;
+	self->injected_head = NULL;
+	self->injected_tail = NULL;
+	atomic_init(&(self->num_queued), 0);
+	atomic_init(&(self->num_injected), 0);
+	atomic_init(&(self->num_sleeping), 0);
+	atomic_init(&(self->shutdown), 0);
+	pthread_mutex_init(&(self->lock), NULL);
+	pthread_cond_init(&(self->wakeup), NULL);
+
+	//===Start Workers===//
+	for (w=0; w<num_workers; w++){
+		initialize_task_deque(&(self->worker[w].deque));
+		self->worker[w].pool = self;
+		self->worker[w].index = w;
+	}
+	for (w=0; w<num_workers; w++){
+		if (pthread_create(&(self->worker[w].thread), NULL, run_thread_pool_worker, &(self->worker[w])) != 0){
+			fprintf(stderr, "Error:: Worker Thread Was Not Created! In Function -- create_thread_pool\n");
+			self->num_workers = w;
+			destroy_thread_pool(self);
+			return NULL;
+		}
+	}
+
+	return self;
+}
+
+void destroy_thread_pool( thread_pool_t* self )
+{
+	unsigned int w;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Thread Pool Is NULL! In Function -- destroy_thread_pool\n");
+		return;
+	}
+
+	//===Wake Sleepers And Join===//
+	atomic_store(&(self->shutdown), 1);
+	pthread_mutex_lock(&(self->lock));
+	pthread_cond_broadcast(&(self->wakeup));
+	pthread_mutex_unlock(&(self->lock));
+	for (w=0; w<self->num_workers; w++){
+		pthread_join(self->worker[w].thread, NULL);
+	}
+
+	pthread_cond_destroy(&(self->wakeup));
+	pthread_mutex_destroy(&(self->lock));
+	free(self->worker);
+	free(self);
+
+	return;
+}
+
+static void create_shared_thread_pool()
+{
+	long num_cpus;
+
+	//===The Waiting Thread Is The Last Worker===//
+	num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	shared_pool = create_thread_pool(MIN(MAX(num_cpus, 1) - 1, MAX_THREAD_POOL_WORKERS), 0);
+
+	return;
+}
+
+thread_pool_t* get_thread_pool()
+{
+	pthread_once(&shared_pool_once, create_shared_thread_pool);
+	return shared_pool;
+}
+
+void initialize_task_group( task_group_t* self )
+{
+	atomic_init(&(self->pending), 0);
+	return;
+}
+
+void thread_pool_spawn( thread_pool_t* self,
+						task_group_t* group,
+						task_t* task )
+{
+	task->group = group;
+	task->next = NULL;
+	atomic_fetch_add_explicit(&(group->pending), 1, memory_order_relaxed);
+
+	//===Counted Before It Can Be Found, So num_queued Never Wraps===//
+	atomic_fetch_add(&(self->num_queued), 1);
+	if (current_worker != NULL && current_worker->pool == self){
+		if (task_deque_push(&(current_worker->deque), task) != 0){
+			atomic_fetch_sub(&(self->num_queued), 1);
+			run_task(task);
+			return;
+		}
+	}
+	else{
+		pthread_mutex_lock(&(self->lock));
+		if (self->injected_tail != NULL){
+			self->injected_tail->next = task;
+		}
+		else{
+			self->injected_head = task;
+		}
+		self->injected_tail = task;
+		atomic_fetch_add(&(self->num_injected), 1);
+		pthread_mutex_unlock(&(self->lock));
+	}
+
+	if (atomic_load(&(self->num_sleeping)) > 0){
+		pthread_mutex_lock(&(self->lock));
+		pthread_cond_signal(&(self->wakeup));
+		pthread_mutex_unlock(&(self->lock));
+	}
+
+	return;
+}
+
+void thread_pool_wait( thread_pool_t* self,
+					   task_group_t* group )
+{
+	task_t* task;
+	thread_pool_worker_t* worker;
+
+	worker = (current_worker != NULL && current_worker->pool == self) ? current_worker : NULL;
+	while (atomic_load_explicit(&(group->pending), memory_order_acquire) > 0){
+		task = find_task(self, worker);
+		if (task != NULL){
+			run_task(task);
+		}
+		else{
+			sched_yield();
+		}
+	}
+
+	return;
+}
+
+void parallel_for( thread_pool_t* self,
+				   unsigned int begin,
+				   unsigned int end,
+				   unsigned int grain,
+				   task_function_t function,
+				   void* argument )
+{
+	unsigned int t, num_tasks, chunk;
+	task_t tasks[MAX_PARALLEL_FOR_TASKS];
+	task_group_t group;
+
+	if (end <= begin){
+		return;
+	}
+	if (self == NULL){
+		self = get_thread_pool();
+	}
+
+	//===Chunks Of At Least grain, At Most MAX_PARALLEL_FOR_TASKS Of Them===//
+	chunk = MAX(grain, 1);
+	num_tasks = (end - begin + chunk - 1)/chunk;
+	if (num_tasks > MAX_PARALLEL_FOR_TASKS){
+		chunk = (end - begin + MAX_PARALLEL_FOR_TASKS - 1)/MAX_PARALLEL_FOR_TASKS;
+		num_tasks = (end - begin + chunk - 1)/chunk;
+	}
+	if (self == NULL || self->num_workers == 0 || num_tasks == 1){
+		function(argument, begin, end);
+		return;
+	}
+
+	//===Far Chunks Are Pushed First, So Thieves Take Them And The Caller Keeps The Near Ones===//
+	initialize_task_group(&group);
+	for (t=num_tasks-1; t>0; t--){
+		tasks[t].function = function;
+		tasks[t].argument = argument;
+		tasks[t].begin = begin + t*chunk;
+		tasks[t].end = MIN(begin + (t+1)*chunk, end);
+		thread_pool_spawn(self, &group, &(tasks[t]));
+	}
+	function(argument, begin, MIN(begin + chunk, end));
+	thread_pool_wait(self, &group);
+
+	return;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+static void test_mark_range( void* argument,
+							 unsigned int begin,
+							 unsigned int end )
+{
+	unsigned int i;
+	unsigned int* hits;
+
+	hits = (unsigned int*)argument;
+	for (i=begin; i<end; i++){
+		hits[i]++;
+	}
+	return;
+}
+
+typedef struct test_nested_s{
+	thread_pool_t* pool;
+	unsigned int* hits;
+} test_nested_t;
+
+static void test_nested_range( void* argument,
+							   unsigned int begin,
+							   unsigned int end )
+{
+	unsigned int i;
+	test_nested_t* test;
+
+	test = (test_nested_t*)argument;
+	for (i=begin; i<end; i++){
+		parallel_for(test->pool, 0, 500, 10, test_mark_range, test->hits + 8 + 500*i);
+		test->hits[i]++;
+	}
+	return;
+}
+
+static void test_count_task( void* argument,
+							 unsigned int begin,
+							 unsigned int end )
+{
+	atomic_fetch_add((atomic_uint*)argument, end - begin);
+	return;
+}
+
+void test_thread_pool()
+{
+	unsigned int i, p;
+	unsigned int *hits;
+	atomic_uint count;
+	task_t tasks[100];
+	task_group_t group;
+	test_nested_t nested;
+	thread_pool_t *pool, *pools[2];
+
+	hits = calloc(8 + 8*500, sizeof(unsigned int));
+	pools[0] = create_thread_pool(3, 1);
+	pools[1] = create_thread_pool(0, 0);
+	if (pools[0] == NULL || pools[1] == NULL || get_thread_pool() == NULL){
+		fprintf(stderr, "Error: Function create_thread_pool Has Failed!\n");
+		for (p=0; p<2; p++){
+			if (pools[p] != NULL){
+				destroy_thread_pool(pools[p]);
+			}
+		}
+		free(hits);
+		return;
+	}
+
+	for (p=0; p<2; p++){
+		pool = pools[p];
+
+		//===Every Index Exactly Once===//
+		memset(hits, 0, (8 + 8*500) * sizeof(unsigned int));
+		parallel_for(pool, 0, 8 + 8*500, 16, test_mark_range, hits);
+		for (i=0; i<8 + 8*500; i++){
+			if (hits[i] != 1){
+				fprintf(stderr, "Error: Function parallel_for Has Failed!\n");
+				break;
+			}
+		}
+
+		//===Nested Loops Share The Pool's Threads===//
+		memset(hits, 0, (8 + 8*500) * sizeof(unsigned int));
+		nested.pool = pool;
+		nested.hits = hits;
+		parallel_for(pool, 0, 8, 1, test_nested_range, &nested);
+		for (i=0; i<8 + 8*500; i++){
+			if (hits[i] != 1){
+				fprintf(stderr, "Error: Function parallel_for Has Failed On Nested Loops!\n");
+				break;
+			}
+		}
+
+		//===Fork-Join From Outside The Pool===//
+		atomic_init(&count, 0);
+		initialize_task_group(&group);
+		for (i=0; i<100; i++){
+			tasks[i].function = test_count_task;
+			tasks[i].argument = &count;
+			tasks[i].begin = 0;
+			tasks[i].end = i;
+			thread_pool_spawn(pool, &group, &(tasks[i]));
+		}
+		thread_pool_wait(pool, &group);
+		if (atomic_load(&count) != 99*100/2){
+			fprintf(stderr, "Error: Function thread_pool_wait Has Failed!\n");
+		}
+	}
+
+	destroy_thread_pool(pools[0]);
+	destroy_thread_pool(pools[1]);
+	free(hits);
+
+	return;
+}
@@ -0,0 +1,264 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdatomic.h>
+#include <sched.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_THREAD_POOL_WORKERS 64
+#define THREAD_POOL_DEQUE_SIZE 1024
+#define THREAD_POOL_SPIN_LIMIT 64
+#define MAX_PARALLEL_FOR_TASKS 256
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+typedef void (*task_function_t)(void*, unsigned int, unsigned int);
+
+
+//================================================================================================//
+/** @struct task_group_t
+*   @brief This structure comprises the join counter of a set of spawned tasks.
+*
+*/
+//================================================================================================//
+typedef struct task_group_s task_group_t;
+typedef struct task_group_s{
+	atomic_uint pending;
+} task_group_t;
+
+
+//================================================================================================//
+/** @struct task_t
+*   @brief This structure comprises one unit of work: function(argument, begin, end).
+*
+*	Tasks are owned by the caller that spawns them and must stay valid until the group is waited
+*	on. next only links tasks submitted from outside the pool.
+*/
+//================================================================================================//
+typedef struct task_s task_t;
+typedef struct task_s{
+	task_function_t function;
+	void* argument;
+	unsigned int begin;
+	unsigned int end;
+	task_group_t* group;
+	task_t* next;
+} task_t;
+
+
+//================================================================================================//
+/** @struct task_deque_t
+*   @brief This structure comprises a Chase-Lev work stealing deque of fixed capacity.
+*
+*	The owning worker pushes and takes at the bottom; any other thread steals from the top. The
+*	two ends sit on separate cache lines.
+*/
+//================================================================================================//
+typedef struct task_deque_s task_deque_t;
+typedef struct task_deque_s{
+	_Atomic int64_t top;
+	char top_padding[WEIGHT_ALIGNMENT - sizeof(int64_t)];
+	_Atomic int64_t bottom;
+	char bottom_padding[WEIGHT_ALIGNMENT - sizeof(int64_t)];
+	task_t* _Atomic buffer[THREAD_POOL_DEQUE_SIZE];
+} task_deque_t;
+
+
+//================================================================================================//
+/** @struct thread_pool_worker_t
+*   @brief This structure comprises one worker thread of a thread pool and its deque.
+*
+*	Padded to a whole number of cache lines, so neighbouring workers' deques do not share one.
+*/
+//================================================================================================//
+typedef struct thread_pool_worker_s thread_pool_worker_t;
+typedef struct thread_pool_worker_s{
+	task_deque_t deque;
+	pthread_t thread;
+	struct thread_pool_s* pool;
+	unsigned int index;
+	char padding[WEIGHT_ALIGNMENT - sizeof(pthread_t) - sizeof(void*) - sizeof(unsigned int)];
+} thread_pool_worker_t;
+
+
+//================================================================================================//
+/** @struct thread_pool_t
+*   @brief This structure comprises a work stealing pool of persistent worker threads.
+*
+*	Tasks spawned by a worker go on its own deque; tasks spawned by other threads go on a shared
+*	injection list. Idle workers steal, and sleep on wakeup once nothing is queued. A thread that
+*	waits on a task group runs queued tasks meanwhile, so nested fork-join never needs more
+*	threads than the pool has.
+*/
+//================================================================================================//
+typedef struct thread_pool_s thread_pool_t;
+typedef struct thread_pool_s{
+	thread_pool_worker_t* worker;
+	unsigned int num_workers;
+	int pin_workers;
+	pthread_mutex_t lock;
+	pthread_cond_t wakeup;
+	task_t* injected_head;
+	task_t* injected_tail;
+	atomic_uint num_queued;
+	atomic_uint num_injected;
+	atomic_uint num_sleeping;
+	atomic_int shutdown;
+} thread_pool_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a thread_pool_t object and starts its workers.
+*
+* With pin_workers set, worker i is bound to online CPU i (modulo the CPU count). A pool with
+* zero workers is valid: waiting threads then run every task themselves.
+*
+* If errors occur, the function exits.
+*
+* @param[in] unsigned int num_workers
+* @param[in] int pin_workers
+*
+* @return thread_pool_t* self
+*/
+//================================================================================================//
+thread_pool_t* create_thread_pool( unsigned int num_workers,
+								   int pin_workers );
+
+
+//================================================================================================//
+/**
+* @brief This function stops the workers and frees a thread_pool_t object.
+*
+* No task may be queued or running.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] thread_pool_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_thread_pool( thread_pool_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function returns the library's shared thread pool, creating it on first use.
+*
+* The shared pool has one worker fewer than there are online CPUs, since the thread that waits
+* on a task group works too. It lives until the process exits.
+*
+* If errors occur, the function exits.
+*
+* @return thread_pool_t* pool
+*/
+//================================================================================================//
+thread_pool_t* get_thread_pool();
+
+
+//================================================================================================//
+/**
+* @brief This function initializes an empty task_group_t object.
+*
+* If errors occur, the function exits.
+*
+* @param[out] task_group_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void initialize_task_group( task_group_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function queues a task in a group; function, argument, begin and end must be set.
+*
+* If the spawning worker's deque is full the task runs at once.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] thread_pool_t* self
+* @param[in,out] task_group_t* group
+* @param[in,out] task_t* task
+*
+* @return NONE
+*/
+//================================================================================================//
+void thread_pool_spawn( thread_pool_t* self,
+						task_group_t* group,
+						task_t* task );
+
+
+//================================================================================================//
+/**
+* @brief This function returns once every task of a group has run, running queued tasks meanwhile.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] thread_pool_t* self
+* @param[in,out] task_group_t* group
+*
+* @return NONE
+*/
+//================================================================================================//
+void thread_pool_wait( thread_pool_t* self,
+					   task_group_t* group );
+
+
+//================================================================================================//
+/**
+* @brief This function calls function(argument, b, e) over chunks [b, e) covering [begin, end).
+*
+* Chunks hold at least grain indices, and there are at most MAX_PARALLEL_FOR_TASKS of them. The
+* caller runs chunks too and returns when all are done. A NULL pool uses the shared pool.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] thread_pool_t* self
+* @param[in] unsigned int begin
+* @param[in] unsigned int end
+* @param[in] unsigned int grain
+* @param[in] task_function_t function
+* @param[in] void* argument
+*
+* @return NONE
+*/
+//================================================================================================//
+void parallel_for( thread_pool_t* self,
+				   unsigned int begin,
+				   unsigned int end,
+				   unsigned int grain,
+				   task_function_t function,
+				   void* argument );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the thread pool, including nested parallel loops.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_thread_pool();
+
+
+
+#endif //THREAD_POOL_H//
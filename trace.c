@@ -0,0 +1,382 @@
+#include "trace.h"
+
+//================================================================================================//
+//=======================================Global Variables=========================================//
+//================================================================================================//
+
+atomic_int trace_enabled = 0;
+
+//===Buffers Of Older Generations Were Freed By reset_tracing===//
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_buffer_t* trace_buffers = NULL;
+static unsigned int trace_capacity = TRACE_DEFAULT_CAPACITY;
+static unsigned int trace_num_threads = 0;
+static atomic_uint trace_generation = 1;
+static _Thread_local trace_buffer_t* local_buffer = NULL;
+static _Thread_local unsigned int local_generation = 0;
+
+static const char* trace_phase_names[NUM_TRACE_PHASES] = {"iteration", "forward", "backward", "update"};
+
+//================================================================================================//
+//=======================================Helper Functions=========================================//
+//================================================================================================//
+
+static trace_buffer_t* get_local_trace_buffer()
+{
+	unsigned int generation;
+	trace_buffer_t* buffer;
+
+	generation = atomic_load_explicit(&trace_generation, memory_order_acquire);
+	if (local_buffer != NULL && local_generation == generation){
+		return local_buffer;
+	}
+
+	//===First Event Of This Thread===//
+	buffer = malloc(sizeof(trace_buffer_t));
+	if (buffer == NULL){
+		fprintf(stderr, "Error:: Trace Buffer Was Not Allocated! In Function -- get_local_trace_buffer\n");
+		return NULL;
+	}
+	pthread_mutex_lock(&trace_lock);
+	buffer->capacity = trace_capacity;
+	buffer->events = malloc(buffer->capacity * sizeof(trace_event_t));
+	if (buffer->events == NULL){
+		pthread_mutex_unlock(&trace_lock);
+		fprintf(stderr, "Error:: Trace Events Were Not Allocated! In Function -- get_local_trace_buffer\n");
+		free(buffer);
+		return NULL;
+	}
+	buffer->thread = trace_num_threads++;
+	buffer->iteration = 0;
+	atomic_init(&(buffer->head), 0);
+	buffer->next = trace_buffers;
+	trace_buffers = buffer;
+	pthread_mutex_unlock(&trace_lock);
+
+	local_buffer = buffer;
+	local_generation = generation;
+
+	return buffer;
+}
+
+//================================================================================================//
+//=======================================Trace Functions==========================================//
+//================================================================================================//
+
+void enable_tracing( unsigned int capacity )
+{
+	unsigned int size;
+
+	size = 1;
+	while (size < ((capacity > 0) ? capacity : TRACE_DEFAULT_CAPACITY)){
+		size <<= 1;
+	}
+	pthread_mutex_lock(&trace_lock);
+	trace_capacity = size;
+	pthread_mutex_unlock(&trace_lock);
+	atomic_store(&trace_enabled, 1);
+
+	return;
+}
+
+void disable_tracing()
+{
+	atomic_store(&trace_enabled, 0);
+	return;
+}
+
+void reset_tracing()
+{
+	trace_buffer_t *buffer, *next;
+
+	pthread_mutex_lock(&trace_lock);
+	for (buffer=trace_buffers; buffer!=NULL; buffer=next){
+		next = buffer->next;
+		free(buffer->events);
+		free(buffer);
+	}
+	trace_buffers = NULL;
+	trace_num_threads = 0;
+	atomic_fetch_add_explicit(&trace_generation, 1, memory_order_release);
+	pthread_mutex_unlock(&trace_lock);
+
+	return;
+}
+
+void trace_begin_iteration()
+{
+	trace_buffer_t* buffer;
+
+	buffer = get_local_trace_buffer();
+	if (buffer != NULL){
+		buffer->iteration++;
+	}
+	return;
+}
+
+void record_trace_event( trace_phase_t phase,
+						 unsigned int layer,
+						 double norm,
+						 double value )
+{
+	uint64_t head;
+	struct timespec now;
+	trace_event_t* event;
+	trace_buffer_t* buffer;
+
+	buffer = get_local_trace_buffer();
+	if (buffer == NULL){
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	//===Single Writer: Fill, Then Publish===//
+	head = atomic_load_explicit(&(buffer->head), memory_order_relaxed);
+	event = &(buffer->events[head & (buffer->capacity-1)]);
+	event->timestamp = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	event->iteration = buffer->iteration;
+	event->norm = norm;
+	event->value = value;
+	event->layer = layer;
+	event->phase = phase;
+	event->reserved = 0;
+	event->thread = buffer->thread;
+	atomic_store_explicit(&(buffer->head), head+1, memory_order_release);
+
+	return;
+}
+
+int write_trace_file( const char* filename )
+{
+	int status;
+	uint32_t counts[2];
+	uint64_t head, totals[2];
+	FILE* fp;
+	trace_buffer_t* buffer;
+
+	fp = fopen(filename, "wb");
+	if (fp == NULL){
+		fprintf(stderr, "Error:: Could Not Open '%s'! In Function -- write_trace_file\n", filename);
+		return -1;
+	}
+
+	//===Header: Magic, Event Size, Number Of Buffers===//
+	pthread_mutex_lock(&trace_lock);
+	counts[0] = sizeof(trace_event_t);
+	counts[1] = trace_num_threads;
+	status = (fwrite(TRACE_MAGIC, 8, 1, fp) == 1 && fwrite(counts, sizeof(counts), 1, fp) == 1) ? 0 : -1;
+
+	//===Per Buffer: Thread, Capacity, Events Kept, Events Overwritten, Then The Events===//
+	for (buffer=trace_buffers; buffer!=NULL && status==0; buffer=buffer->next){
+		head = atomic_load_explicit(&(buffer->head), memory_order_acquire);
+		counts[0] = buffer->thread;
+		counts[1] = buffer->capacity;
+		totals[0] = (head < buffer->capacity) ? head : buffer->capacity;
+		totals[1] = head - totals[0];
+		if (fwrite(counts, sizeof(counts), 1, fp) != 1 || fwrite(totals, sizeof(totals), 1, fp) != 1){
+			status = -1;
+			break;
+		}
+
+		//===Oldest First, Which Wraps Once The Ring Is Full===//
+		if (head > buffer->capacity && (head & (buffer->capacity-1)) != 0){
+			if (fwrite(buffer->events + (head & (buffer->capacity-1)), sizeof(trace_event_t),
+					   buffer->capacity - (head & (buffer->capacity-1)), fp) != buffer->capacity - (head & (buffer->capacity-1)) ||
+				fwrite(buffer->events, sizeof(trace_event_t), head & (buffer->capacity-1), fp) != (head & (buffer->capacity-1))){
+				status = -1;
+			}
+		}
+		else if (fwrite(buffer->events, sizeof(trace_event_t), totals[0], fp) != totals[0]){
+			status = -1;
+		}
+	}
+	pthread_mutex_unlock(&trace_lock);
+
+	if (fclose(fp) != 0 || status != 0){
+		fprintf(stderr, "Error:: Could Not Write '%s'! In Function -- write_trace_file\n", filename);
+		return -1;
+	}
+
+	return 0;
+}
+
+long decode_trace_file( const char* filename,
+						FILE* stream )
+{
+	long size, offset, num_events;
+	uint32_t counts[2];
+	uint64_t totals[2], e, start;
+	char* contents;
+	FILE* fp;
+	trace_event_t* event;
+
+	//===Read Whole File===//
+	fp = fopen(filename, "rb");
+	if (fp == NULL){
+		fprintf(stderr, "Error:: Could Not Open '%s'! In Function -- decode_trace_file\n", filename);
+		return -1;
+	}
+	contents = NULL;
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 16 || fseek(fp, 0, SEEK_SET) != 0 ||
+		(contents = malloc(size)) == NULL || fread(contents, size, 1, fp) != 1){
+		fprintf(stderr, "Error:: Could Not Read '%s'! In Function -- decode_trace_file\n", filename);
+		fclose(fp);
+		free(contents);
+		return -1;
+	}
+	fclose(fp);
+	memcpy(counts, contents + 8, sizeof(counts));
+	if (memcmp(contents, TRACE_MAGIC, 8) != 0 || counts[0] != sizeof(trace_event_t)){
+		fprintf(stderr, "Error:: '%s' Is Not A Trace File! In Function -- decode_trace_file\n", filename);
+		free(contents);
+		return -1;
+	}
+
+	//===Find The Earliest Event, Checking The Layout On The Way===//
+	start = UINT64_MAX;
+	offset = 16;
+	while (offset < size){
+		if (offset + 24 > size){
+			break;
+		}
+		memcpy(totals, contents + offset + 8, sizeof(totals));
+		offset += 24;
+		if (totals[0] > (uint64_t)(size - offset) / sizeof(trace_event_t)){
+			break;
+		}
+		for (e=0; e<totals[0]; e++){
+			event = (trace_event_t*)(contents + offset) + e;
+			start = (event->timestamp < start) ? event->timestamp : start;
+		}
+		offset += totals[0] * sizeof(trace_event_t);
+	}
+	if (offset != size){
+		fprintf(stderr, "Error:: '%s' Is Truncated! In Function -- decode_trace_file\n", filename);
+		free(contents);
+		return -1;
+	}
+
+	//===One Line Per Event===//
+	num_events = 0;
+	offset = 16;
+	while (offset < size){
+		memcpy(counts, contents + offset, sizeof(counts));
+		memcpy(totals, contents + offset + 8, sizeof(totals));
+		offset += 24;
+		fprintf(stream, "Thread %u: %lu Events, %lu Overwritten\n", counts[0], (unsigned long)totals[0], (unsigned long)totals[1]);
+		for (e=0; e<totals[0]; e++){
+			event = (trace_event_t*)(contents + offset) + e;
+			fprintf(stream, "%14.9lf  iteration %-8lu %-9s layer %-3u norm %-14g value %g\n",
+					(event->timestamp - start) * 1e-9, (unsigned long)event->iteration,
+					(event->phase < NUM_TRACE_PHASES) ? trace_phase_names[event->phase] : "unknown",
+					event->layer, event->norm, event->value);
+		}
+		offset += totals[0] * sizeof(trace_event_t);
+		num_events += totals[0];
+	}
+	free(contents);
+
+	return num_events;
+}
+
+//================================================================================================//
+//=======================================Test Functions===========================================//
+//================================================================================================//
+
+static void* run_test_trace_thread( void* argument )
+{
+	unsigned int i, n;
+
+	(void)argument;
+	for (n=0; n<3; n++){
+		trace_begin_iteration();
+		for (i=0; i<5; i++){
+			record_trace_event(TRACE_PHASE_FORWARD, i, n, i);
+		}
+	}
+	return NULL;
+}
+
+void test_tracing()
+{
+	unsigned int t;
+	long num_events;
+	char filename[64];
+	uint32_t counts[2];
+	uint64_t totals[2];
+	trace_event_t events[8];
+	pthread_t threads[2];
+	FILE* stream;
+	trace_buffer_t* buffer;
+
+	reset_tracing();
+	enable_tracing(6);
+
+	//===Two Threads Overflow Their Rings Of 8; The Main Thread Does Not===//
+	for (t=0; t<2; t++){
+		pthread_create(&threads[t], NULL, run_test_trace_thread, NULL);
+	}
+	for (t=0; t<2; t++){
+		pthread_join(threads[t], NULL);
+	}
+	trace_begin_iteration();
+	record_trace_event(TRACE_PHASE_UPDATE, 7, 0.5, 2.5);
+	disable_tracing();
+
+	for (t=0, buffer=trace_buffers; buffer!=NULL; buffer=buffer->next, t++){
+		if (buffer->capacity != 8 || (atomic_load(&(buffer->head)) != 15 && atomic_load(&(buffer->head)) != 1)){
+			fprintf(stderr, "Error: Function record_trace_event Has Failed!\n");
+		}
+	}
+	if (t != 3){
+		fprintf(stderr, "Error: Function get_local_trace_buffer Made %u Buffers!\n", t);
+	}
+
+	//===The Newest Eight Of Each Thread Survive The Round Trip, Oldest First===//
+	snprintf(filename, sizeof(filename), "/tmp/test_trace_%d", (int)getpid());
+	stream = fopen("/dev/null", "w");
+	if (write_trace_file(filename) != 0 || stream == NULL){
+		fprintf(stderr, "Error: Function write_trace_file Has Failed!\n");
+		if (stream != NULL){
+			fclose(stream);
+		}
+		unlink(filename);
+		reset_tracing();
+		return;
+	}
+	num_events = decode_trace_file(filename, stream);
+	fclose(stream);
+	if (num_events != 17){
+		fprintf(stderr, "Error: Function decode_trace_file Decoded %ld Events!\n", num_events);
+	}
+	stream = fopen(filename, "rb");
+	if (stream == NULL || fseek(stream, 16, SEEK_SET) != 0){
+		fprintf(stderr, "Error: Function write_trace_file Has Failed!\n");
+		if (stream != NULL){
+			fclose(stream);
+		}
+		unlink(filename);
+		reset_tracing();
+		return;
+	}
+	for (t=0; t<3; t++){
+		if (fread(counts, sizeof(counts), 1, stream) != 1 || fread(totals, sizeof(totals), 1, stream) != 1 ||
+			fread(events, sizeof(trace_event_t), totals[0], stream) != totals[0]){
+			fprintf(stderr, "Error: Function write_trace_file Has Failed!\n");
+			break;
+		}
+		if (totals[0] == 8 && (totals[1] != 7 || events[0].iteration != 2 || events[0].layer != 2 ||
+							   events[7].iteration != 3 || events[7].layer != 4)){
+			fprintf(stderr, "Error: Function write_trace_file Did Not Write Oldest First!\n");
+		}
+	}
+	fclose(stream);
+	unlink(filename);
+
+	reset_tracing();
+	if (trace_buffers != NULL){
+		fprintf(stderr, "Error: Function reset_tracing Has Failed!\n");
+	}
+
+	return;
+}
@@ -0,0 +1,216 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define TRACE_MAGIC "NNTRACE1"
+#define TRACE_DEFAULT_CAPACITY 65536
+
+//===The Only Cost Of A Trace Point While Tracing Is Off===//
+#define TRACE_ENABLED() __builtin_expect(atomic_load_explicit(&trace_enabled, memory_order_relaxed), 0)
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @enum trace_phase_t
+*   @brief This enumeration names the training phase a trace event belongs to.
+*/
+//================================================================================================//
+typedef enum trace_phase_e{
+	TRACE_PHASE_ITERATION,
+	TRACE_PHASE_FORWARD,
+	TRACE_PHASE_BACKWARD,
+	TRACE_PHASE_UPDATE,
+	NUM_TRACE_PHASES
+} trace_phase_t;
+
+
+//================================================================================================//
+/** @struct trace_event_t
+*   @brief This structure comprises one 32-byte binary trace event.
+*
+*	timestamp is CLOCK_MONOTONIC in nanoseconds. iteration counts the iterations the recording
+*	thread has traced. What norm and value hold depends on the phase; see iterate_network.
+*/
+//================================================================================================//
+typedef struct trace_event_s trace_event_t;
+typedef struct trace_event_s{
+	uint64_t timestamp;
+	uint64_t iteration;
+	float norm;
+	float value;
+	uint16_t layer;
+	uint8_t phase;
+	uint8_t reserved;
+	uint32_t thread;
+} trace_event_t;
+
+
+//================================================================================================//
+/** @struct trace_buffer_t
+*   @brief This structure comprises the ring buffer of trace events of one thread.
+*
+*	Only its thread writes it, so recording takes no lock: the event is filled in and head is
+*	then advanced with release ordering. Once head passes capacity the oldest events are
+*	overwritten. Buffers are created on a thread's first event and linked into a global list.
+*/
+//================================================================================================//
+typedef struct trace_buffer_s trace_buffer_t;
+typedef struct trace_buffer_s{
+	trace_event_t* events;
+	unsigned int capacity;
+	unsigned int thread;
+	_Atomic uint64_t head;
+	uint64_t iteration;
+	trace_buffer_t* next;
+} trace_buffer_t;
+
+
+extern atomic_int trace_enabled;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function turns tracing on for every thread.
+*
+* capacity is the number of events per thread buffer created from now on, rounded up to a
+* power of two; 0 selects TRACE_DEFAULT_CAPACITY.
+*
+* If errors occur, the function exits.
+*
+* @param[in] unsigned int capacity
+*
+* @return NONE
+*/
+//================================================================================================//
+void enable_tracing( unsigned int capacity );
+
+
+//================================================================================================//
+/**
+* @brief This function turns tracing off. Recorded events are kept.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void disable_tracing();
+
+
+//================================================================================================//
+/**
+* @brief This function frees every thread's trace buffer.
+*
+* No thread may be recording when this is called.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void reset_tracing();
+
+
+//================================================================================================//
+/**
+* @brief This function starts the next traced iteration of the calling thread.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void trace_begin_iteration();
+
+
+//================================================================================================//
+/**
+* @brief This function appends an event to the calling thread's trace buffer.
+*
+* If errors occur, the function exits.
+*
+* @param[in] trace_phase_t phase
+* @param[in] unsigned int layer
+* @param[in] double norm
+* @param[in] double value
+*
+* @return NONE
+*/
+//================================================================================================//
+void record_trace_event( trace_phase_t phase,
+						 unsigned int layer,
+						 double norm,
+						 double value );
+
+
+//================================================================================================//
+/**
+* @brief This function writes every thread's buffered events to a binary trace file.
+*
+* Each buffer is written oldest event first. Events being recorded during the write may be
+* torn, so disable tracing or let traced threads finish first.
+*
+* If errors occur, the function exits.
+*
+* @param[in] const char* filename
+*
+* @return int status (0 on success, -1 on error)
+*/
+//================================================================================================//
+int write_trace_file( const char* filename );
+
+
+//================================================================================================//
+/**
+* @brief This function decodes a binary trace file into one text line per event.
+*
+* Times are in seconds since the earliest event in the file.
+*
+* If errors occur, the function exits.
+*
+* @param[in] const char* filename
+* @param[in,out] FILE* stream
+*
+* @return long num_events (-1 on error)
+*/
+//================================================================================================//
+long decode_trace_file( const char* filename,
+						FILE* stream );
+
+
+//================================================================================================//
+/**
+* @brief This function tests recording from several threads, wrap around and the file round trip.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_tracing();
+
+
+
+#endif //TRACE_H//
@@ -0,0 +1,18 @@
+#include "trace.h"
+
+//================================================================================================//
+//===Offline Decoder: trace_decode <trace file> Prints One Line Per Event===//
+//================================================================================================//
+
+int main( int argc,
+		  char** argv )
+{
+	if (argc != 2){
+		fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+		return 1;
+	}
+	if (decode_trace_file(argv[1], stdout) < 0){
+		return 1;
+	}
+	return 0;
+}
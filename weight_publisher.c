@@ -0,0 +1,358 @@
+#include "weight_publisher.h"
+#include "helper.h"
+
+//================================================================================================//
+//===================================Snapshot Functions===========================================//
+//================================================================================================//
+
+static weight_snapshot_t* create_weight_snapshot( neural_network_t* network )
+{
+	unsigned int i;
+	weight_snapshot_t* self;
+
+	self = NULL;
+	self = malloc(sizeof(weight_snapshot_t));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Weight Snapshot Was Not Allocated! In Function -- create_weight_snapshot\n");
+		return self;
+	}
+	self->arena = aligned_alloc(WEIGHT_ALIGNMENT, round_up(network->arena_size * sizeof(double), WEIGHT_ALIGNMENT));
+	if (self->arena == NULL){
+		fprintf(stderr, "Error:: Weight Snapshot Arena Was Not Allocated! In Function -- create_weight_snapshot\n");
+		free(self);
+		return NULL;
+	}
+
+	//===Copy Topology And Repoint Into Private Arena===//
+	self->num_layers = network->num_hidden_layers+2;
+	for (i=0; i<self->num_layers; i++){
+		self->layer[i] = network->layer[i];
+		self->layer[i].weight_matrix = self->arena + (network->layer[i].weight_matrix - network->weight_arena);
+		self->layer[i].weight_update = NULL;
+		self->layer[i].weight_mask = NULL;
+		self->layer[i].sparse_weights = NULL;
+		self->layer[i].use_sparse_weights = 0;
+		self->layer[i].previous_layer = (i > 0) ? &(self->layer[i-1]) : NULL;
+		self->layer[i].next_layer = (i < self->num_layers-1) ? &(self->layer[i+1]) : NULL;
+	}
+	self->next = NULL;
+
+	return self;
+}
+
+static void destroy_weight_snapshot( weight_snapshot_t* self )
+{
+	free(self->arena);
+	free(self);
+	return;
+}
+
+static void reclaim_weight_snapshots( weight_publisher_t* self )
+{
+	unsigned int i;
+	uint64_t epoch, oldest;
+	weight_snapshot_t *snapshot, **link;
+
+	//===Find Oldest Announced Epoch===//
+	oldest = UINT64_MAX;
+	for (i=0; i<MAX_WEIGHT_READERS; i++){
+		epoch = atomic_load(&(self->reader[i].epoch));
+		if (epoch != 0 && epoch < oldest){
+			oldest = epoch;
+		}
+	}
+
+	//===Recycle Snapshots No Reader Can Still Hold===//
+	link = &(self->retired);
+	while (*link != NULL){
+		snapshot = *link;
+		if (snapshot->retire_epoch < oldest){
+			*link = snapshot->next;
+			snapshot->next = self->free_list;
+			self->free_list = snapshot;
+		}
+		else{
+			link = &(snapshot->next);
+		}
+	}
+
+	return;
+}
+
+//================================================================================================//
+//===================================Publisher Functions==========================================//
+//================================================================================================//
+
+weight_publisher_t* create_weight_publisher( neural_network_t* network )
+{
+	unsigned int i;
+	weight_publisher_t* self;
+
+	if (network == NULL){
+		fprintf(stderr, "Error:: Input Parameter 'network' Is NULL! In Function -- create_weight_publisher\n");
+		return NULL;
+	}
+
+	self = NULL;
+	self = aligned_alloc(WEIGHT_ALIGNMENT, round_up(sizeof(weight_publisher_t), WEIGHT_ALIGNMENT));
+	if (self == NULL){
+		fprintf(stderr, "Error:: Weight Publisher Was Not Allocated! In Function -- create_weight_publisher\n");
+		return self;
+	}
+
+	//===Set Local Data===//
+	for (i=0; i<MAX_WEIGHT_READERS; i++){
+		atomic_init(&(self->reader[i].epoch), 0);
+		atomic_init(&(self->reader[i].in_use), 0);
+	}
+	atomic_init(&(self->current), NULL);
+	atomic_init(&(self->global_epoch), 1);
+	self->retired = NULL;
+	self->free_list = NULL;
+	self->network = network;
+	self->version = 0;
+
+	//===Publish Initial Weights===//
+	if (publish_weights(self) == 0){
+		destroy_weight_publisher(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+void destroy_weight_publisher( weight_publisher_t* self )
+{
+	weight_snapshot_t *snapshot, *next;
+
+	if (self == NULL){
+		fprintf(stderr, "Error:: Weight Publisher Is NULL! In Function -- destroy_weight_publisher\n");
+		return;
+	}
+
+	snapshot = atomic_load(&(self->current));
+	if (snapshot != NULL){
+		destroy_weight_snapshot(snapshot);
+	}
+	for (snapshot=self->retired; snapshot != NULL; snapshot=next){
+		next = snapshot->next;
+		destroy_weight_snapshot(snapshot);
+	}
+	for (snapshot=self->free_list; snapshot != NULL; snapshot=next){
+		next = snapshot->next;
+		destroy_weight_snapshot(snapshot);
+	}
+	free(self);
+
+	return;
+}
+
+uint64_t publish_weights( weight_publisher_t* self )
+{
+	weight_snapshot_t *snapshot, *previous;
+
+	//===Reuse A Reclaimed Snapshot If Possible===//
+	reclaim_weight_snapshots(self);
+	if (self->free_list != NULL){
+		snapshot = self->free_list;
+		self->free_list = snapshot->next;
+		snapshot->next = NULL;
+	}
+	else{
+		snapshot = create_weight_snapshot(self->network);
+		if (snapshot == NULL){
+			fprintf(stderr, "Error:: Weight Snapshot Was Not Created! In Function -- publish_weights\n");
+			return 0;
+		}
+	}
+
+	//===Fill Before Anyone Can See It===//
+	memcpy(snapshot->arena, self->network->weight_arena, self->network->arena_size * sizeof(double));
+	snapshot->version = ++(self->version);
+
+	//===Swap And Retire The Previous Version===//
+	previous = atomic_exchange(&(self->current), snapshot);
+	if (previous != NULL){
+		previous->retire_epoch = atomic_fetch_add(&(self->global_epoch), 1);
+		previous->next = self->retired;
+		self->retired = previous;
+	}
+
+	return snapshot->version;
+}
+
+//================================================================================================//
+//=====================================Reader Functions===========================================//
+//================================================================================================//
+
+int register_weight_reader( weight_publisher_t* self )
+{
+	int i, expected;
+
+	for (i=0; i<MAX_WEIGHT_READERS; i++){
+		expected = 0;
+		if (atomic_compare_exchange_strong(&(self->reader[i].in_use), &expected, 1)){
+			atomic_store(&(self->reader[i].epoch), 0);
+			return i;
+		}
+	}
+	fprintf(stderr, "Error:: All Reader Slots Are Taken! In Function -- register_weight_reader\n");
+
+	return -1;
+}
+
+void unregister_weight_reader( weight_publisher_t* self,
+							   int reader )
+{
+	if (reader < 0 || reader >= MAX_WEIGHT_READERS){
+		fprintf(stderr, "Error:: Input Parameter 'reader' Is Invalid! In Function -- unregister_weight_reader\n");
+		return;
+	}
+	atomic_store(&(self->reader[reader].epoch), 0);
+	atomic_store(&(self->reader[reader].in_use), 0);
+
+	return;
+}
+
+weight_snapshot_t* pin_weights( weight_publisher_t* self,
+								int reader )
+{
+	if (reader < 0 || reader >= MAX_WEIGHT_READERS){
+		fprintf(stderr, "Error:: Input Parameter 'reader' Is Invalid! In Function -- pin_weights\n");
+		return NULL;
+	}
+
+	//===Announce Epoch Before Loading The Pointer===//
+	atomic_store(&(self->reader[reader].epoch), atomic_load(&(self->global_epoch)));
+
+	return atomic_load(&(self->current));
+}
+
+void unpin_weights( weight_publisher_t* self,
+					int reader )
+{
+	atomic_store_explicit(&(self->reader[reader].epoch), 0, memory_order_release);
+	return;
+}
+
+void feed_forward_snapshot( weight_snapshot_t* self,
+							neural_context_t* context,
+							double* input )
+{
+	unsigned int i;
+
+	if (self == NULL || context == NULL){
+		fprintf(stderr, "Error:: Input Parameter Is NULL! In Function -- feed_forward_snapshot\n");
+		return;
+	}
+
+	//===Set Input===//
+	for (i=0; i<self->layer[0].num_nodes; i++){
+		context->input[i] = input[i];
+	}
+
+	//===Feed Through Layers===//
+	for (i=0; i<self->num_layers; i++){
+		feed_layer_forward(&(self->layer[i]), context);
+	}
+
+	return;
+}
+
+//================================================================================================//
+//======================================Testing Functions=========================================//
+//================================================================================================//
+
+typedef struct test_publisher_s{
+	weight_publisher_t* publisher;
+	atomic_int* done;
+	unsigned int torn;
+} test_publisher_t;
+
+static void* test_weight_reader_thread( void* argument )
+{
+	size_t i;
+	int reader;
+	double first, input[3];
+	neural_context_t* context;
+	weight_snapshot_t* snapshot;
+	test_publisher_t* test;
+
+	test = (test_publisher_t*)argument;
+	test->torn = 0;
+	reader = register_weight_reader(test->publisher);
+	context = create_neural_context(test->publisher->network);
+	input[0] = 1; input[1] = 2; input[2] = 3;
+
+	while (!atomic_load(test->done)){
+		snapshot = pin_weights(test->publisher, reader);
+
+		//===Every Weight Of A Snapshot Was Written In One Step===//
+		first = snapshot->arena[0];
+		for (i=0; i<test->publisher->network->arena_size; i++){
+			if (snapshot->arena[i] != first){
+				test->torn++;
+				break;
+			}
+		}
+		feed_forward_snapshot(snapshot, context, input);
+
+		unpin_weights(test->publisher, reader);
+	}
+
+	destroy_neural_context(context);
+	unregister_weight_reader(test->publisher, reader);
+
+	return NULL;
+}
+
+void test_weight_publisher()
+{
+	size_t i;
+	unsigned int t, version;
+	unsigned int num_nodes[4];
+	atomic_int done;
+	pthread_t threads[3];
+	test_publisher_t tests[3];
+	neural_network_parameters_t* parameters;
+	neural_network_t* network;
+	weight_publisher_t* publisher;
+
+	//===Create Network And Publisher===//
+	num_nodes[0] = 3; num_nodes[1] = 5; num_nodes[2] = 3; num_nodes[3] = 1;
+	parameters = create_neural_network_parameters(2, num_nodes, 0.05);
+	network = create_neural_network(parameters);
+	for (i=0; i<network->arena_size; i++){
+		network->weight_arena[i] = 0;
+	}
+	publisher = create_weight_publisher(network);
+
+	//===Start Readers===//
+	atomic_init(&done, 0);
+	for (t=0; t<3; t++){
+		tests[t].publisher = publisher;
+		tests[t].done = &done;
+		pthread_create(&(threads[t]), NULL, test_weight_reader_thread, &(tests[t]));
+	}
+
+	//===Train And Publish===//
+	for (version=1; version<2000; version++){
+		for (i=0; i<network->arena_size; i++){
+			network->weight_arena[i] = version;
+		}
+		publish_weights(publisher);
+	}
+	atomic_store(&done, 1);
+	for (t=0; t<3; t++){
+		pthread_join(threads[t], NULL);
+		if (tests[t].torn != 0){
+			fprintf(stderr, "Error: Function pin_weights Returned Torn Weights!\n");
+		}
+	}
+
+	destroy_weight_publisher(publisher);
+	destroy_neural_network(network);
+	free(parameters);
+
+	return;
+}
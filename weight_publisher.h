@@ -0,0 +1,221 @@
+#ifndef WEIGHT_PUBLISHER_H
+#define WEIGHT_PUBLISHER_H
+
+#include <stdatomic.h>
+#include "neural_network.h"
+
+
+//================================================================================================//
+//===========================================MACROS===============================================//
+//================================================================================================//
+
+#define MAX_WEIGHT_READERS 64
+
+
+//================================================================================================//
+//======================================Data Structures===========================================//
+//================================================================================================//
+
+//================================================================================================//
+/** @struct weight_snapshot_t
+*   @brief This structure comprises one immutable published version of a network's weights.
+*
+*	The snapshot carries its own copy of the layer array with weight pointers into its private
+*	arena, so a forward pass over it never touches the live training weights.
+*/
+//================================================================================================//
+typedef struct weight_snapshot_s weight_snapshot_t;
+typedef struct weight_snapshot_s{
+	neural_layer_t layer[MAX_LAYERS];
+	double* arena;
+	uint64_t version;
+	uint64_t retire_epoch;
+	unsigned int num_layers;
+	weight_snapshot_t* next;
+} weight_snapshot_t;
+
+
+//================================================================================================//
+/** @struct weight_reader_slot_t
+*   @brief This structure comprises the announced epoch of one reader thread.
+*
+*	An epoch of 0 means the reader is not inside a forward pass. Slots are padded to a cache line
+*	so readers never share one.
+*/
+//================================================================================================//
+typedef struct weight_reader_slot_s weight_reader_slot_t;
+typedef struct weight_reader_slot_s{
+	_Atomic uint64_t epoch;
+	atomic_int in_use;
+	char padding[WEIGHT_ALIGNMENT - sizeof(uint64_t) - sizeof(int)];
+} weight_reader_slot_t;
+
+
+//================================================================================================//
+/** @struct weight_publisher_t
+*   @brief This structure comprises the RCU-style publication point for a network's weights.
+*
+*	One trainer thread calls publish_weights; any number of reader threads pin the current
+*	snapshot with pin_weights, which never blocks. Replaced snapshots are kept on a retired list
+*	until every reader has announced a newer epoch, then recycled for later publications.
+*/
+//================================================================================================//
+typedef struct weight_publisher_s weight_publisher_t;
+typedef struct weight_publisher_s{
+	weight_reader_slot_t reader[MAX_WEIGHT_READERS];
+	_Atomic(weight_snapshot_t*) current;
+	_Atomic uint64_t global_epoch;
+	weight_snapshot_t* retired;
+	weight_snapshot_t* free_list;
+	neural_network_t* network;
+	uint64_t version;
+} weight_publisher_t;
+
+
+
+//================================================================================================//
+//===================================Function Definitions=========================================//
+//================================================================================================//
+
+
+//================================================================================================//
+/**
+* @brief This function allocates a weight_publisher_t object and publishes the initial weights.
+*
+* If errors occur, the function exits.
+*
+* @param[in] neural_network_t* network
+*
+* @return weight_publisher_t* self
+*/
+//================================================================================================//
+weight_publisher_t* create_weight_publisher( neural_network_t* network );
+
+
+//================================================================================================//
+/**
+* @brief This function frees a weight_publisher_t object and all of its snapshots.
+*
+* No reader may be pinned when this is called.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] weight_publisher_t* self
+*
+* @return NONE
+*/
+//================================================================================================//
+void destroy_weight_publisher( weight_publisher_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function publishes a copy of the network's current weights.
+*
+* Only the trainer thread may call this. The copy is made before the atomic pointer swap, so
+* readers see either the old or the new weights, never a mix.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] weight_publisher_t* self
+*
+* @return uint64_t version
+*/
+//================================================================================================//
+uint64_t publish_weights( weight_publisher_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function claims a reader slot for the calling thread.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] weight_publisher_t* self
+*
+* @return int reader (or -1 if every slot is taken)
+*/
+//================================================================================================//
+int register_weight_reader( weight_publisher_t* self );
+
+
+//================================================================================================//
+/**
+* @brief This function releases a reader slot.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] weight_publisher_t* self
+* @param[in] int reader
+*
+* @return NONE
+*/
+//================================================================================================//
+void unregister_weight_reader( weight_publisher_t* self,
+							   int reader );
+
+
+//================================================================================================//
+/**
+* @brief This function pins the current weight snapshot for the duration of a forward pass.
+*
+* If errors occur, the function exits.
+*
+* @param[in,out] weight_publisher_t* self
+* @param[in] int reader
+*
+* @return weight_snapshot_t* snapshot
+*/
+//================================================================================================//
+weight_snapshot_t* pin_weights( weight_publisher_t* self,
+								int reader );
+
+
+//================================================================================================//
+/**
+* @brief This function unpins the snapshot returned by the last pin_weights call.
+*
+* @param[in,out] weight_publisher_t* self
+* @param[in] int reader
+*
+* @return NONE
+*/
+//================================================================================================//
+void unpin_weights( weight_publisher_t* self,
+					int reader );
+
+
+//================================================================================================//
+/**
+* @brief This function feeds an input forward through a pinned weight snapshot.
+*
+* The result is left in context->output.
+*
+* If errors occur, the function exits.
+*
+* @param[in] weight_snapshot_t* self
+* @param[in,out] neural_context_t* context
+* @param[in] double* input
+*
+* @return NONE
+*/
+//================================================================================================//
+void feed_forward_snapshot( weight_snapshot_t* self,
+							neural_context_t* context,
+							double* input );
+
+
+//================================================================================================//
+/**
+* @brief This function tests the weight_publisher_t object.
+*
+* If errors occur, the function exits.
+*
+* @return NONE
+*/
+//================================================================================================//
+void test_weight_publisher();
+
+
+
+#endif //WEIGHT_PUBLISHER_H//